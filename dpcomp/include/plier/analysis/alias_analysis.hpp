@@ -0,0 +1,34 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <mlir/Analysis/AliasAnalysis.h>
+
+namespace plier {
+/// Checks if two memrefs can refer to the same memory.
+/// Distinct `memref.alloc`/`memref.alloca` results, globals and `noalias`
+/// function arguments never alias each other, fresh allocations never alias
+/// function arguments. Rank-preserving unit stride subviews of the same buffer
+/// don't alias if their static ranges are disjoint.
+mlir::AliasResult aliasMemrefs(mlir::Value lhs, mlir::Value rhs);
+
+/// Checks if two accesses can touch the same element. In addition to the
+/// `aliasMemrefs` rules, accesses to the same buffer are compared in the
+/// buffer index space, indices `x + c1` and `x + c2` with different constants
+/// never alias, if `x` is not defined inside a loop. Writable views are assumed
+/// to be non-overlapping unless they have statically known zero strides.
+mlir::AliasResult aliasAccesses(mlir::Value lhs, mlir::ValueRange lhsIndices,
+                                mlir::Value rhs, mlir::ValueRange rhsIndices);
+} // namespace plier
@@ -0,0 +1,57 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <llvm/ADT/SmallVector.h>
+
+#include <mlir/IR/Value.h>
+
+namespace mlir {
+class Operation;
+} // namespace mlir
+
+namespace plier {
+/// Memory access inside `scf.for` or `scf.parallel` loop.
+struct LoopAccess {
+  mlir::Operation *loop;
+  mlir::ValueRange indices;
+};
+
+enum class DependenceKind {
+  /// Accesses never touch the same element.
+  Independent,
+  /// Accesses can touch the same element only on the same loop iteration.
+  SameIteration,
+  /// Dependence cannot be disproved.
+  Unknown,
+};
+
+struct Dependence {
+  DependenceKind kind = DependenceKind::Unknown;
+  /// Memref dimensions used to prove independence. Result is only valid if
+  /// these dimensions have non-zero strides.
+  llvm::SmallVector<unsigned, 2> dims;
+};
+
+/// Checks if two accesses to the same memref can touch the same element on
+/// different iterations of their loops. Indices are decomposed into linear
+/// expressions over loop induction variables, loop invariant values and
+/// constants, and checked for each memref dimension using GCD test and
+/// constant distance test.
+/// Both loops must have the same iteration space, induction variables of the
+/// first loop are matched to the induction variables of the second loop.
+Dependence checkLoopDependence(const LoopAccess &first,
+                               const LoopAccess &second);
+} // namespace plier
@@ -19,6 +19,7 @@
 #include <llvm/ADT/ArrayRef.h>
 #include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/Optional.h>
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/simple_ilist.h>
 #include <llvm/Support/Allocator.h>
 
@@ -47,6 +48,11 @@ public:
   Node *createPhi(mlir::Operation *op, llvm::ArrayRef<Node *> args);
 
   void eraseNode(Node *node);
+
+  /// Removes nodes for the `op`, must be called before op is erased. Ops with
+  /// regions are not supported.
+  void eraseOp(mlir::Operation *op);
+
   NodeType getNodeType(Node *node) const;
   mlir::Operation *getNodeOperation(Node *node) const;
   Node *getNodeDef(Node *node) const;
@@ -106,7 +112,10 @@ private:
   llvm::DenseMap<mlir::Operation *, Node *> nodesMap;
   llvm::BumpPtrAllocator allocator;
   llvm::simple_ilist<Node> nodes;
+  /// Memory of erased nodes, indexed by number of arguments.
+  llvm::SmallVector<llvm::SmallVector<void *, 0>, 3> freeNodes;
 
+  void *allocateNode(unsigned numArgs);
   Node *createNode(mlir::Operation *op, NodeType type,
                    llvm::ArrayRef<Node *> args);
 };
@@ -36,6 +36,14 @@ llvm::StringRef getParallelName();
 llvm::StringRef getMaxConcurrencyName();
 llvm::StringRef getForceInlineName();
 llvm::StringRef getOptLevelName();
+llvm::StringRef getTileSizeName();
+llvm::StringRef getVectorLengthName();
+llvm::StringRef getVersionedName();
+llvm::StringRef getPoolAllocatorName();
+llvm::StringRef getStackPromotionSizeName();
+llvm::StringRef getReadonlyName();
+llvm::StringRef getArrayLayoutName();
+llvm::StringRef getBoundsCheckName();
 } // namespace attributes
 
 namespace detail {
@@ -55,7 +63,7 @@ static const constexpr OperatorNamePair OperatorNames[] = {
     {"-", "sub"}, // binary
     {"-", "neg"}, // unary
     {"*", "mul"},       {"**", "pow"}, {"/", "truediv"},
-    {"//", "floordiv"}, {"%", "mod"},
+    {"//", "floordiv"}, {"%", "mod"},  {"@", "matmul"},
 
     {">", "gt"},        {">=", "ge"},  {"<", "lt"},
     {"<=", "le"},       {"!=", "ne"},  {"==", "eq"},
@@ -32,4 +32,15 @@ struct IfOpConstCond : public mlir::OpRewritePattern<mlir::scf::IfOp> {
   matchAndRewrite(mlir::scf::IfOp op,
                   mlir::PatternRewriter &rewriter) const override;
 };
+
+/// Replaces scf.if, which only forwards values defined outside of it, with
+/// selects, so the containing loop can be vectorized.
+struct IfOpToSelect : public mlir::OpRewritePattern<mlir::scf::IfOp> {
+  IfOpToSelect(mlir::MLIRContext *context)
+      : mlir::OpRewritePattern<mlir::scf::IfOp>(context, /*benefit*/ 1) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::scf::IfOp op,
+                  mlir::PatternRewriter &rewriter) const override;
+};
 } // namespace plier
@@ -0,0 +1,31 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+namespace mlir {
+struct LogicalResult;
+class FuncOp;
+} // namespace mlir
+
+namespace plier {
+/// Replaces `linalg.generic` ops, which only copy input into a freshly
+/// allocated buffer with permuted dims and/or inserted unit dims (transpose,
+/// atleast_2d), with strided `memref.reinterpret_cast` views of the input.
+/// Copy is replaced only if result buffer is never written after the copy and
+/// source buffer is not modified while view is alive. Calls can read views
+/// through arguments marked with `#plier.readonly`.
+/// Expects bufferized IR before buffer deallocation.
+mlir::LogicalResult replaceCopiesWithViews(mlir::FuncOp func);
+} // namespace plier
@@ -44,6 +44,6 @@ mlir::LogicalResult lowerWhileToFor(
         getIterVal,
     llvm::function_ref<void(mlir::scf::ForOp)> results = nullptr);
 
-mlir::LogicalResult naivelyFuseParallelOps(mlir::Region &region);
+mlir::LogicalResult fuseParallelOps(mlir::Region &region);
 mlir::LogicalResult prepareForFusion(mlir::Region &region);
 } // namespace plier
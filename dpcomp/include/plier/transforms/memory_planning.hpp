@@ -0,0 +1,38 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+namespace mlir {
+struct LogicalResult;
+class FuncOp;
+} // namespace mlir
+
+namespace plier {
+/// Reuses temporary buffers with non-overlapping lifetimes.
+/// Expects `memref.alloc`/`memref.dealloc` pairs produced by buffer
+/// deallocation pass. Buffer, allocated for elementwise linalg.generic result
+/// is replaced with its input if the input dies at this op. Then buffers with
+/// the same type and sizes are assigned to shared slots if their lifetimes
+/// inside the block don't overlap.
+mlir::LogicalResult planBufferReuse(mlir::FuncOp func);
+
+/// Removes heap allocations of small static shape buffers, which don't escape
+/// the function (not returned, not passed to calls or `plier.retain`).
+/// Buffers, only accessed by loads and stores with constant indices in their
+/// block, are replaced with SSA values. Other buffers, not exceeding
+/// `#plier.stack_promotion_size` bytes and not nested in parallel loop, are
+/// replaced with `memref.alloca` in the function entry block.
+mlir::LogicalResult promoteSmallBuffers(mlir::FuncOp func);
+} // namespace plier
@@ -0,0 +1,30 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+namespace mlir {
+struct LogicalResult;
+class FuncOp;
+} // namespace mlir
+
+namespace plier {
+/// Removes `plier.retain` and `memref.dealloc` pairs on the same buffer.
+/// Retain is paired with the next dealloc of the same buffer (through views
+/// and retains) in the same block if nothing between them can release it.
+/// It covers freshly allocated buffers returned from function, which are
+/// uniquely owned by the function, and retain/release pairs left on inlined
+/// calls boundaries.
+mlir::LogicalResult elideRetainRelease(mlir::FuncOp func);
+} // namespace plier
@@ -0,0 +1,32 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+namespace mlir {
+struct LogicalResult;
+class FuncOp;
+} // namespace mlir
+
+namespace plier {
+/// Replaces memory accesses in `scf.for` loops with loop-carried scalars.
+/// Loads and stores of the same loop invariant element, which doesn't alias
+/// any other access in the loop, are replaced with an iteration argument,
+/// element is loaded before the loop and stored after it.
+/// Loads of `a[iv + c]` from memory, not modified inside the loop, are reused
+/// on subsequent iterations via rotating iteration arguments instead of being
+/// reloaded.
+/// Legality is checked using MemorySSA, built for the function.
+mlir::LogicalResult replaceLoopScalars(mlir::FuncOp func);
+} // namespace plier
@@ -14,20 +14,16 @@
 
 #pragma once
 
-#include <mlir/IR/PatternMatch.h>
-
 namespace mlir {
-namespace scf {
-class ForOp;
-}
+struct LogicalResult;
+class FuncOp;
 } // namespace mlir
 
 namespace plier {
-struct CanonicalizeReduction : public mlir::OpRewritePattern<mlir::scf::ForOp> {
-  using mlir::OpRewritePattern<mlir::scf::ForOp>::OpRewritePattern;
-
-  mlir::LogicalResult
-  matchAndRewrite(mlir::scf::ForOp op,
-                  mlir::PatternRewriter &rewriter) const override;
-};
+/// Tiles and vectorizes linalg.generic ops with buffer semantics.
+/// Ops with transposed accesses are tiled to `#plier.tile_size` tiles,
+/// innermost contiguous loop is vectorized using `#plier.vector_length` bytes
+/// vectors, with masked remainder. Missing attributes disable corresponding
+/// transformation.
+mlir::LogicalResult tileAndVectorizeLinalgOps(mlir::FuncOp func);
 } // namespace plier
@@ -0,0 +1,315 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "plier/analysis/alias_analysis.hpp"
+
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/Sequence.h>
+#include <llvm/ADT/SmallVector.h>
+
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/Dialect/StandardOps/IR/Ops.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Interfaces/LoopLikeInterface.h>
+#include <mlir/Interfaces/ViewLikeInterface.h>
+
+#include "plier/dialect.hpp"
+#include "plier/transforms/const_utils.hpp"
+
+namespace {
+/// Max depth of def chains decomposed into index expressions.
+constexpr unsigned MaxDecomposeDepth = 8;
+
+/// `value + constant`, value is null for constant indices.
+struct IndexExpr {
+  mlir::Value value;
+  int64_t constant = 0;
+};
+
+llvm::Optional<int64_t> getConstIndex(mlir::Value val) {
+  if (auto attr = plier::getConstVal<mlir::IntegerAttr>(val))
+    return plier::getIntAttrValue(attr);
+
+  return llvm::None;
+}
+
+IndexExpr getIndexExpr(mlir::Value val) {
+  IndexExpr ret;
+  for (unsigned depth = 0; depth < MaxDecomposeDepth; ++depth) {
+    if (auto cst = getConstIndex(val)) {
+      ret.constant += *cst;
+      return ret;
+    }
+    if (auto cast = val.getDefiningOp<mlir::IndexCastOp>()) {
+      val = cast.getOperand();
+      continue;
+    }
+    if (auto add = val.getDefiningOp<mlir::AddIOp>()) {
+      if (auto cst = getConstIndex(add.rhs())) {
+        ret.constant += *cst;
+        val = add.lhs();
+        continue;
+      }
+      if (auto cst = getConstIndex(add.lhs())) {
+        ret.constant += *cst;
+        val = add.rhs();
+        continue;
+      }
+    }
+    if (auto sub = val.getDefiningOp<mlir::SubIOp>()) {
+      if (auto cst = getConstIndex(sub.rhs())) {
+        ret.constant -= *cst;
+        val = sub.lhs();
+        continue;
+      }
+    }
+    break;
+  }
+  ret.value = val;
+  return ret;
+}
+
+IndexExpr getIndexExpr(mlir::OpFoldResult val) {
+  if (auto attr = val.dyn_cast<mlir::Attribute>()) {
+    IndexExpr ret;
+    ret.constant = plier::getIntAttrValue(attr.cast<mlir::IntegerAttr>());
+    return ret;
+  }
+  return getIndexExpr(val.get<mlir::Value>());
+}
+
+/// Values, defined inside loops can have different values on different
+/// iterations, they cannot be used to prove two accesses are disjoint.
+bool isLoopInvariant(mlir::Value val) {
+  if (!val)
+    return true;
+
+  auto op = val.getParentRegion()->getParentOp();
+  while (op && !mlir::isa<mlir::FuncOp>(op)) {
+    if (mlir::isa<mlir::LoopLikeOpInterface>(op))
+      return false;
+
+    op = op->getParentOp();
+  }
+  return true;
+}
+
+bool isSameExpr(const IndexExpr &lhs, const IndexExpr &rhs) {
+  return lhs.value == rhs.value && lhs.constant == rhs.constant;
+}
+
+bool isDifferentExpr(const IndexExpr &lhs, const IndexExpr &rhs) {
+  return lhs.value == rhs.value && lhs.constant != rhs.constant &&
+         isLoopInvariant(lhs.value);
+}
+
+mlir::Value skipCasts(mlir::Value memref) {
+  while (true) {
+    if (auto cast = memref.getDefiningOp<mlir::memref::CastOp>()) {
+      memref = cast.source();
+    } else if (auto retain = memref.getDefiningOp<plier::RetainOp>()) {
+      memref = retain.source();
+    } else {
+      return memref;
+    }
+  }
+}
+
+/// Returns buffer, the memref was derived from.
+mlir::Value getUnderlyingBuffer(mlir::Value memref) {
+  while (true) {
+    memref = skipCasts(memref);
+    auto view = memref.getDefiningOp<mlir::ViewLikeOpInterface>();
+    if (!view)
+      return memref;
+
+    memref = view.getViewSource();
+  }
+}
+
+/// Maps indices to the outermost memref through casts and rank-preserving
+/// unit stride subviews, `memref` is updated to the last visited memref.
+bool mapIndices(mlir::Value &memref, llvm::SmallVectorImpl<IndexExpr> &indices) {
+  while (true) {
+    memref = skipCasts(memref);
+    auto subview = memref.getDefiningOp<mlir::memref::SubViewOp>();
+    if (!subview)
+      return true;
+
+    if (subview.getSourceType().getRank() != subview.getType().getRank())
+      return true;
+
+    auto strides = subview.getMixedStrides();
+    if (llvm::any_of(strides, [](mlir::OpFoldResult stride) {
+          auto val = mlir::getConstantIntValue(stride);
+          return !val || *val != 1;
+        }))
+      return true;
+
+    for (auto it : llvm::zip(indices, subview.getMixedOffsets())) {
+      auto &index = std::get<0>(it);
+      auto offset = getIndexExpr(std::get<1>(it));
+      if (index.value && offset.value)
+        return false;
+
+      if (offset.value)
+        index.value = offset.value;
+
+      index.constant += offset.constant;
+    }
+    memref = subview.source();
+  }
+}
+
+/// Checks that different indices in dimension `dim` always address different
+/// elements.
+bool hasNonZeroStride(mlir::Value memref, unsigned dim) {
+  auto type = memref.getType().dyn_cast<mlir::MemRefType>();
+  if (!type)
+    return false;
+
+  int64_t offset;
+  llvm::SmallVector<int64_t> strides;
+  if (mlir::failed(mlir::getStridesAndOffset(type, strides, offset)))
+    return false;
+
+  return strides[dim] != 0;
+}
+
+bool isFreshAlloc(mlir::Value val) {
+  auto op = val.getDefiningOp();
+  return op && mlir::isa<mlir::memref::AllocOp, mlir::memref::AllocaOp>(op);
+}
+
+mlir::BlockArgument getFuncArg(mlir::Value val) {
+  auto arg = val.dyn_cast<mlir::BlockArgument>();
+  if (!arg || !arg.getOwner()->isEntryBlock())
+    return {};
+
+  if (!mlir::isa<mlir::FuncOp>(arg.getOwner()->getParentOp()))
+    return {};
+
+  return arg;
+}
+
+bool isNoAliasArg(mlir::BlockArgument arg) {
+  auto func = mlir::cast<mlir::FuncOp>(arg.getOwner()->getParentOp());
+  return static_cast<bool>(
+      func.getArgAttr(arg.getArgNumber(), "llvm.noalias"));
+}
+
+/// Checks if two different buffers can refer to the same memory.
+bool mayBeSameBuffer(mlir::Value lhs, mlir::Value rhs) {
+  auto lhsGlobal = lhs.getDefiningOp<mlir::memref::GetGlobalOp>();
+  auto rhsGlobal = rhs.getDefiningOp<mlir::memref::GetGlobalOp>();
+  if (lhsGlobal && rhsGlobal)
+    return lhsGlobal.name() == rhsGlobal.name();
+
+  if (isFreshAlloc(lhs) || isFreshAlloc(rhs)) {
+    auto other = isFreshAlloc(lhs) ? rhs : lhs;
+    return !isFreshAlloc(other) && !getFuncArg(other) &&
+           !other.getDefiningOp<mlir::memref::GetGlobalOp>();
+  }
+
+  auto lhsArg = getFuncArg(lhs);
+  auto rhsArg = getFuncArg(rhs);
+  if (lhsArg && rhsArg)
+    return !isNoAliasArg(lhsArg) && !isNoAliasArg(rhsArg);
+
+  return true;
+}
+
+/// Returns view start and sizes in the underlying buffer index space.
+bool getViewRange(mlir::Value &memref, llvm::SmallVectorImpl<IndexExpr> &start,
+                  llvm::SmallVectorImpl<int64_t> &sizes) {
+  auto type = memref.getType().dyn_cast<mlir::MemRefType>();
+  if (!type)
+    return false;
+
+  sizes.assign(type.getShape().begin(), type.getShape().end());
+  start.assign(sizes.size(), IndexExpr());
+  return mapIndices(memref, start);
+}
+
+bool isDisjointRange(const IndexExpr &start1, int64_t size1,
+                     const IndexExpr &start2, int64_t size2) {
+  if (start1.value != start2.value || !isLoopInvariant(start1.value))
+    return false;
+
+  if (mlir::ShapedType::isDynamic(size1) || mlir::ShapedType::isDynamic(size2))
+    return false;
+
+  return start1.constant + size1 <= start2.constant ||
+         start2.constant + size2 <= start1.constant;
+}
+} // namespace
+
+mlir::AliasResult plier::aliasMemrefs(mlir::Value lhs, mlir::Value rhs) {
+  lhs = skipCasts(lhs);
+  rhs = skipCasts(rhs);
+  if (lhs == rhs)
+    return mlir::AliasResult::MustAlias;
+
+  auto lhsBuffer = getUnderlyingBuffer(lhs);
+  auto rhsBuffer = getUnderlyingBuffer(rhs);
+  if (lhsBuffer != rhsBuffer)
+    return mayBeSameBuffer(lhsBuffer, rhsBuffer) ? mlir::AliasResult::MayAlias
+                                                 : mlir::AliasResult::NoAlias;
+
+  llvm::SmallVector<IndexExpr> lhsStart;
+  llvm::SmallVector<IndexExpr> rhsStart;
+  llvm::SmallVector<int64_t> lhsSizes;
+  llvm::SmallVector<int64_t> rhsSizes;
+  auto lhsSource = lhs;
+  auto rhsSource = rhs;
+  if (!getViewRange(lhsSource, lhsStart, lhsSizes) ||
+      !getViewRange(rhsSource, rhsStart, rhsSizes) || lhsSource != rhsSource)
+    return mlir::AliasResult::MayAlias;
+
+  for (auto i : llvm::seq<size_t>(0, lhsStart.size()))
+    if (isDisjointRange(lhsStart[i], lhsSizes[i], rhsStart[i], rhsSizes[i]))
+      return mlir::AliasResult::NoAlias;
+
+  return mlir::AliasResult::MayAlias;
+}
+
+mlir::AliasResult plier::aliasAccesses(mlir::Value lhs,
+                                       mlir::ValueRange lhsIndices,
+                                       mlir::Value rhs,
+                                       mlir::ValueRange rhsIndices) {
+  auto result = aliasMemrefs(lhs, rhs);
+  if (result.isNo())
+    return result;
+
+  auto getIndices = [](mlir::ValueRange indices) {
+    return llvm::to_vector<4>(llvm::map_range(
+        indices, [](mlir::Value val) { return getIndexExpr(val); }));
+  };
+  auto lhsExprs = getIndices(lhsIndices);
+  auto rhsExprs = getIndices(rhsIndices);
+  if (!mapIndices(lhs, lhsExprs) || !mapIndices(rhs, rhsExprs) || lhs != rhs)
+    return mlir::AliasResult::MayAlias;
+
+  bool same = true;
+  for (auto it : llvm::enumerate(llvm::zip(lhsExprs, rhsExprs))) {
+    auto &lhsExpr = std::get<0>(it.value());
+    auto &rhsExpr = std::get<1>(it.value());
+    if (isDifferentExpr(lhsExpr, rhsExpr) &&
+        hasNonZeroStride(lhs, static_cast<unsigned>(it.index())))
+      return mlir::AliasResult::NoAlias;
+
+    same = same && isSameExpr(lhsExpr, rhsExpr);
+  }
+  return same ? mlir::AliasResult::MustAlias : mlir::AliasResult::MayAlias;
+}
@@ -0,0 +1,274 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "plier/analysis/dependence.hpp"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/Support/MathExtras.h>
+
+#include <cstdlib>
+
+#include <mlir/Dialect/SCF/SCF.h>
+#include <mlir/Dialect/StandardOps/IR/Ops.h>
+
+#include "plier/transforms/const_utils.hpp"
+
+namespace {
+/// Max depth of def chains decomposed into linear expressions.
+constexpr unsigned MaxDecomposeDepth = 8;
+
+/// `constant + sum(coeff * value)`
+struct LinearExpr {
+  int64_t constant = 0;
+  llvm::SmallVector<std::pair<mlir::Value, int64_t>, 4> terms;
+
+  void addTerm(mlir::Value val, int64_t coeff) {
+    for (auto &term : terms) {
+      if (term.first == val) {
+        term.second += coeff;
+        return;
+      }
+    }
+    terms.emplace_back(val, coeff);
+  }
+};
+
+void decompose(mlir::Value val, int64_t mult, LinearExpr &expr,
+               unsigned depth = 0) {
+  if (auto attr = plier::getConstVal<mlir::IntegerAttr>(val)) {
+    expr.constant += mult * plier::getIntAttrValue(attr);
+    return;
+  }
+
+  if (depth < MaxDecomposeDepth) {
+    if (auto cast = val.getDefiningOp<mlir::IndexCastOp>()) {
+      decompose(cast.getOperand(), mult, expr, depth + 1);
+      return;
+    }
+    if (auto add = val.getDefiningOp<mlir::AddIOp>()) {
+      decompose(add.lhs(), mult, expr, depth + 1);
+      decompose(add.rhs(), mult, expr, depth + 1);
+      return;
+    }
+    if (auto sub = val.getDefiningOp<mlir::SubIOp>()) {
+      decompose(sub.lhs(), mult, expr, depth + 1);
+      decompose(sub.rhs(), -mult, expr, depth + 1);
+      return;
+    }
+    if (auto mul = val.getDefiningOp<mlir::MulIOp>()) {
+      if (auto attr = plier::getConstVal<mlir::IntegerAttr>(mul.rhs())) {
+        decompose(mul.lhs(), mult * plier::getIntAttrValue(attr), expr,
+                  depth + 1);
+        return;
+      }
+      if (auto attr = plier::getConstVal<mlir::IntegerAttr>(mul.lhs())) {
+        decompose(mul.rhs(), mult * plier::getIntAttrValue(attr), expr,
+                  depth + 1);
+        return;
+      }
+    }
+  }
+
+  expr.addTerm(val, mult);
+}
+
+struct LoopInfo {
+  llvm::SmallVector<mlir::Value, 2> ivs;
+  /// Constant steps, 0 if unknown.
+  llvm::SmallVector<int64_t, 2> steps;
+  /// Constant `upper - lower` distances, 0 if unknown.
+  llvm::SmallVector<int64_t, 2> ranges;
+};
+
+llvm::Optional<LoopInfo> getLoopInfo(mlir::Operation *op) {
+  LoopInfo ret;
+  auto fill = [&](mlir::ValueRange ivs, mlir::ValueRange lowerBounds,
+                  mlir::ValueRange upperBounds, mlir::ValueRange steps) {
+    ret.ivs.assign(ivs.begin(), ivs.end());
+    auto getConst = [](mlir::Value val) -> llvm::Optional<int64_t> {
+      if (auto attr = plier::getConstVal<mlir::IntegerAttr>(val))
+        return plier::getIntAttrValue(attr);
+
+      return llvm::None;
+    };
+    for (auto it : llvm::zip(lowerBounds, upperBounds, steps)) {
+      auto step = getConst(std::get<2>(it));
+      ret.steps.emplace_back(step ? *step : 0);
+
+      auto lower = getConst(std::get<0>(it));
+      auto upper = getConst(std::get<1>(it));
+      ret.ranges.emplace_back(lower && upper ? *upper - *lower : 0);
+    }
+  };
+
+  if (auto loop = mlir::dyn_cast<mlir::scf::ForOp>(op)) {
+    fill(loop.getInductionVar(), loop.lowerBound(), loop.upperBound(),
+         loop.step());
+    return ret;
+  }
+  if (auto loop = mlir::dyn_cast<mlir::scf::ParallelOp>(op)) {
+    fill(loop.getInductionVars(), loop.lowerBound(), loop.upperBound(),
+         loop.step());
+    return ret;
+  }
+  return llvm::None;
+}
+
+struct DimInfo {
+  bool independent = false;
+  /// Induction variable index and constant distance `iv1 - iv2` between
+  /// iterations accessing the same element.
+  llvm::Optional<std::pair<unsigned, int64_t>> distance;
+};
+
+/// Solves `expr1(iv1) == expr2(iv2)`. Loop invariant values are the same for
+/// both expressions, other values defined inside the loops (including inner
+/// loops induction variables) are treated as unknown independent variables.
+DimInfo analyzeDim(const LinearExpr &expr1, mlir::Operation *loop1,
+                   const LinearExpr &expr2, mlir::Operation *loop2,
+                   const LoopInfo &info) {
+  DimInfo ret;
+  uint64_t gcd = 0;
+  auto addCoeff = [&](int64_t coeff) {
+    if (coeff != 0)
+      gcd = llvm::GreatestCommonDivisor64(
+          gcd, static_cast<uint64_t>(coeff < 0 ? -coeff : coeff));
+  };
+
+  bool hasUnknown = false;
+  llvm::SmallVector<std::pair<unsigned, int64_t>, 2> ivs1;
+  llvm::SmallVector<std::pair<unsigned, int64_t>, 2> ivs2;
+  llvm::SmallDenseMap<mlir::Value, int64_t> invariants;
+  auto collect = [&](const LinearExpr &expr, mlir::Operation *loop,
+                     llvm::ArrayRef<mlir::Value> loopIvs,
+                     llvm::SmallVectorImpl<std::pair<unsigned, int64_t>> &ivs,
+                     int64_t sign) {
+    for (auto &term : expr.terms) {
+      auto coeff = term.second;
+      if (coeff == 0)
+        continue;
+
+      auto val = term.first;
+      auto it = llvm::find(loopIvs, val);
+      if (it != loopIvs.end()) {
+        auto index = static_cast<unsigned>(std::distance(loopIvs.begin(), it));
+        ivs.emplace_back(index, coeff);
+        addCoeff(coeff);
+      } else if (loop->isAncestor(val.getParentRegion()->getParentOp())) {
+        hasUnknown = true;
+        addCoeff(coeff);
+      } else {
+        invariants[val] += sign * coeff;
+      }
+    }
+  };
+
+  auto info1 = getLoopInfo(loop1);
+  auto info2 = getLoopInfo(loop2);
+  assert(info1 && info2);
+  collect(expr1, loop1, info1->ivs, ivs1, 1);
+  collect(expr2, loop2, info2->ivs, ivs2, -1);
+  for (auto &it : invariants) {
+    if (it.second != 0) {
+      hasUnknown = true;
+      addCoeff(it.second);
+    }
+  }
+
+  // sum(coeff * var) == diff
+  auto diff = expr2.constant - expr1.constant;
+  if (gcd == 0) {
+    ret.independent = (diff != 0);
+    return ret;
+  }
+  if (diff % static_cast<int64_t>(gcd) != 0) {
+    ret.independent = true;
+    return ret;
+  }
+
+  if (hasUnknown || ivs1.size() != 1 || ivs2.size() != 1 ||
+      ivs1.front() != ivs2.front())
+    return ret;
+
+  // coeff * (iv1 - iv2) == diff
+  auto index = ivs1.front().first;
+  auto dist = diff / ivs1.front().second;
+  if (dist != 0) {
+    auto step = info.steps[index];
+    auto range = info.ranges[index];
+    if ((step != 0 && dist % step != 0) ||
+        (range != 0 && std::abs(dist) >= std::abs(range))) {
+      ret.independent = true;
+      return ret;
+    }
+  }
+  ret.distance = std::make_pair(index, dist);
+  return ret;
+}
+} // namespace
+
+plier::Dependence plier::checkLoopDependence(const LoopAccess &first,
+                                             const LoopAccess &second) {
+  Dependence ret;
+  auto info = getLoopInfo(first.loop);
+  auto secondInfo = getLoopInfo(second.loop);
+  if (!info || !secondInfo || info->ivs.size() != secondInfo->ivs.size())
+    return ret;
+
+  if (first.indices.size() != second.indices.size())
+    return ret;
+
+  auto numIvs = info->ivs.size();
+  llvm::SmallVector<llvm::Optional<int64_t>, 2> distances(numIvs);
+  llvm::SmallVector<unsigned, 2> distanceDims(numIvs);
+  for (auto it : llvm::enumerate(llvm::zip(first.indices, second.indices))) {
+    auto dim = static_cast<unsigned>(it.index());
+    LinearExpr expr1;
+    LinearExpr expr2;
+    decompose(std::get<0>(it.value()), 1, expr1);
+    decompose(std::get<1>(it.value()), 1, expr2);
+    auto dimInfo = analyzeDim(expr1, first.loop, expr2, second.loop, *info);
+    if (dimInfo.independent) {
+      ret.kind = DependenceKind::Independent;
+      ret.dims.emplace_back(dim);
+      return ret;
+    }
+    if (!dimInfo.distance)
+      continue;
+
+    auto index = dimInfo.distance->first;
+    auto dist = dimInfo.distance->second;
+    if (distances[index] && *distances[index] != dist) {
+      // Different dimensions require different distances.
+      ret.kind = DependenceKind::Independent;
+      ret.dims.emplace_back(distanceDims[index]);
+      ret.dims.emplace_back(dim);
+      return ret;
+    }
+    distances[index] = dist;
+    distanceDims[index] = dim;
+  }
+
+  for (auto &dist : distances)
+    if (!dist || *dist != 0)
+      return ret;
+
+  ret.kind = DependenceKind::SameIteration;
+  for (auto dim : distanceDims)
+    if (!llvm::is_contained(ret.dims, dim))
+      ret.dims.emplace_back(dim);
+
+  return ret;
+}
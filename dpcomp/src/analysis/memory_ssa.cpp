@@ -155,11 +155,18 @@ private:
   Arg args[1]; // Variadic size
 };
 
+void *plier::MemorySSA::allocateNode(unsigned numArgs) {
+  if (numArgs < freeNodes.size() && !freeNodes[numArgs].empty())
+    return freeNodes[numArgs].pop_back_val();
+
+  return allocator.Allocate(Node::computeSize(numArgs),
+                            std::alignment_of<Node>::value);
+}
+
 plier::MemorySSA::Node *
 plier::MemorySSA::createNode(mlir::Operation *op, NodeType type,
                              llvm::ArrayRef<plier::MemorySSA::Node *> args) {
-  auto ptr = allocator.Allocate(Node::computeSize(args.size()),
-                                std::alignment_of<Node>::value);
+  auto ptr = allocateNode(static_cast<unsigned>(args.size()));
   auto node = new (ptr) Node(op, type, args);
   nodesMap[op] = node;
   nodes.push_back(*node);
@@ -190,24 +197,34 @@ void plier::MemorySSA::eraseNode(plier::MemorySSA::Node *node) {
     assert(nullptr != prev);
     for (auto use : llvm::make_early_inc_range(node->getUses())) {
       use.user->setArgument(use.index, prev);
+      if (use.user->dominator == node)
+        use.user->setDominator(prev);
     }
 
     auto postDom = node->postDominator;
     if (nullptr != postDom) {
       assert(postDom->dominator == node);
       postDom->setDominator(prev);
-      if (nullptr == prev->postDominator) {
-        prev->setPostDominator(postDom);
-      }
+    }
+    // Node memory is reused, don't leave dangling references.
+    if (nullptr == prev->postDominator || node == prev->postDominator) {
+      prev->setPostDominator(postDom);
     }
   }
   assert(node->getUsers().empty());
   auto op = node->getOperation();
   if (op != nullptr) {
-    nodesMap.erase(op);
+    auto it = nodesMap.find(op);
+    if (it != nodesMap.end() && it->second == node)
+      nodesMap.erase(it);
   }
   nodes.erase(node->getIterator());
+  auto numArgs = node->getNumArguments();
   node->~Node();
+  if (freeNodes.size() <= numArgs)
+    freeNodes.resize(numArgs + 1);
+
+  freeNodes[numArgs].emplace_back(node);
 }
 
 plier::MemorySSA::NodeType
@@ -240,8 +257,7 @@ plier::MemorySSA::getUsers(plier::MemorySSA::Node *node) {
 
 plier::MemorySSA::Node *plier::MemorySSA::getRoot() {
   if (nullptr == root) {
-    root = new (allocator.Allocate(Node::computeSize(0),
-                                   std::alignment_of<Node>::value)) Node();
+    root = new (allocateNode(0)) Node();
     nodes.push_back(*root);
   }
   return root;
@@ -250,9 +266,7 @@ plier::MemorySSA::Node *plier::MemorySSA::getRoot() {
 plier::MemorySSA::Node *plier::MemorySSA::getTerm() {
   if (nullptr == term) {
     Node *temp = nullptr;
-    term = new (allocator.Allocate(Node::computeSize(1),
-                                   std::alignment_of<Node>::value))
-        Node(nullptr, NodeType::Term, temp);
+    term = new (allocateNode(1)) Node(nullptr, NodeType::Term, temp);
     nodes.push_back(*term);
   }
   return term;
@@ -634,6 +648,25 @@ llvm::Optional<plier::MemorySSA> plier::buildMemorySSA(mlir::Region &region) {
   return std::move(ret);
 }
 
+void plier::MemorySSA::eraseOp(mlir::Operation *op) {
+  assert(nullptr != op);
+  assert(op->getNumRegions() == 0 && "Ops with regions are not supported");
+  auto node = getNode(op);
+  if (nullptr == node)
+    return;
+
+  auto isUse = (NodeType::Use == node->getType());
+  eraseNode(node);
+  if (!isUse || !hasMemEffect(*op).write)
+    return;
+
+  // Op both reads and writes, its def node is shadowed by the use node.
+  auto it =
+      llvm::find_if(nodes, [&](Node &n) { return n.getOperation() == op; });
+  assert(it != nodes.end());
+  eraseNode(&*it);
+}
+
 plier::MemorySSA::NodesIterator::NodesIterator(
     plier::MemorySSA::NodesIterator::internal_iterator iter)
     : iterator(iter) {}
@@ -17,6 +17,8 @@
 #include <mlir/Analysis/AliasAnalysis.h>
 #include <mlir/Dialect/MemRef/IR/MemRef.h>
 
+#include "plier/analysis/alias_analysis.hpp"
+
 namespace {
 struct Meminfo {
   mlir::Value memref;
@@ -63,6 +65,11 @@ mlir::LogicalResult plier::MemorySSAAnalysis::optimizeUses() {
       auto memref2 = info2->memref;
       assert(memref1);
       assert(memref2);
+      if (plier::aliasAccesses(memref1, info1->indices, memref2,
+                               info2->indices)
+              .isNo()) {
+        return false;
+      }
       auto result = aliasAnalysis->alias(memref1, memref2);
       return !result.isNo();
     };
@@ -64,6 +64,32 @@ llvm::StringRef attributes::getForceInlineName() {
 
 llvm::StringRef attributes::getOptLevelName() { return "#plier.opt_level"; }
 
+llvm::StringRef attributes::getTileSizeName() { return "#plier.tile_size"; }
+
+llvm::StringRef attributes::getVectorLengthName() {
+  return "#plier.vector_length";
+}
+
+llvm::StringRef attributes::getVersionedName() { return "#plier.versioned"; }
+
+llvm::StringRef attributes::getPoolAllocatorName() {
+  return "#plier.pool_allocator";
+}
+
+llvm::StringRef attributes::getStackPromotionSizeName() {
+  return "#plier.stack_promotion_size";
+}
+
+llvm::StringRef attributes::getReadonlyName() { return "#plier.readonly"; }
+
+llvm::StringRef attributes::getArrayLayoutName() {
+  return "#plier.array_layout";
+}
+
+llvm::StringRef attributes::getBoundsCheckName() {
+  return "#plier.bounds_check";
+}
+
 namespace detail {
 struct PyTypeStorage : public mlir::TypeStorage {
   using KeyTy = mlir::StringRef;
@@ -808,6 +834,13 @@ ExtractMemrefMetadataOp::fold(llvm::ArrayRef<mlir::Attribute> /*operands*/) {
   return nullptr;
 }
 
+void ExtractMemrefPointerOp::build(::mlir::OpBuilder &odsBuilder,
+                                   ::mlir::OperationState &odsState,
+                                   ::mlir::Value src) {
+  ExtractMemrefPointerOp::build(odsBuilder, odsState,
+                                odsBuilder.getIndexType(), src);
+}
+
 } // namespace plier
 
 #include "plier/PlierOpsDialect.cpp.inc"
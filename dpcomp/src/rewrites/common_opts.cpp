@@ -14,6 +14,7 @@
 
 #include "plier/rewrites/common_opts.hpp"
 
+#include "plier/dialect.hpp"
 #include "plier/rewrites/cse.hpp"
 #include "plier/rewrites/force_inline.hpp"
 #include "plier/rewrites/if_rewrites.hpp"
@@ -100,6 +101,55 @@ struct SubviewStorePropagate
     return mlir::success();
   }
 };
+
+/// Collects all users of the `memref` if its data is never read.
+static bool
+collectWriteOnlyUsers(mlir::Value memref,
+                      llvm::SmallVectorImpl<mlir::Operation *> &users) {
+  for (auto user : memref.getUsers()) {
+    if (auto store = mlir::dyn_cast<mlir::memref::StoreOp>(user)) {
+      if (store.value() == memref)
+        return false;
+
+      users.emplace_back(user);
+      continue;
+    }
+    if (mlir::isa<mlir::memref::DeallocOp>(user)) {
+      users.emplace_back(user);
+      continue;
+    }
+    if (mlir::isa<mlir::memref::SubViewOp, mlir::memref::CastOp,
+                  plier::ReduceRankOp>(user)) {
+      if (!collectWriteOnlyUsers(user->getResult(0), users))
+        return false;
+
+      users.emplace_back(user);
+      continue;
+    }
+    return false;
+  }
+  return true;
+}
+
+// Remove buffers which are only written to, e.g. intermediate buffers left
+// after loop fusion.
+template <typename Op>
+struct RemoveWriteOnlyBuffer : public mlir::OpRewritePattern<Op> {
+  using mlir::OpRewritePattern<Op>::OpRewritePattern;
+
+  mlir::LogicalResult
+  matchAndRewrite(Op op, mlir::PatternRewriter &rewriter) const override {
+    llvm::SmallVector<mlir::Operation *> users;
+    if (!collectWriteOnlyUsers(op.getResult(), users))
+      return mlir::failure();
+
+    for (auto user : users)
+      rewriter.eraseOp(user);
+
+    rewriter.eraseOp(op);
+    return mlir::success();
+  }
+};
 } // namespace
 
 void plier::populate_common_opts_patterns(mlir::MLIRContext &context,
@@ -113,9 +163,12 @@ void plier::populate_common_opts_patterns(mlir::MLIRContext &context,
 //      LoopInvariantCodeMotion, TODO
       plier::CmpLoopBoundsSimplify,
       plier::IfOpConstCond,
+      plier::IfOpToSelect,
       plier::CSERewrite<mlir::FuncOp, /*recusive*/ false>,
       SubviewLoadPropagate,
-      SubviewStorePropagate
+      SubviewStorePropagate,
+      RemoveWriteOnlyBuffer<mlir::memref::AllocOp>,
+      RemoveWriteOnlyBuffer<mlir::memref::AllocaOp>
       // clang-format on
       >(&context);
 
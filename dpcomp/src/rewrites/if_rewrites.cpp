@@ -64,3 +64,36 @@ plier::IfOpConstCond::matchAndRewrite(mlir::scf::IfOp op,
 
   return mlir::success();
 }
+
+mlir::LogicalResult
+plier::IfOpToSelect::matchAndRewrite(mlir::scf::IfOp op,
+                                     mlir::PatternRewriter &rewriter) const {
+  if (op.getNumResults() == 0 || op.elseRegion().empty())
+    return mlir::failure();
+
+  // Only values already computed outside can be selected without speculating
+  // branch ops.
+  auto getYield = [](mlir::Block &block) -> mlir::scf::YieldOp {
+    if (!llvm::hasSingleElement(block))
+      return {};
+
+    return mlir::cast<mlir::scf::YieldOp>(block.getTerminator());
+  };
+  auto thenYield = getYield(op.thenRegion().front());
+  auto elseYield = getYield(op.elseRegion().front());
+  if (!thenYield || !elseYield)
+    return mlir::failure();
+
+  auto loc = op.getLoc();
+  auto cond = op.condition();
+  llvm::SmallVector<mlir::Value> results(op.getNumResults());
+  for (auto it : llvm::enumerate(
+           llvm::zip(thenYield.getOperands(), elseYield.getOperands()))) {
+    auto trueVal = std::get<0>(it.value());
+    auto falseVal = std::get<1>(it.value());
+    results[it.index()] =
+        rewriter.createOrFold<mlir::SelectOp>(loc, cond, trueVal, falseVal);
+  }
+  rewriter.replaceOp(op, results);
+  return mlir::success();
+}
@@ -19,6 +19,7 @@
 #include <mlir/IR/BuiltinOps.h>
 #include <mlir/IR/Dominance.h>
 
+#include "plier/analysis/alias_analysis.hpp"
 #include "plier/analysis/memory_ssa_analysis.hpp"
 
 namespace {
@@ -48,8 +49,9 @@ struct MustAlias {
     if (!meminfo2) {
       return false;
     }
-    return meminfo1->memref == meminfo2->memref &&
-           meminfo1->indices == meminfo2->indices;
+    return plier::aliasAccesses(meminfo1->memref, meminfo1->indices,
+                                meminfo2->memref, meminfo2->indices)
+        .isMust();
   }
 };
 
@@ -76,8 +78,8 @@ mlir::LogicalResult foldLoads(plier::MemorySSAAnalysis &memSSAAnalysis) {
       if (MustAlias()(op1, op2)) {
         auto val = mlir::cast<mlir::memref::StoreOp>(op2).value();
         op1->replaceAllUsesWith(mlir::ValueRange(val));
+        memSSA.eraseOp(op1);
         op1->erase();
-        memSSA.eraseNode(&node);
         changed = true;
       }
     }
@@ -115,8 +117,8 @@ deadStoreElemination(plier::MemorySSAAnalysis &memSSAAnalysis) {
         assert(nullptr != op1);
         assert(nullptr != op2);
         if (MustAlias()(op1, op2)) {
+          memSSA.eraseOp(op1);
           op1->erase();
-          memSSA.eraseNode(&node);
           changed = true;
         }
       }
@@ -186,15 +188,13 @@ mlir::LogicalResult loadCSE(plier::MemorySSAAnalysis &memSSAAnalysis) {
         if (dom.properlyDominates(op, firstUser)) {
           firstUser->replaceAllUsesWith(op);
           opsMap[firstUser] = op;
-          auto firstUserNode = memSSA.getNode(firstUser);
-          assert(firstUserNode);
-          memSSA.eraseNode(firstUserNode);
+          memSSA.eraseOp(firstUser);
           firstUser->erase();
           changed = true;
         } else if (dom.properlyDominates(firstUser, op)) {
           op->replaceAllUsesWith(firstUser);
+          memSSA.eraseOp(op);
           op->erase();
-          memSSA.eraseNode(user);
           changed = true;
         }
       }
@@ -14,10 +14,14 @@
 
 #include "plier/rewrites/promote_to_parallel.hpp"
 
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
 #include <mlir/Dialect/SCF/SCF.h>
 #include <mlir/Dialect/StandardOps/IR/Ops.h>
 #include <mlir/IR/BlockAndValueMapping.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/BuiltinTypes.h>
 
+#include "plier/analysis/dependence.hpp"
 #include "plier/dialect.hpp"
 
 namespace {
@@ -52,54 +56,386 @@ static mlir::Operation *getSingleUser(mlir::Value val) {
   return *val.user_begin();
 }
 
+/// Matches `select(cmp(x, acc), x, acc)` min/max reduction, with any order of
+/// cmp and select operands. NaN propagating form
+/// `select(x != x, x, select(cmp(x, acc), x, acc))` is also accepted. Returns
+/// `x` or null.
+mlir::Value getMinMaxReduceOps(mlir::BlockArgument arg,
+                               mlir::scf::YieldOp yield,
+                               llvm::SmallVectorImpl<mlir::Operation *> &ops) {
+  mlir::Operation *cmp = nullptr;
+  mlir::SelectOp select;
+  for (auto user : arg.getUsers()) {
+    if (mlir::isa<mlir::CmpFOp, mlir::CmpIOp>(user) && !cmp) {
+      cmp = user;
+    } else if (mlir::isa<mlir::SelectOp>(user) && !select) {
+      select = mlir::cast<mlir::SelectOp>(user);
+    } else {
+      return {};
+    }
+  }
+  if (!cmp || !select || select.condition() != cmp->getResult(0) ||
+      !cmp->hasOneUse() || !select->hasOneUse())
+    return {};
+
+  auto getOther = [&](mlir::Value lhs, mlir::Value rhs) -> mlir::Value {
+    if (lhs == arg)
+      return rhs;
+    if (rhs == arg)
+      return lhs;
+    return {};
+  };
+  auto val = getOther(cmp->getOperand(0), cmp->getOperand(1));
+  if (!val || val == arg ||
+      val != getOther(select.true_value(), select.false_value()))
+    return {};
+
+  auto nanSelect = mlir::dyn_cast<mlir::SelectOp>(*select->user_begin());
+  if (nanSelect) {
+    auto nanCmp = nanSelect.condition().getDefiningOp<mlir::CmpFOp>();
+    if (!nanCmp || !nanCmp->hasOneUse() || nanCmp.lhs() != val ||
+        nanCmp.rhs() != val ||
+        (nanCmp.predicate() != mlir::CmpFPredicate::UNE &&
+         nanCmp.predicate() != mlir::CmpFPredicate::UNO) ||
+        nanSelect.true_value() != val ||
+        nanSelect.false_value() != select.getResult() ||
+        !nanSelect->hasOneUse())
+      return {};
+
+    ops.emplace_back(nanCmp);
+  }
+
+  auto result = nanSelect ? nanSelect.getResult() : select.getResult();
+  if (getSingleUser(result) != yield.getOperation() ||
+      yield.getOperand(arg.getArgNumber() - 1) != result)
+    return {};
+
+  ops.emplace_back(cmp);
+  ops.emplace_back(select);
+  if (nanSelect)
+    ops.emplace_back(nanSelect);
+
+  return val;
+}
+
+/// Collects ops in the loop body, computing the next value of the reduction
+/// `arg`. Ops are either a chain, where each op takes result of the previous
+/// one and loop invariant values, or min/max select. Returns reduced value,
+/// computed in the loop body, or null if ops don't form a reduction.
+mlir::Value getReduceOps(mlir::BlockArgument arg, mlir::scf::YieldOp yield,
+                         llvm::SmallVectorImpl<mlir::Operation *> &ops) {
+  auto &body = *arg.getOwner();
+  auto reduceOp = getSingleUser(arg);
+  if (!reduceOp)
+    return getMinMaxReduceOps(arg, yield, ops);
+
+  if (reduceOp->getNumOperands() != 2 || reduceOp->getNumResults() != 1)
+    return {};
+
+  auto firstOperands = reduceOp->getOperands();
+  auto reduceOperand =
+      (firstOperands[0] == arg ? firstOperands[1] : firstOperands[0]);
+  if (reduceOperand == arg)
+    return {};
+
+  while (true) {
+    auto nextOp = getSingleUser(reduceOp->getResult(0));
+    if (!nextOp)
+      return {};
+
+    ops.emplace_back(reduceOp);
+    if (nextOp == yield.getOperation()) {
+      auto yieldOperand = yield.getOperand(arg.getArgNumber() - 1);
+      if (yieldOperand != reduceOp->getResult(0))
+        return {};
+
+      break;
+    }
+    for (auto operand : nextOp->getOperands()) {
+      if (operand.getDefiningOp() != reduceOp &&
+          operand.getParentBlock() == &body)
+        return {};
+    }
+    reduceOp = nextOp;
+  }
+  return reduceOperand;
+}
+
+// Max number of memref pairs checked for aliasing at runtime.
+const constexpr unsigned MaxAliasChecks = 16;
+
+struct MemrefAccess {
+  mlir::Value memref;
+  mlir::ValueRange indices;
+  bool isWrite;
+};
+
+/// Memrefs, accessed inside the loop, which must be checked for aliasing at
+/// runtime before loop can be parallelized.
+struct AliasChecks {
+  llvm::SmallVector<std::pair<mlir::Value, mlir::Value>> pairs;
+  /// Written memrefs and dimensions, used by dependence analysis to prove
+  /// independence. Stride of this dimension must be non-zero.
+  llvm::SmallVector<std::pair<mlir::Value, unsigned>> strides;
+
+  bool empty() const { return pairs.empty() && strides.empty(); }
+};
+
+bool isAllocatedInside(mlir::Value memref, mlir::Operation *loop) {
+  auto op = memref.getDefiningOp();
+  if (!op || !mlir::isa<mlir::memref::AllocOp, mlir::memref::AllocaOp>(op))
+    return false;
+
+  return loop->isProperAncestor(op);
+}
+
+/// Fresh allocation cannot alias function arguments or another allocation.
+bool isDistinctAlloc(mlir::Value memref1, mlir::Value memref2) {
+  auto isAlloc = [](mlir::Value val) {
+    auto op = val.getDefiningOp();
+    return op && mlir::isa<mlir::memref::AllocOp, mlir::memref::AllocaOp>(op);
+  };
+  auto isFuncArg = [](mlir::Value val) {
+    auto arg = val.dyn_cast<mlir::BlockArgument>();
+    return arg && mlir::isa<mlir::FuncOp>(arg.getOwner()->getParentOp());
+  };
+  if (memref1 == memref2)
+    return false;
+
+  return (isAlloc(memref1) && (isAlloc(memref2) || isFuncArg(memref2))) ||
+         (isAlloc(memref2) && isFuncArg(memref1));
+}
+
+/// Checks if loop with memory writes can be parallelized if memrefs don't
+/// alias. Dependence analysis must prove that accesses to written memrefs
+/// never touch the same elements on different iterations.
+llvm::Optional<AliasChecks> getAliasChecks(mlir::scf::ForOp loop) {
+  llvm::SmallVector<MemrefAccess> accesses;
+  llvm::SmallVector<mlir::Value> memrefs;
+  llvm::SmallVector<mlir::Value> written;
+  auto addAccess = [&](mlir::Value memref, mlir::ValueRange indices,
+                       bool isWrite) {
+    if (isAllocatedInside(memref, loop))
+      return true;
+
+    if (loop->isAncestor(memref.getParentRegion()->getParentOp()))
+      return false;
+
+    auto elemType = memref.getType().cast<mlir::MemRefType>().getElementType();
+    if (!elemType.isIntOrFloat())
+      return false;
+
+    accesses.push_back({memref, indices, isWrite});
+    if (!llvm::is_contained(memrefs, memref))
+      memrefs.emplace_back(memref);
+
+    if (isWrite && !llvm::is_contained(written, memref))
+      written.emplace_back(memref);
+
+    return true;
+  };
+
+  auto res = loop.getBody()->walk([&](mlir::Operation *op) {
+    if (auto load = mlir::dyn_cast<mlir::memref::LoadOp>(op)) {
+      if (!addAccess(load.memref(), load.indices(), /*isWrite*/ false))
+        return mlir::WalkResult::interrupt();
+
+      return mlir::WalkResult::advance();
+    }
+    if (auto store = mlir::dyn_cast<mlir::memref::StoreOp>(op)) {
+      if (!addAccess(store.memref(), store.indices(), /*isWrite*/ true))
+        return mlir::WalkResult::interrupt();
+
+      return mlir::WalkResult::advance();
+    }
+    if (mlir::isa<mlir::CallOpInterface>(op))
+      return mlir::WalkResult::interrupt();
+
+    if (auto effects = mlir::dyn_cast<mlir::MemoryEffectOpInterface>(op)) {
+      if (effects.hasEffect<mlir::MemoryEffects::Write>() ||
+          effects.hasEffect<mlir::MemoryEffects::Read>())
+        return mlir::WalkResult::interrupt();
+
+      return mlir::WalkResult::advance();
+    }
+    if (op->hasTrait<mlir::OpTrait::HasRecursiveSideEffects>())
+      return mlir::WalkResult::advance();
+
+    return mlir::WalkResult::interrupt();
+  });
+  if (res.wasInterrupted())
+    return {};
+
+  AliasChecks ret;
+  for (auto memref : written) {
+    auto type = memref.getType().cast<mlir::MemRefType>();
+    int64_t offset;
+    llvm::SmallVector<int64_t> strides;
+    if (mlir::failed(mlir::getStridesAndOffset(type, strides, offset)))
+      return {};
+
+    for (auto &store : accesses) {
+      if (store.memref != memref || !store.isWrite)
+        continue;
+
+      for (auto &access : accesses) {
+        if (access.memref != memref)
+          continue;
+
+        auto dep = plier::checkLoopDependence({loop, store.indices},
+                                              {loop, access.indices});
+        if (dep.kind == plier::DependenceKind::Unknown)
+          return {};
+
+        for (auto dim : dep.dims) {
+          if (strides[dim] == 0)
+            return {};
+
+          auto check = std::make_pair(memref, dim);
+          if (strides[dim] == mlir::ShapedType::kDynamicStrideOrOffset &&
+              !llvm::is_contained(ret.strides, check))
+            ret.strides.emplace_back(check);
+        }
+      }
+    }
+
+    for (auto other : memrefs) {
+      if (other == memref || isDistinctAlloc(memref, other))
+        continue;
+
+      // Pair was already added when processing other written memref.
+      auto pair = std::make_pair(other, memref);
+      if (llvm::is_contained(ret.pairs, pair))
+        continue;
+
+      ret.pairs.emplace_back(memref, other);
+    }
+  }
+
+  if (ret.pairs.size() > MaxAliasChecks)
+    return {};
+
+  return ret;
+}
+
+/// Returns [begin, end) range of addresses, covered by memref.
+std::pair<mlir::Value, mlir::Value>
+getMemrefRange(mlir::OpBuilder &builder, mlir::Location loc,
+               mlir::Value memref) {
+  auto type = memref.getType().cast<mlir::MemRefType>();
+  auto zero = builder.create<mlir::ConstantIndexOp>(loc, 0);
+  auto one = builder.create<mlir::ConstantIndexOp>(loc, 1);
+  mlir::Value lo = builder.create<plier::ExtractMemrefMetadataOp>(loc, memref);
+  mlir::Value hi = lo;
+  for (auto i : llvm::seq(0u, static_cast<unsigned>(type.getRank()))) {
+    auto size = builder.create<mlir::memref::DimOp>(loc, memref, i);
+    auto stride =
+        builder.create<plier::ExtractMemrefMetadataOp>(loc, memref, i);
+    auto sizeM1 = builder.create<mlir::SubIOp>(loc, size, one);
+    auto ext = builder.create<mlir::MulIOp>(loc, sizeM1, stride);
+    auto isNeg =
+        builder.create<mlir::CmpIOp>(loc, mlir::CmpIPredicate::slt, ext, zero);
+    auto neg = builder.create<mlir::SelectOp>(loc, isNeg, ext, zero);
+    auto pos = builder.create<mlir::SelectOp>(loc, isNeg, zero, ext);
+    lo = builder.create<mlir::AddIOp>(loc, lo, neg);
+    hi = builder.create<mlir::AddIOp>(loc, hi, pos);
+  }
+  hi = builder.create<mlir::AddIOp>(loc, hi, one);
+
+  auto elemSize = builder.create<mlir::ConstantIndexOp>(
+      loc, (type.getElementTypeBitWidth() + 7) / 8);
+  mlir::Value ptr = builder.create<plier::ExtractMemrefPointerOp>(loc, memref);
+  auto getAddr = [&](mlir::Value offset) -> mlir::Value {
+    auto bytes = builder.create<mlir::MulIOp>(loc, offset, elemSize);
+    return builder.create<mlir::AddIOp>(loc, ptr, bytes);
+  };
+  return {getAddr(lo), getAddr(hi)};
+}
+
+mlir::Value genAliasChecks(mlir::OpBuilder &builder, mlir::Location loc,
+                           const AliasChecks &checks) {
+  mlir::Value cond;
+  auto addCond = [&](mlir::Value val) {
+    if (cond) {
+      cond = builder.create<mlir::AndOp>(loc, cond, val);
+    } else {
+      cond = val;
+    }
+  };
+
+  llvm::SmallDenseMap<mlir::Value, std::pair<mlir::Value, mlir::Value>>
+      ranges;
+  auto getRange = [&](mlir::Value memref) {
+    auto it = ranges.find(memref);
+    if (it != ranges.end())
+      return it->second;
+
+    auto range = getMemrefRange(builder, loc, memref);
+    ranges.insert({memref, range});
+    return range;
+  };
+
+  for (auto &pair : checks.pairs) {
+    auto range1 = getRange(pair.first);
+    auto range2 = getRange(pair.second);
+    auto before = builder.create<mlir::CmpIOp>(loc, mlir::CmpIPredicate::ule,
+                                               range1.second, range2.first);
+    auto after = builder.create<mlir::CmpIOp>(loc, mlir::CmpIPredicate::ule,
+                                              range2.second, range1.first);
+    addCond(builder.create<mlir::OrOp>(loc, before, after));
+  }
+
+  auto zero = builder.create<mlir::ConstantIndexOp>(loc, 0);
+  for (auto &it : checks.strides) {
+    auto stride = builder.create<plier::ExtractMemrefMetadataOp>(
+        loc, it.first, it.second);
+    addCond(builder.create<mlir::CmpIOp>(loc, mlir::CmpIPredicate::ne, stride,
+                                         zero));
+  }
+
+  assert(cond);
+  return cond;
+}
+
 } // namespace
 
 mlir::LogicalResult plier::PromoteToParallel::matchAndRewrite(
     mlir::scf::ForOp op, mlir::PatternRewriter &rewriter) const {
   auto hasParallelAttr = op->hasAttr(plier::attributes::getParallelName());
-  if (!canParallelizeLoop(op, hasParallelAttr))
-    return mlir::failure();
+  AliasChecks aliasChecks;
+  if (!canParallelizeLoop(op, hasParallelAttr)) {
+    // Loop has memory writes, try to parallelize it if memrefs don't alias
+    // at runtime. Original loop is kept as fallback.
+    if (op->hasAttr(plier::attributes::getVersionedName()) ||
+        op->getParentOfType<mlir::scf::ParallelOp>())
+      return mlir::failure();
+
+    auto checks = getAliasChecks(op);
+    if (!checks)
+      return mlir::failure();
+
+    aliasChecks = std::move(*checks);
+  }
 
   auto &oldBody = op.getLoopBody().front();
   auto oldYield = mlir::cast<mlir::scf::YieldOp>(oldBody.getTerminator());
   auto reduceArgs = oldBody.getArguments().drop_front();
   llvm::SmallVector<llvm::SmallVector<mlir::Operation *, 1>> reduce_bodies(
       reduceArgs.size());
+  llvm::SmallVector<mlir::Value> reduceOperands(reduceArgs.size());
   llvm::DenseSet<mlir::Operation *> reduceOps;
   for (auto it : llvm::enumerate(reduceArgs)) {
-    auto reduceArg = it.value();
     auto reduceIndex = it.index();
-
-    auto reduceOp = getSingleUser(reduceArg);
-    if (!reduceOp)
-      return mlir::failure();
-
-    if (reduceOp->getNumOperands() != 2 || reduceOp->getNumResults() != 1)
+    auto &reduceBody = reduce_bodies[reduceIndex];
+    auto reduceOperand = getReduceOps(it.value(), oldYield, reduceBody);
+    if (!reduceOperand)
       return mlir::failure();
 
-    auto &reduceBody = reduce_bodies[reduceIndex];
-    while (true) {
-      auto nextOp = getSingleUser(reduceOp->getResult(0));
-      if (!nextOp)
+    for (auto reduceOp : reduceBody)
+      if (!reduceOps.insert(reduceOp).second)
         return mlir::failure();
 
-      reduceBody.push_back(reduceOp);
-      reduceOps.insert(reduceOp);
-      if (nextOp == oldYield) {
-        auto yieldOperand =
-            oldYield.getOperand(static_cast<unsigned>(reduceIndex));
-        if (yieldOperand != reduceOp->getResult(0))
-          return mlir::failure();
-
-        break;
-      }
-      for (auto operand : nextOp->getOperands()) {
-        if (operand.getDefiningOp() != reduceOp &&
-            operand.getParentBlock() == &oldBody)
-          return mlir::failure();
-      }
-      reduceOp = nextOp;
-    }
+    reduceOperands[reduceIndex] = reduceOperand;
   }
 
   auto bodyBuilder = [&](mlir::OpBuilder &builder, mlir::Location loc,
@@ -116,13 +452,13 @@ mlir::LogicalResult plier::PromoteToParallel::matchAndRewrite(
     for (auto it : llvm::enumerate(reduce_bodies)) {
       auto &reduceBody = it.value();
       assert(!reduceBody.empty());
+      auto reduceArg = reduceArgs[it.index()];
+      auto reduceOperand = reduceOperands[it.index()];
       reduceNapping = mapping;
-      auto firstOp = reduceBody.front();
-      assert(firstOp->getNumOperands() == 2);
       auto reduceBodyBuilder = [&](mlir::OpBuilder &builder, mlir::Location loc,
                                    mlir::Value val0, mlir::Value val1) {
-        reduceNapping.map(firstOp->getOperand(0), val0);
-        reduceNapping.map(firstOp->getOperand(1), val1);
+        reduceNapping.map(reduceOperand, val0);
+        reduceNapping.map(reduceArg, val1);
         mlir::Operation *last_op = nullptr;
         for (auto reduceOp : reduceBody) {
           last_op = builder.clone(*reduceOp, reduceNapping);
@@ -130,27 +466,41 @@ mlir::LogicalResult plier::PromoteToParallel::matchAndRewrite(
         }
         builder.create<mlir::scf::ReduceReturnOp>(loc, last_op->getResult(0));
       };
-      auto reduceArg = reduceArgs[it.index()];
-      auto firstOpOperands = firstOp->getOperands();
-      auto reduceOperand =
-          (firstOpOperands[0] == reduceArg ? firstOpOperands[1]
-                                           : firstOpOperands[0]);
-      assert(reduceOperand != reduceArg);
-      reduceOperand = mapping.lookupOrDefault(reduceOperand);
-      assert(reduceOperand);
-      builder.create<mlir::scf::ReduceOp>(loc, reduceOperand,
+      auto mappedOperand = mapping.lookupOrDefault(reduceOperand);
+      assert(mappedOperand);
+      builder.create<mlir::scf::ReduceOp>(loc, mappedOperand,
                                           reduceBodyBuilder);
     }
   };
 
-  auto parallelOp = rewriter.replaceOpWithNewOp<mlir::scf::ParallelOp>(
-      op, op.lowerBound(), op.upperBound(), op.step(), op.initArgs(),
-      bodyBuilder);
-  if (hasParallelAttr) {
-    parallelOp->setAttr(plier::attributes::getParallelName(),
-                        rewriter.getUnitAttr());
+  if (aliasChecks.empty()) {
+    auto parallelOp = rewriter.replaceOpWithNewOp<mlir::scf::ParallelOp>(
+        op, op.lowerBound(), op.upperBound(), op.step(), op.initArgs(),
+        bodyBuilder);
+    if (hasParallelAttr) {
+      parallelOp->setAttr(plier::attributes::getParallelName(),
+                          rewriter.getUnitAttr());
+    }
+
+    return mlir::success();
   }
 
+  auto loc = op.getLoc();
+  auto cond = genAliasChecks(rewriter, loc, aliasChecks);
+  auto thenBuilder = [&](mlir::OpBuilder &builder, mlir::Location loc) {
+    auto parallelOp = builder.create<mlir::scf::ParallelOp>(
+        loc, op.lowerBound(), op.upperBound(), op.step(), op.initArgs(),
+        bodyBuilder);
+    builder.create<mlir::scf::YieldOp>(loc, parallelOp.getResults());
+  };
+  auto elseBuilder = [&](mlir::OpBuilder &builder, mlir::Location loc) {
+    auto forOp = builder.clone(*op);
+    forOp->setAttr(plier::attributes::getVersionedName(),
+                   builder.getUnitAttr());
+    builder.create<mlir::scf::YieldOp>(loc, forOp->getResults());
+  };
+  rewriter.replaceOpWithNewOp<mlir::scf::IfOp>(op, op.getResultTypes(), cond,
+                                               thenBuilder, elseBuilder);
   return mlir::success();
 }
 
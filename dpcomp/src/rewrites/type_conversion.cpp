@@ -144,6 +144,11 @@ mlir::LogicalResult plier::FuncOpSignatureConversion::matchAndRewrite(
   }
 
   bool ret_type_changed = (newResults != oldFuncType.getResults());
+  auto numOldArgs = oldFuncType.getNumInputs();
+  llvm::SmallVector<mlir::DictionaryAttr> oldArgAttrs(numOldArgs);
+  for (auto i : llvm::seq(0u, numOldArgs))
+    oldArgAttrs[i] = funcOp.getArgAttrDict(i);
+
   // Update the function signature in-place.
   rewriter.startRootUpdate(funcOp);
   funcOp.setType(newFuncType);
@@ -154,6 +159,21 @@ mlir::LogicalResult plier::FuncOpSignatureConversion::matchAndRewrite(
     return mlir::failure();
   }
 
+  // Arguments can be dropped or expanded, keep attributes only for arguments
+  // mapped to exactly one new argument.
+  if (llvm::any_of(oldArgAttrs, [](mlir::DictionaryAttr attr) {
+        return attr && !attr.empty();
+      })) {
+    llvm::SmallVector<mlir::DictionaryAttr> newArgAttrs(
+        newFuncType.getNumInputs());
+    for (auto it : llvm::enumerate(oldArgAttrs)) {
+      auto mapping = result.getInputMapping(static_cast<unsigned>(it.index()));
+      if (mapping && mapping->size == 1)
+        newArgAttrs[mapping->inputNo] = it.value();
+    }
+    funcOp.setAllArgAttrs(newArgAttrs);
+  }
+
   if (ret_type_changed) {
     auto ret_types = funcOp.getType().getResults();
     funcOp.walk([&](mlir::ReturnOp ret) {
@@ -0,0 +1,261 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "plier/transforms/copy_elision.hpp"
+
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/Sequence.h>
+#include <llvm/ADT/SmallVector.h>
+
+#include <mlir/Dialect/Linalg/IR/LinalgOps.h>
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/Dialect/StandardOps/IR/Ops.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/BuiltinTypes.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+
+#include "plier/analysis/alias_analysis.hpp"
+#include "plier/dialect.hpp"
+
+namespace {
+/// Returns input dim for each result dim or -1 for inserted unit dims, if op
+/// only copies its input.
+llvm::Optional<llvm::SmallVector<int64_t>>
+getCopyMapping(mlir::linalg::GenericOp op) {
+  if (op.getNumInputs() != 1 || op.getNumOutputs() != 1 ||
+      !op.hasBufferSemantics() || op.getNumParallelLoops() != op.getNumLoops())
+    return llvm::None;
+
+  auto &body = op.region().front();
+  auto yield = mlir::cast<mlir::linalg::YieldOp>(body.getTerminator());
+  if (&body.front() != yield.getOperation() || yield.getNumOperands() != 1 ||
+      yield.getOperand(0) != body.getArgument(0))
+    return llvm::None;
+
+  auto maps = op.getIndexingMaps();
+  auto outMap = maps[1];
+  if (!outMap.isPermutation())
+    return llvm::None;
+
+  auto map = maps[0].compose(mlir::inversePermutation(outMap));
+  auto outType = op->getOperand(1).getType().cast<mlir::MemRefType>();
+  llvm::SmallVector<int64_t> ret(static_cast<size_t>(outType.getRank()), -1);
+  for (auto it : llvm::enumerate(map.getResults())) {
+    auto dim = it.value().dyn_cast<mlir::AffineDimExpr>();
+    if (!dim || ret[dim.getPosition()] != -1)
+      return llvm::None;
+
+    ret[dim.getPosition()] = static_cast<int64_t>(it.index());
+  }
+
+  for (auto it : llvm::enumerate(ret))
+    if (it.value() == -1 &&
+        outType.getDimSize(static_cast<unsigned>(it.index())) != 1)
+      return llvm::None;
+
+  return ret;
+}
+
+bool isReadonlyCallArg(mlir::CallOp call, unsigned index) {
+  auto func = mlir::SymbolTable::lookupNearestSymbolFrom<mlir::FuncOp>(
+      call, call.getCalleeAttr());
+  return func &&
+         func.getArgAttr(index, plier::attributes::getReadonlyName());
+}
+
+/// Checks that `user` only reads `memref` and doesn't capture it.
+bool isReadonlyUser(mlir::Operation *user, mlir::Value memref,
+                    mlir::MemRefType viewType) {
+  if (mlir::isa<mlir::memref::LoadOp, mlir::memref::DimOp>(user))
+    return true;
+
+  if (auto linalgOp = mlir::dyn_cast<mlir::linalg::LinalgOp>(user)) {
+    auto numInputs = linalgOp.getNumInputs();
+    for (auto it : llvm::enumerate(user->getOperands()))
+      if (it.value() == memref && it.index() >= numInputs)
+        return false;
+
+    return true;
+  }
+
+  if (auto cast = mlir::dyn_cast<mlir::memref::CastOp>(user)) {
+    auto dstType = cast.getType().dyn_cast<mlir::MemRefType>();
+    if (!dstType || !mlir::memref::CastOp::areCastCompatible(viewType, dstType))
+      return false;
+
+    return llvm::all_of(cast->getUsers(), [&](mlir::Operation *castUser) {
+      return isReadonlyUser(castUser, cast.getResult(), dstType);
+    });
+  }
+
+  // Callee signature must be already compatible with the view.
+  if (auto call = mlir::dyn_cast<mlir::CallOp>(user)) {
+    for (auto it : llvm::enumerate(call.getOperands()))
+      if (it.value() == memref &&
+          (it.value().getType() != viewType ||
+           !isReadonlyCallArg(call, static_cast<unsigned>(it.index()))))
+        return false;
+
+    return true;
+  }
+
+  return false;
+}
+
+/// Checks if `op` or any op nested in it can write into `memref`.
+bool mayWrite(mlir::Operation *op, mlir::Value memref) {
+  auto mayAlias = [&](mlir::Value val) {
+    return val.getType().isa<mlir::MemRefType>() &&
+           !plier::aliasMemrefs(val, memref).isNo();
+  };
+  auto walkResult = op->walk([&](mlir::Operation *nested) {
+    if (auto store = mlir::dyn_cast<mlir::memref::StoreOp>(nested))
+      return mayAlias(store.memref()) ? mlir::WalkResult::interrupt()
+                                      : mlir::WalkResult::advance();
+
+    if (auto linalgOp = mlir::dyn_cast<mlir::linalg::LinalgOp>(nested)) {
+      auto numInputs = linalgOp.getNumInputs();
+      for (auto it : llvm::enumerate(nested->getOperands()))
+        if (it.index() >= numInputs && mayAlias(it.value()))
+          return mlir::WalkResult::interrupt();
+
+      return mlir::WalkResult::advance();
+    }
+
+    if (auto call = mlir::dyn_cast<mlir::CallOp>(nested)) {
+      for (auto it : llvm::enumerate(call.getOperands()))
+        if (mayAlias(it.value()) &&
+            !isReadonlyCallArg(call, static_cast<unsigned>(it.index())))
+          return mlir::WalkResult::interrupt();
+
+      return mlir::WalkResult::advance();
+    }
+
+    if (nested->getNumRegions() != 0 &&
+        nested->hasTrait<mlir::OpTrait::HasRecursiveSideEffects>())
+      return mlir::WalkResult::advance();
+
+    if (auto effects = mlir::dyn_cast<mlir::MemoryEffectOpInterface>(nested)) {
+      if (effects.hasEffect<mlir::MemoryEffects::Write>())
+        return mlir::WalkResult::interrupt();
+
+      return mlir::WalkResult::advance();
+    }
+
+    return mlir::MemoryEffectOpInterface::hasNoEffect(nested)
+               ? mlir::WalkResult::advance()
+               : mlir::WalkResult::interrupt();
+  });
+  return walkResult.wasInterrupted();
+}
+
+/// Returns view type, sizes and strides are taken from the source, unit dims
+/// have zero stride.
+mlir::MemRefType getViewType(mlir::MemRefType srcType,
+                             llvm::ArrayRef<int64_t> mapping) {
+  auto rank = mapping.size();
+  auto dynamic = mlir::ShapedType::kDynamicStrideOrOffset;
+  llvm::SmallVector<int64_t> shape(rank);
+  llvm::SmallVector<int64_t> strides(rank);
+  for (auto it : llvm::enumerate(mapping)) {
+    auto srcDim = it.value();
+    shape[it.index()] =
+        (srcDim < 0 ? 1 : srcType.getDimSize(static_cast<unsigned>(srcDim)));
+    strides[it.index()] = (srcDim < 0 ? 0 : dynamic);
+  }
+
+  auto layout =
+      mlir::makeStridedLinearLayoutMap(strides, dynamic, srcType.getContext());
+  return mlir::MemRefType::get(shape, srcType.getElementType(), layout,
+                               srcType.getMemorySpace());
+}
+
+bool tryReplaceCopy(mlir::linalg::GenericOp op) {
+  auto mapping = getCopyMapping(op);
+  if (!mapping)
+    return false;
+
+  auto input = op->getOperand(0);
+  auto output = op->getOperand(1);
+  auto alloc = output.getDefiningOp<mlir::memref::AllocOp>();
+  auto srcType = input.getType().dyn_cast<mlir::MemRefType>();
+  if (!alloc || alloc->getBlock() != op->getBlock() || !srcType)
+    return false;
+
+  // All other users must be after the copy and must only read the result.
+  auto block = op->getBlock();
+  auto viewType = getViewType(srcType, *mapping);
+  for (auto user : output.getUsers()) {
+    if (user == op)
+      continue;
+
+    auto ancestor = block->findAncestorOpInBlock(*user);
+    if (!ancestor || !op->isBeforeInBlock(ancestor) ||
+        !isReadonlyUser(user, output, viewType))
+      return false;
+  }
+
+  // Source must not be modified while view is alive.
+  for (auto it = std::next(mlir::Block::iterator(op)); it != block->end();
+       ++it)
+    if (mayWrite(&*it, input))
+      return false;
+
+  mlir::OpBuilder builder(op);
+  auto loc = op.getLoc();
+  auto rank = static_cast<unsigned>(viewType.getRank());
+  llvm::SmallVector<mlir::OpFoldResult> sizes(rank);
+  llvm::SmallVector<mlir::OpFoldResult> strides(rank);
+  for (auto i : llvm::seq(0u, rank)) {
+    auto srcDim = (*mapping)[i];
+    auto size = viewType.getDimSize(i);
+    if (!mlir::ShapedType::isDynamic(size)) {
+      sizes[i] = builder.getIndexAttr(size);
+    } else {
+      sizes[i] = builder.create<mlir::memref::DimOp>(loc, input, srcDim)
+                     .getResult();
+    }
+
+    if (srcDim < 0) {
+      strides[i] = builder.getIndexAttr(0);
+    } else {
+      strides[i] =
+          builder.create<plier::ExtractMemrefMetadataOp>(loc, input, srcDim)
+              .getResult();
+    }
+  }
+  mlir::OpFoldResult offset =
+      builder.create<plier::ExtractMemrefMetadataOp>(loc, input).getResult();
+
+  auto view = builder.create<mlir::memref::ReinterpretCastOp>(
+      loc, viewType, input, offset, sizes, strides);
+  op->erase();
+  output.replaceAllUsesWith(view.getResult());
+  alloc->erase();
+  return true;
+}
+} // namespace
+
+mlir::LogicalResult plier::replaceCopiesWithViews(mlir::FuncOp func) {
+  llvm::SmallVector<mlir::linalg::GenericOp> ops;
+  func.walk([&](mlir::linalg::GenericOp op) { ops.emplace_back(op); });
+
+  bool changed = false;
+  for (auto op : ops)
+    if (tryReplaceCopy(op))
+      changed = true;
+
+  return mlir::success(changed);
+}
@@ -22,8 +22,12 @@
 #include <mlir/IR/BlockAndValueMapping.h>
 #include <mlir/IR/Dominance.h>
 #include <mlir/IR/PatternMatch.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+#include <mlir/Interfaces/ViewLikeInterface.h>
 #include <mlir/Support/LogicalResult.h>
 
+#include "plier/analysis/alias_analysis.hpp"
+#include "plier/analysis/dependence.hpp"
 #include "plier/dialect.hpp"
 
 #include "plier/transforms/cast_utils.hpp"
@@ -238,15 +242,53 @@ mlir::LogicalResult plier::lowerWhileToFor(
   return mlir::success(changed);
 }
 
-// TODO: Copypasted from mlir
+// Based on parallel loop fusion from mlir
 namespace {
 using namespace mlir;
 
-/// Verify there are no nested ParallelOps.
-static bool hasNestedParallelOp(scf::ParallelOp ploop) {
-  auto walkResult = ploop.getBody()->walk(
-      [](scf::ParallelOp) { return WalkResult::interrupt(); });
-  return walkResult.wasInterrupted();
+/// Max depth of def chains compared by isEquivalentValue.
+constexpr unsigned MaxEquivalenceDepth = 8;
+
+static bool isPure(Operation *op) {
+  return op->getNumRegions() == 0 && MemoryEffectOpInterface::hasNoEffect(op);
+}
+
+/// Checks if `lhs` from the first loop and `rhs` from the second loop are
+/// guaranteed to have the same value. `mapping` maps first loop induction
+/// variables to second loop ones.
+static bool isEquivalentValue(Value lhs, Value rhs,
+                              const BlockAndValueMapping &mapping,
+                              unsigned depth = 0) {
+  lhs = mapping.lookupOrDefault(lhs);
+  if (lhs == rhs)
+    return true;
+
+  if (lhs.getType() != rhs.getType())
+    return false;
+
+  auto lhsConst = plier::getConstVal<IntegerAttr>(lhs);
+  auto rhsConst = plier::getConstVal<IntegerAttr>(rhs);
+  if (lhsConst || rhsConst)
+    return lhsConst == rhsConst;
+
+  if (depth >= MaxEquivalenceDepth)
+    return false;
+
+  auto lhsOp = lhs.getDefiningOp();
+  auto rhsOp = rhs.getDefiningOp();
+  if (!lhsOp || !rhsOp || !isPure(lhsOp) || !isPure(rhsOp))
+    return false;
+
+  if (lhs.cast<OpResult>().getResultNumber() !=
+      rhs.cast<OpResult>().getResultNumber())
+    return false;
+
+  auto checkOperands = [&](Value lhsArg, Value rhsArg) {
+    return success(isEquivalentValue(lhsArg, rhsArg, mapping, depth + 1));
+  };
+  return OperationEquivalence::isEquivalentTo(
+      lhsOp, rhsOp, checkOperands, OperationEquivalence::ignoreValueEquivalence,
+      OperationEquivalence::IgnoreLocations);
 }
 
 /// Verify equal iteration spaces.
@@ -255,57 +297,147 @@ static bool equalIterationSpaces(scf::ParallelOp firstPloop,
   if (firstPloop.getNumLoops() != secondPloop.getNumLoops())
     return false;
 
+  BlockAndValueMapping mapping;
   auto matchOperands = [&](const OperandRange &lhs,
                            const OperandRange &rhs) -> bool {
-    // TODO: Extend this to support aliases and equal constants.
-    return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    for (auto it : llvm::zip(lhs, rhs))
+      if (!isEquivalentValue(std::get<0>(it), std::get<1>(it), mapping))
+        return false;
+
+    return true;
   };
   return matchOperands(firstPloop.lowerBound(), secondPloop.lowerBound()) &&
          matchOperands(firstPloop.upperBound(), secondPloop.upperBound()) &&
          matchOperands(firstPloop.step(), secondPloop.step());
 }
 
+/// Returns buffer the `view` was derived from.
+static Value getViewSource(Value view) {
+  while (auto viewOp = view.getDefiningOp<ViewLikeOpInterface>())
+    view = viewOp.getViewSource();
+
+  return view;
+}
+
+struct MemAccess {
+  Value memref;
+  ValueRange indices;
+};
+
 /// Checks if the parallel loops have mixed access to the same buffers. Returns
-/// `true` if the first parallel loop writes to the same indices that the second
-/// loop reads.
-static bool haveNoReadsAfterWriteExceptSameIndex(
+/// `true` if every access of the second loop to the buffers written by the
+/// first loop uses the same view as the write and either the same indices or
+/// indices which can only touch the written element on the same iteration.
+static bool haveNoAccessesAfterWriteExceptSameIndex(
     scf::ParallelOp firstPloop, scf::ParallelOp secondPloop,
     const BlockAndValueMapping &firstToSecondPloopIndices) {
-  DenseMap<Value, SmallVector<ValueRange, 1>> bufferStores;
+  DenseMap<Value, SmallVector<MemAccess, 1>> bufferStores;
   firstPloop.getBody()->walk([&](memref::StoreOp store) {
-    bufferStores[store.getMemRef()].push_back(store.indices());
+    auto memref = store.getMemRef();
+    bufferStores[getViewSource(memref)].push_back({memref, store.indices()});
   });
-  auto walkResult = secondPloop.getBody()->walk([&](memref::LoadOp load) {
-    // Stop if the memref is defined in secondPloop body. Careful alias analysis
-    // is needed.
-    auto *memrefDef = load.getMemRef().getDefiningOp();
-    if (memrefDef && memrefDef->getBlock() == load->getBlock())
-      return WalkResult::interrupt();
 
-    auto write = bufferStores.find(load.getMemRef());
+  auto isSameIndices = [&](ValueRange indices1, ValueRange indices2) {
+    if (indices1.size() != indices2.size())
+      return false;
+
+    for (auto it : llvm::zip(indices1, indices2))
+      if (!isEquivalentValue(std::get<0>(it), std::get<1>(it),
+                             firstToSecondPloopIndices))
+        return false;
+
+    return true;
+  };
+
+  auto checkAccess = [&](Value memref, ValueRange indices) {
+    auto source = getViewSource(memref);
+
+    // Buffers, allocated inside secondPloop cannot alias anything written in
+    // firstPloop, any other memref produced there needs careful alias
+    // analysis.
+    auto parentOp = source.getParentRegion()->getParentOp();
+    if (secondPloop->isAncestor(parentOp)) {
+      auto def = source.getDefiningOp();
+      if (!def || !isa<memref::AllocOp, memref::AllocaOp>(def))
+        return WalkResult::interrupt();
+
+      return WalkResult::advance();
+    }
+
+    auto write = bufferStores.find(source);
     if (write == bufferStores.end())
       return WalkResult::advance();
 
-    // Allow only single write access per buffer.
-    if (write->second.size() != 1)
-      return WalkResult::interrupt();
+    // Check that secondPloop accesses the same view as firstPloop stores and
+    // cannot touch elements written on other iterations.
+    for (auto &store : write->second) {
+      if (!isEquivalentValue(store.memref, memref, firstToSecondPloopIndices)) {
+        // Disjoint views of the same buffer are fine.
+        if (plier::aliasMemrefs(store.memref, memref).isNo())
+          continue;
 
-    // Check that the load indices of secondPloop coincide with store indices of
-    // firstPloop for the same memrefs.
-    auto storeIndices = write->second.front();
-    auto loadIndices = load.indices();
-    if (storeIndices.size() != loadIndices.size())
-      return WalkResult::interrupt();
-    for (size_t i = 0, e = storeIndices.size(); i < e; ++i) {
-      if (firstToSecondPloopIndices.lookupOrDefault(storeIndices[i]) !=
-          loadIndices[i])
         return WalkResult::interrupt();
+      }
+
+      if (isSameIndices(store.indices, indices))
+        continue;
+
+      auto dep = plier::checkLoopDependence({firstPloop, store.indices},
+                                            {secondPloop, indices});
+      if (dep.kind == plier::DependenceKind::Unknown)
+        return WalkResult::interrupt();
+
+      // Writable views are assumed to have non-zero strides, same as for the
+      // same indices case above, only reject statically known zero strides.
+      auto type = memref.getType().cast<MemRefType>();
+      int64_t offset;
+      SmallVector<int64_t> strides;
+      if (failed(getStridesAndOffset(type, strides, offset)))
+        return WalkResult::interrupt();
+
+      for (auto dim : dep.dims)
+        if (strides[dim] == 0)
+          return WalkResult::interrupt();
     }
+
+    return WalkResult::advance();
+  };
+
+  auto walkResult = secondPloop.getBody()->walk([&](Operation *op) {
+    if (auto load = dyn_cast<memref::LoadOp>(op))
+      return checkAccess(load.getMemRef(), load.indices());
+
+    if (auto store = dyn_cast<memref::StoreOp>(op))
+      return checkAccess(store.getMemRef(), store.indices());
+
     return WalkResult::advance();
   });
   return !walkResult.wasInterrupted();
 }
 
+/// Checks if loop body accesses memory by anything except plain loads and
+/// stores, which are not supported by the dependency analysis. Ops with
+/// unknown effects (calls, plier ops) are assumed to access everything.
+static bool hasUnsupportedMemoryAccess(scf::ParallelOp ploop) {
+  auto walkResult = ploop.getBody()->walk([](Operation *op) {
+    if (isa<memref::LoadOp, memref::StoreOp>(op))
+      return WalkResult::advance();
+
+    // Nested ops are visited by the walk itself.
+    if (isa<scf::ReduceOp>(op) ||
+        op->hasTrait<OpTrait::HasRecursiveSideEffects>())
+      return WalkResult::advance();
+
+    auto effects = dyn_cast<MemoryEffectOpInterface>(op);
+    if (!effects || effects.hasEffect<MemoryEffects::Read>() ||
+        effects.hasEffect<MemoryEffects::Write>())
+      return WalkResult::interrupt();
+
+    return WalkResult::advance();
+  });
+  return walkResult.wasInterrupted();
+}
+
 /// Analyzes dependencies in the most primitive way by checking simple read and
 /// write patterns.
 static LogicalResult
@@ -318,23 +450,23 @@ verifyDependencies(scf::ParallelOp firstPloop, scf::ParallelOp secondPloop,
     }
   }
 
-  if (!haveNoReadsAfterWriteExceptSameIndex(firstPloop, secondPloop,
-                                            firstToSecondPloopIndices))
+  if (!haveNoAccessesAfterWriteExceptSameIndex(firstPloop, secondPloop,
+                                               firstToSecondPloopIndices))
     return failure();
 
   BlockAndValueMapping secondToFirstPloopIndices;
   secondToFirstPloopIndices.map(secondPloop.getBody()->getArguments(),
                                 firstPloop.getBody()->getArguments());
-  return success(haveNoReadsAfterWriteExceptSameIndex(
+  return success(haveNoAccessesAfterWriteExceptSameIndex(
       secondPloop, firstPloop, secondToFirstPloopIndices));
 }
 
 static bool
 isFusionLegal(scf::ParallelOp firstPloop, scf::ParallelOp secondPloop,
               const BlockAndValueMapping &firstToSecondPloopIndices) {
-  return !hasNestedParallelOp(firstPloop) &&
-         !hasNestedParallelOp(secondPloop) &&
-         equalIterationSpaces(firstPloop, secondPloop) &&
+  return equalIterationSpaces(firstPloop, secondPloop) &&
+         !hasUnsupportedMemoryAccess(firstPloop) &&
+         !hasUnsupportedMemoryAccess(secondPloop) &&
          succeeded(verifyDependencies(firstPloop, secondPloop,
                                       firstToSecondPloopIndices));
 }
@@ -415,7 +547,7 @@ bool hasNoEffect(mlir::scf::ParallelOp currentPloop, mlir::Operation *op) {
 }
 } // namespace
 
-mlir::LogicalResult plier::naivelyFuseParallelOps(Region &region) {
+mlir::LogicalResult plier::fuseParallelOps(Region &region) {
   OpBuilder b(region);
   // Consider every single block and attempt to fuse adjacent loops.
   bool changed = false;
@@ -423,7 +555,7 @@ mlir::LogicalResult plier::naivelyFuseParallelOps(Region &region) {
   for (auto &block : region) {
     for (auto &op : block)
       for (auto &innerReg : op.getRegions())
-        if (succeeded(naivelyFuseParallelOps(innerReg)))
+        if (succeeded(fuseParallelOps(innerReg)))
           changed = true;
 
     ploopChains.clear();
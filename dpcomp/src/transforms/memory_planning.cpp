@@ -0,0 +1,435 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "plier/transforms/memory_planning.hpp"
+
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallVector.h>
+
+#include <mlir/Analysis/BufferViewFlowAnalysis.h>
+#include <mlir/Dialect/Linalg/IR/LinalgOps.h>
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/Dialect/SCF/SCF.h>
+#include <mlir/Dialect/Vector/VectorOps.h>
+#include <mlir/IR/BuiltinOps.h>
+
+#include "plier/dialect.hpp"
+#include "plier/transforms/const_utils.hpp"
+#include "plier/transforms/func_utils.hpp"
+
+namespace {
+struct BufferInfo {
+  mlir::memref::AllocOp alloc;
+  mlir::memref::DeallocOp dealloc;
+  /// First and last ops in alloc block, using buffer or any of its aliases,
+  /// except dealloc.
+  mlir::Operation *firstUse = nullptr;
+  mlir::Operation *lastUse = nullptr;
+};
+
+/// Returns buffer info if buffer is only used inside its block and
+/// deallocated in the same block.
+llvm::Optional<BufferInfo>
+getBufferInfo(mlir::memref::AllocOp alloc,
+              const mlir::BufferViewFlowAnalysis &analysis) {
+  if (!alloc.symbolOperands().empty())
+    return llvm::None;
+
+  auto block = alloc->getBlock();
+  BufferInfo ret;
+  ret.alloc = alloc;
+  auto memref = alloc.getResult();
+  for (auto alias : analysis.resolve(memref)) {
+    for (auto user : alias.getUsers()) {
+      if (auto dealloc = mlir::dyn_cast<mlir::memref::DeallocOp>(user)) {
+        if (alias != memref || ret.dealloc || dealloc->getBlock() != block)
+          return llvm::None;
+
+        ret.dealloc = dealloc;
+        continue;
+      }
+
+      auto op = block->findAncestorOpInBlock(*user);
+      if (!op)
+        return llvm::None;
+
+      if (!ret.firstUse || op->isBeforeInBlock(ret.firstUse))
+        ret.firstUse = op;
+
+      if (!ret.lastUse || ret.lastUse->isBeforeInBlock(op))
+        ret.lastUse = op;
+    }
+  }
+  if (!ret.dealloc)
+    return llvm::None;
+
+  if (!ret.firstUse) {
+    ret.firstUse = alloc;
+    ret.lastUse = alloc;
+  }
+  return ret;
+}
+
+/// Returns buffers in program order inside each block.
+llvm::SmallVector<BufferInfo>
+collectBuffers(mlir::FuncOp func,
+               const mlir::BufferViewFlowAnalysis &analysis) {
+  llvm::SmallVector<BufferInfo> ret;
+  func.walk([&](mlir::memref::AllocOp alloc) {
+    if (auto info = getBufferInfo(alloc, analysis))
+      ret.emplace_back(*info);
+  });
+  return ret;
+}
+
+bool isCompatible(mlir::memref::AllocOp alloc1, mlir::memref::AllocOp alloc2) {
+  return alloc1.getType() == alloc2.getType() &&
+         alloc1.alignment() == alloc2.alignment() &&
+         llvm::equal(alloc1.dynamicSizes(), alloc2.dynamicSizes());
+}
+
+/// Replaces `dst` buffer with `src`, `src` lifetime is extended to `dst`
+/// lifetime.
+void mergeBuffers(BufferInfo &src, BufferInfo &dst) {
+  dst.alloc.getResult().replaceAllUsesWith(src.alloc.getResult());
+  dst.alloc->erase();
+  src.dealloc->erase();
+  src.dealloc = dst.dealloc;
+  src.lastUse = dst.lastUse;
+}
+
+/// Checks if elementwise op can write `output` directly into `input` buffer.
+/// Both buffers must only be accessed through the same permutation map, so
+/// each element is read and written on the same iteration.
+bool canWriteInPlace(mlir::linalg::GenericOp op, mlir::Value input,
+                     mlir::Value output) {
+  if (op.getNumParallelLoops() != op.getNumLoops())
+    return false;
+
+  auto numInputs = op.getNumInputs();
+  auto &body = op.region().front();
+  auto maps = op.getIndexingMaps();
+  llvm::Optional<mlir::AffineMap> map;
+  bool hasInput = false;
+  bool hasOutput = false;
+  for (auto it : llvm::enumerate(op->getOperands())) {
+    auto val = it.value();
+    if (val != input && val != output)
+      continue;
+
+    auto index = static_cast<unsigned>(it.index());
+    bool isInput = index < numInputs;
+    if ((val == input) != isInput)
+      return false;
+
+    // Output initial value would be overwritten by input.
+    if (!isInput && !body.getArgument(index).use_empty())
+      return false;
+
+    if (map && *map != maps[index])
+      return false;
+
+    map = maps[index];
+    hasInput = hasInput || isInput;
+    hasOutput = hasOutput || !isInput;
+  }
+  return hasInput && hasOutput && map->isPermutation();
+}
+
+/// Checks if any operand of `op`, except `src` and `dst` themselves, may be a
+/// view of one of them (e.g. `t + t.T`), in-place update would overwrite
+/// elements still read by later iterations.
+bool hasAliasingOperands(mlir::linalg::GenericOp op, mlir::Value src,
+                         mlir::Value dst,
+                         const mlir::BufferViewFlowAnalysis &analysis) {
+  for (auto val : {src, dst}) {
+    auto aliases = analysis.resolve(val);
+    for (auto operand : op->getOperands())
+      if (operand != src && operand != dst && aliases.count(operand))
+        return true;
+  }
+  return false;
+}
+
+/// Tries to write results of elementwise ops to the dying inputs. Merged
+/// buffers aliases are not known to `analysis` anymore, so they are skipped
+/// until the next call.
+bool reuseInputs(llvm::SmallVectorImpl<BufferInfo> &buffers,
+                 const mlir::BufferViewFlowAnalysis &analysis) {
+  bool changed = false;
+  llvm::SmallPtrSet<mlir::Operation *, 8> merged;
+  for (auto &dst : buffers) {
+    if (!dst.alloc || merged.count(dst.alloc))
+      continue;
+
+    auto op = mlir::dyn_cast<mlir::linalg::GenericOp>(dst.firstUse);
+    if (!op || !op.hasBufferSemantics())
+      continue;
+
+    for (auto &src : buffers) {
+      if (&src == &dst || !src.alloc || merged.count(src.alloc) ||
+          src.lastUse != op || !isCompatible(src.alloc, dst.alloc))
+        continue;
+
+      if (!canWriteInPlace(op, src.alloc, dst.alloc) ||
+          hasAliasingOperands(op, src.alloc, dst.alloc, analysis))
+        continue;
+
+      // All src and dst uses inside op must be direct, not through aliases.
+      auto countUses = [&](mlir::Value val) {
+        return llvm::count_if(val.getUses(), [&](mlir::OpOperand &use) {
+          return op->isAncestor(use.getOwner());
+        });
+      };
+      auto countOperands = [&](mlir::Value val) {
+        return llvm::count(op->getOperands(), val);
+      };
+      if (countUses(src.alloc) != countOperands(src.alloc) ||
+          countUses(dst.alloc) != countOperands(dst.alloc))
+        continue;
+
+      mergeBuffers(src, dst);
+      merged.insert(src.alloc);
+      dst.alloc = nullptr;
+      changed = true;
+      break;
+    }
+  }
+  return changed;
+}
+
+/// Assigns buffers with non-overlapping lifetimes to shared slots.
+bool reuseSlots(llvm::SmallVectorImpl<BufferInfo> &buffers) {
+  bool changed = false;
+  for (auto &dst : buffers) {
+    if (!dst.alloc)
+      continue;
+
+    BufferInfo *slot = nullptr;
+    for (auto &src : buffers) {
+      if (&src == &dst || !src.alloc ||
+          src.alloc->getBlock() != dst.alloc->getBlock() ||
+          !src.lastUse->isBeforeInBlock(dst.alloc) ||
+          !isCompatible(src.alloc, dst.alloc))
+        continue;
+
+      // Prefer most recently released slot.
+      if (!slot || slot->lastUse->isBeforeInBlock(src.lastUse))
+        slot = &src;
+    }
+    if (!slot)
+      continue;
+
+    mergeBuffers(*slot, dst);
+    dst.alloc = nullptr;
+    changed = true;
+  }
+  return changed;
+}
+} // namespace
+
+mlir::LogicalResult plier::planBufferReuse(mlir::FuncOp func) {
+  bool changed = false;
+  while (true) {
+    // Aliases are changed by each merge, recompute.
+    mlir::BufferViewFlowAnalysis analysis(func);
+    auto buffers = collectBuffers(func, analysis);
+    if (reuseInputs(buffers, analysis)) {
+      changed = true;
+      continue;
+    }
+
+    changed = reuseSlots(buffers) || changed;
+    break;
+  }
+  return mlir::success(changed);
+}
+
+namespace {
+/// Max number of elements replaced with SSA values.
+constexpr int64_t MaxScalarizedElements = 16;
+
+llvm::Optional<int64_t> getStaticBufferSize(mlir::MemRefType type) {
+  if (!type.hasStaticShape() || !type.getAffineMaps().empty())
+    return llvm::None;
+
+  auto elemType = type.getElementType();
+  if (elemType.isIndex())
+    return type.getNumElements() * 8;
+
+  if (!elemType.isIntOrFloat())
+    return llvm::None;
+
+  return type.getNumElements() *
+         static_cast<int64_t>((elemType.getIntOrFloatBitWidth() + 7) / 8);
+}
+
+/// Checks that op doesn't capture the buffer and doesn't pass it outside of
+/// the function. View-like ops results are checked separately as aliases.
+bool isNonCapturingUser(mlir::Operation *op) {
+  if (mlir::isa<plier::RetainOp>(op))
+    return false;
+
+  return mlir::isa<mlir::memref::LoadOp, mlir::memref::StoreOp,
+                   mlir::memref::DimOp, mlir::memref::DeallocOp,
+                   mlir::vector::TransferReadOp, mlir::vector::TransferWriteOp,
+                   mlir::linalg::LinalgOp, mlir::ViewLikeOpInterface>(op);
+}
+
+bool isEscaping(mlir::memref::AllocOp alloc,
+                const mlir::BufferViewFlowAnalysis &analysis) {
+  for (auto alias : analysis.resolve(alloc.getResult()))
+    for (auto user : alias.getUsers())
+      if (!isNonCapturingUser(user))
+        return true;
+
+  return false;
+}
+
+bool isInsideParallelLoop(mlir::Operation *op) {
+  return op->getParentOfType<mlir::scf::ParallelOp>() ||
+         op->getParentOfType<plier::ParallelOp>();
+}
+
+llvm::Optional<int64_t> getConstLinearIndex(mlir::ValueRange indices,
+                                            llvm::ArrayRef<int64_t> shape) {
+  int64_t ret = 0;
+  for (auto it : llvm::zip(indices, shape)) {
+    auto attr = plier::getConstVal<mlir::IntegerAttr>(std::get<0>(it));
+    if (!attr)
+      return llvm::None;
+
+    auto index = plier::getIntAttrValue(attr);
+    auto size = std::get<1>(it);
+    if (index < 0 || index >= size)
+      return llvm::None;
+
+    ret = ret * size + index;
+  }
+  return ret;
+}
+
+/// Replaces buffer, which is only accessed directly by loads and stores with
+/// constant indices in its block, with stored values.
+bool scalarizeBuffer(mlir::memref::AllocOp alloc,
+                     mlir::memref::DeallocOp dealloc) {
+  auto type = alloc.getType();
+  if (type.getNumElements() > MaxScalarizedElements)
+    return false;
+
+  auto block = alloc->getBlock();
+  auto memref = alloc.getResult();
+  llvm::SmallVector<std::pair<mlir::Operation *, int64_t>> accesses;
+  for (auto user : memref.getUsers()) {
+    if (user == dealloc)
+      continue;
+
+    if (user->getBlock() != block)
+      return false;
+
+    llvm::Optional<int64_t> index;
+    if (auto load = mlir::dyn_cast<mlir::memref::LoadOp>(user)) {
+      index = getConstLinearIndex(load.indices(), type.getShape());
+    } else if (auto store = mlir::dyn_cast<mlir::memref::StoreOp>(user)) {
+      if (store.value() != memref)
+        index = getConstLinearIndex(store.indices(), type.getShape());
+    }
+    if (!index)
+      return false;
+
+    accesses.emplace_back(user, *index);
+  }
+
+  llvm::sort(accesses, [](auto &a, auto &b) {
+    return a.first->isBeforeInBlock(b.first);
+  });
+
+  // All loads must read previously stored values.
+  llvm::SmallVector<mlir::Value> values(type.getNumElements());
+  for (auto &it : accesses) {
+    if (auto store = mlir::dyn_cast<mlir::memref::StoreOp>(it.first)) {
+      values[it.second] = store.value();
+    } else if (!values[it.second]) {
+      return false;
+    }
+  }
+
+  std::fill(values.begin(), values.end(), mlir::Value());
+  for (auto &it : accesses) {
+    auto op = it.first;
+    if (auto store = mlir::dyn_cast<mlir::memref::StoreOp>(op)) {
+      values[it.second] = store.value();
+    } else {
+      op->getResult(0).replaceAllUsesWith(values[it.second]);
+    }
+    op->erase();
+  }
+  dealloc->erase();
+  alloc->erase();
+  return true;
+}
+
+/// Replaces buffer with alloca in function entry block.
+void promoteToStack(mlir::memref::AllocOp alloc,
+                    mlir::memref::DeallocOp dealloc) {
+  mlir::OpBuilder builder(alloc);
+  auto alloca = plier::AllocaInsertionPoint(alloc).insert(builder, [&]() {
+    return builder.create<mlir::memref::AllocaOp>(
+        alloc.getLoc(), alloc.getType(), alloc.alignmentAttr());
+  });
+  alloc.getResult().replaceAllUsesWith(alloca.getResult());
+  alloc->erase();
+  dealloc->erase();
+}
+} // namespace
+
+mlir::LogicalResult plier::promoteSmallBuffers(mlir::FuncOp func) {
+  auto attr = func->getAttrOfType<mlir::IntegerAttr>(
+      plier::attributes::getStackPromotionSizeName());
+  auto maxSize = attr ? attr.getInt() : 0;
+  if (maxSize <= 0)
+    return mlir::failure();
+
+  llvm::SmallVector<mlir::memref::AllocOp> allocs;
+  func.walk([&](mlir::memref::AllocOp alloc) { allocs.emplace_back(alloc); });
+
+  bool changed = false;
+  mlir::BufferViewFlowAnalysis analysis(func);
+  for (auto alloc : allocs) {
+    auto size = getStaticBufferSize(alloc.getType());
+    if (!size || *size > maxSize || isEscaping(alloc, analysis))
+      continue;
+
+    // Promoted buffer must have single live instance at any moment.
+    auto info = getBufferInfo(alloc, analysis);
+    if (!info)
+      continue;
+
+    if (scalarizeBuffer(alloc, info->dealloc)) {
+      changed = true;
+      continue;
+    }
+
+    // Buffers in parallel loops must stay private to each iteration and
+    // allocas inside the loop body would grow the stack on each iteration.
+    if (isInsideParallelLoop(alloc))
+      continue;
+
+    promoteToStack(alloc, info->dealloc);
+    changed = true;
+  }
+  return mlir::success(changed);
+}
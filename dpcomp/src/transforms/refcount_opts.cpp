@@ -0,0 +1,93 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "plier/transforms/refcount_opts.hpp"
+
+#include <llvm/ADT/SmallVector.h>
+
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Interfaces/CallInterfaces.h>
+#include <mlir/Interfaces/ViewLikeInterface.h>
+
+#include "plier/dialect.hpp"
+
+namespace {
+/// Returns buffer, owning the memref data, all views share its refcount.
+mlir::Value getOwner(mlir::Value memref) {
+  while (auto op = memref.getDefiningOp()) {
+    if (auto view = mlir::dyn_cast<mlir::ViewLikeOpInterface>(op)) {
+      memref = view.getViewSource();
+    } else if (auto cast = mlir::dyn_cast<mlir::memref::CastOp>(op)) {
+      memref = cast.source();
+    } else {
+      break;
+    }
+  }
+  return memref;
+}
+
+enum class Release { None, Owner, Unknown };
+
+/// Checks if op can release `owner` buffer.
+Release checkRelease(mlir::Operation *op, mlir::Value owner) {
+  if (auto dealloc = mlir::dyn_cast<mlir::memref::DeallocOp>(op))
+    return getOwner(dealloc.memref()) == owner ? Release::Owner : Release::None;
+
+  if (mlir::isa<mlir::CallOpInterface>(op))
+    return Release::Unknown;
+
+  for (auto &region : op->getRegions()) {
+    for (auto &nested : region.getOps()) {
+      if (checkRelease(&nested, owner) != Release::None)
+        return Release::Unknown;
+    }
+  }
+  return Release::None;
+}
+
+/// Finds dealloc, which releases reference acquired by retain.
+mlir::memref::DeallocOp findRelease(plier::RetainOp retain) {
+  auto owner = getOwner(retain.source());
+  for (auto op = retain->getNextNode(); op; op = op->getNextNode()) {
+    auto release = checkRelease(op, owner);
+    if (release == Release::Owner)
+      return mlir::cast<mlir::memref::DeallocOp>(op);
+
+    if (release == Release::Unknown)
+      break;
+  }
+  return {};
+}
+} // namespace
+
+mlir::LogicalResult plier::elideRetainRelease(mlir::FuncOp func) {
+  llvm::SmallVector<plier::RetainOp> retains;
+  func.walk([&](plier::RetainOp op) { retains.emplace_back(op); });
+
+  bool changed = false;
+  for (auto retain : retains) {
+    auto dealloc = findRelease(retain);
+    if (!dealloc)
+      continue;
+
+    // Refcount never drops below its value before retain, so buffer stays
+    // alive until the dealloc.
+    retain.getResult().replaceAllUsesWith(retain.source());
+    retain->erase();
+    dealloc->erase();
+    changed = true;
+  }
+  return mlir::success(changed);
+}
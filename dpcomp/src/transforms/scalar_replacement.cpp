@@ -0,0 +1,452 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "plier/transforms/scalar_replacement.hpp"
+
+#include <map>
+
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/SmallVector.h>
+
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/Dialect/SCF/SCF.h>
+#include <mlir/Dialect/StandardOps/IR/Ops.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+
+#include "plier/analysis/alias_analysis.hpp"
+#include "plier/analysis/memory_ssa.hpp"
+#include "plier/transforms/const_utils.hpp"
+
+namespace {
+struct MemAccess {
+  mlir::Operation *op;
+  mlir::Value memref;
+  mlir::ValueRange indices;
+};
+
+llvm::Optional<MemAccess> getMemAccess(mlir::Operation *op) {
+  if (auto load = mlir::dyn_cast<mlir::memref::LoadOp>(op))
+    return MemAccess{op, load.memref(), load.indices()};
+
+  if (auto store = mlir::dyn_cast<mlir::memref::StoreOp>(op))
+    return MemAccess{op, store.memref(), store.indices()};
+
+  return llvm::None;
+}
+
+mlir::AliasResult alias(const MemAccess &lhs, const MemAccess &rhs) {
+  return plier::aliasAccesses(lhs.memref, lhs.indices, rhs.memref,
+                              rhs.indices);
+}
+
+bool mayAlias(mlir::Operation *op1, mlir::Operation *op2) {
+  auto access1 = getMemAccess(op1);
+  auto access2 = getMemAccess(op2);
+  if (!access1 || !access2)
+    return true;
+
+  return !alias(*access1, *access2).isNo();
+}
+
+mlir::Type getElementType(mlir::Value memref) {
+  return memref.getType().cast<mlir::MemRefType>().getElementType();
+}
+
+/// Values of other types cannot be materialized for the empty loop case.
+bool isSupportedType(mlir::Value memref) {
+  return getElementType(memref).isIntOrIndexOrFloat();
+}
+
+/// Collects loads and stores nested in the loop. Returns false if loop
+/// contains any other ops accessing memory, except for allocations and
+/// deallocations of the buffers local to the loop.
+bool collectAccesses(mlir::scf::ForOp loop,
+                     llvm::SmallVectorImpl<MemAccess> &accesses) {
+  auto walkResult = loop.getBody()->walk([&](mlir::Operation *op) {
+    if (auto access = getMemAccess(op)) {
+      accesses.emplace_back(*access);
+      return mlir::WalkResult::advance();
+    }
+
+    if (op->getNumRegions() != 0 &&
+        op->hasTrait<mlir::OpTrait::HasRecursiveSideEffects>())
+      return mlir::WalkResult::advance();
+
+    if (mlir::MemoryEffectOpInterface::hasNoEffect(op))
+      return mlir::WalkResult::advance();
+
+    if (auto dealloc = mlir::dyn_cast<mlir::memref::DeallocOp>(op))
+      if (!loop.isDefinedOutsideOfLoop(dealloc.memref()))
+        return mlir::WalkResult::advance();
+
+    if (auto effects = mlir::dyn_cast<mlir::MemoryEffectOpInterface>(op))
+      if (effects.onlyHasEffect<mlir::MemoryEffects::Allocate>())
+        return mlir::WalkResult::advance();
+
+    return mlir::WalkResult::interrupt();
+  });
+  return !walkResult.wasInterrupted();
+}
+
+/// Loads and stores of the same loop invariant element.
+struct Reduction {
+  MemAccess access;
+  llvm::SmallVector<mlir::Operation *> ops;
+};
+
+/// Loads of `memref[..., iv + offset, ...]`, grouped by offset.
+struct Rotation {
+  mlir::Value memref;
+  llvm::SmallVector<mlir::Value> indices;
+  unsigned dim = 0;
+  std::map<int64_t, llvm::SmallVector<mlir::memref::LoadOp, 1>> loads;
+};
+
+struct LoopPlan {
+  mlir::scf::ForOp loop;
+  llvm::SmallVector<Reduction> reductions;
+  llvm::SmallVector<Rotation> rotations;
+  int64_t step = 0;
+
+  bool empty() const { return reductions.empty() && rotations.empty(); }
+};
+
+void collectReductions(LoopPlan &plan, llvm::ArrayRef<MemAccess> accesses) {
+  auto loop = plan.loop;
+  auto isInvariant = [&](const MemAccess &access) {
+    return loop.isDefinedOutsideOfLoop(access.memref) &&
+           llvm::all_of(access.indices, [&](mlir::Value index) {
+             return loop.isDefinedOutsideOfLoop(index);
+           });
+  };
+
+  llvm::SmallVector<Reduction> candidates;
+  for (auto &access : accesses) {
+    if (access.op->getBlock() != loop.getBody() || !isInvariant(access) ||
+        !isSupportedType(access.memref))
+      continue;
+
+    auto it = llvm::find_if(candidates, [&](const Reduction &red) {
+      return alias(red.access, access).isMust();
+    });
+    if (it == candidates.end()) {
+      candidates.push_back({access, {access.op}});
+    } else {
+      it->ops.emplace_back(access.op);
+    }
+  }
+
+  for (auto &candidate : candidates) {
+    if (llvm::none_of(candidate.ops, [](mlir::Operation *op) {
+          return mlir::isa<mlir::memref::StoreOp>(op);
+        }))
+      continue;
+
+    // All other accesses in the loop, including nested into inner loops and
+    // ifs, must not touch this element.
+    bool legal = llvm::all_of(accesses, [&](const MemAccess &access) {
+      return llvm::is_contained(candidate.ops, access.op) ||
+             alias(candidate.access, access).isNo();
+    });
+    if (legal)
+      plan.reductions.emplace_back(std::move(candidate));
+  }
+}
+
+/// Returns `c` if `val` is `iv + c`.
+llvm::Optional<int64_t> getIvOffset(mlir::Value val, mlir::Value iv) {
+  if (val == iv)
+    return 0;
+
+  auto getConst = [](mlir::Value v) -> llvm::Optional<int64_t> {
+    if (auto attr = plier::getConstVal<mlir::IntegerAttr>(v))
+      return plier::getIntAttrValue(attr);
+
+    return llvm::None;
+  };
+  if (auto add = val.getDefiningOp<mlir::AddIOp>()) {
+    if (add.lhs() == iv)
+      return getConst(add.rhs());
+
+    if (add.rhs() == iv)
+      return getConst(add.lhs());
+  }
+  if (auto sub = val.getDefiningOp<mlir::SubIOp>()) {
+    if (sub.lhs() == iv)
+      if (auto cst = getConst(sub.rhs()))
+        return -*cst;
+  }
+  return llvm::None;
+}
+
+void collectRotations(LoopPlan &plan, plier::MemorySSA &memssa) {
+  auto loop = plan.loop;
+  auto step = plier::getConstVal<mlir::IntegerAttr>(loop.step());
+  if (!step || plier::getIntAttrValue(step) <= 0)
+    return;
+
+  plan.step = plier::getIntAttrValue(step);
+  auto iv = loop.getInductionVar();
+  for (auto load : loop.getBody()->getOps<mlir::memref::LoadOp>()) {
+    auto memref = load.memref();
+    if (!loop.isDefinedOutsideOfLoop(memref) || !isSupportedType(memref))
+      continue;
+
+    // Loaded memory must not be modified anywhere in the loop.
+    auto node = memssa.getNode(load);
+    if (!node)
+      continue;
+
+    auto defOp = memssa.getNodeOperation(memssa.getNodeDef(node));
+    if (defOp && loop->isAncestor(defOp))
+      continue;
+
+    llvm::Optional<unsigned> dim;
+    llvm::Optional<int64_t> offset;
+    bool valid = true;
+    for (auto it : llvm::enumerate(load.indices())) {
+      auto index = it.value();
+      if (loop.isDefinedOutsideOfLoop(index))
+        continue;
+
+      auto off = getIvOffset(index, iv);
+      if (!off || dim) {
+        valid = false;
+        break;
+      }
+      dim = static_cast<unsigned>(it.index());
+      offset = off;
+    }
+    if (!valid || !dim)
+      continue;
+
+    llvm::SmallVector<mlir::Value> indices(load.indices().begin(),
+                                           load.indices().end());
+    indices[*dim] = iv;
+    auto it = llvm::find_if(plan.rotations, [&](const Rotation &rot) {
+      return rot.memref == memref && rot.dim == *dim &&
+             llvm::makeArrayRef(rot.indices) == llvm::makeArrayRef(indices);
+    });
+    if (it == plan.rotations.end()) {
+      plan.rotations.push_back({memref, indices, *dim, {}});
+      it = std::prev(plan.rotations.end());
+    }
+    it->loads[*offset].emplace_back(load);
+  }
+
+  // Value of `iv + offset` is reused on the next iteration only if the same
+  // array is also accessed with `iv + offset - step`.
+  llvm::erase_if(plan.rotations, [&](const Rotation &rot) {
+    return llvm::none_of(rot.loads, [&](auto &it) {
+      return rot.loads.count(it.first + plan.step) != 0;
+    });
+  });
+}
+
+/// Replaces `loop` with the new loop with additional iteration arguments.
+/// Body is moved into the new loop, yields for new arguments must be added by
+/// caller.
+mlir::scf::ForOp addIterArgs(mlir::OpBuilder &builder, mlir::scf::ForOp loop,
+                             mlir::ValueRange newInits) {
+  auto initArgs = llvm::to_vector<8>(loop.initArgs());
+  initArgs.append(newInits.begin(), newInits.end());
+
+  builder.setInsertionPoint(loop);
+  auto newLoop = builder.create<mlir::scf::ForOp>(
+      loop.getLoc(), loop.lowerBound(), loop.upperBound(), loop.step(),
+      initArgs);
+  auto oldBody = loop.getBody();
+  auto newBody = newLoop.getBody();
+  newBody->getOperations().splice(newBody->end(), oldBody->getOperations());
+  for (auto it : llvm::zip(oldBody->getArguments(), newBody->getArguments()))
+    std::get<0>(it).replaceAllUsesWith(std::get<1>(it));
+
+  for (auto it : llvm::zip(loop.getResults(), newLoop.getResults()))
+    std::get<0>(it).replaceAllUsesWith(std::get<1>(it));
+
+  loop.erase();
+  return newLoop;
+}
+
+mlir::scf::ForOp applyPlan(LoopPlan &plan) {
+  auto loop = plan.loop;
+  auto loc = loop.getLoc();
+  mlir::OpBuilder builder(loop);
+
+  // Access ops are erased during rewrite, copy indices.
+  llvm::SmallVector<llvm::SmallVector<mlir::Value>> redIndices;
+  for (auto &red : plan.reductions)
+    redIndices.emplace_back(red.access.indices.begin(),
+                            red.access.indices.end());
+
+  // Offsets, which values are carried to the next iteration.
+  llvm::SmallVector<std::pair<Rotation *, int64_t>> carried;
+  for (auto &rot : plan.rotations)
+    for (auto &it : rot.loads)
+      if (rot.loads.count(it.first + plan.step) != 0)
+        carried.emplace_back(&rot, it.first);
+
+  // Initial values are loaded only if loop has any iterations, to avoid out
+  // of bounds accesses for empty loops.
+  llvm::SmallVector<mlir::Type> types;
+  for (auto &red : plan.reductions)
+    types.emplace_back(getElementType(red.access.memref));
+
+  for (auto &it : carried)
+    types.emplace_back(getElementType(it.first->memref));
+
+  auto lower = loop.lowerBound();
+  auto cond = builder.create<mlir::CmpIOp>(loc, mlir::CmpIPredicate::slt,
+                                           lower, loop.upperBound());
+  auto thenBody = [&](mlir::OpBuilder &b, mlir::Location l) {
+    llvm::SmallVector<mlir::Value> results;
+    for (auto it : llvm::zip(plan.reductions, redIndices))
+      results.emplace_back(b.create<mlir::memref::LoadOp>(
+          l, std::get<0>(it).access.memref, std::get<1>(it)));
+
+    for (auto &it : carried) {
+      auto rot = it.first;
+      auto indices = rot->indices;
+      indices[rot->dim] = lower;
+      if (it.second != 0) {
+        auto offset = b.create<mlir::ConstantIndexOp>(l, it.second);
+        indices[rot->dim] = b.create<mlir::AddIOp>(l, lower, offset);
+      }
+      results.emplace_back(
+          b.create<mlir::memref::LoadOp>(l, rot->memref, indices));
+    }
+    b.create<mlir::scf::YieldOp>(l, results);
+  };
+  auto elseBody = [&](mlir::OpBuilder &b, mlir::Location l) {
+    llvm::SmallVector<mlir::Value> results;
+    for (auto type : types)
+      results.emplace_back(b.create<mlir::ConstantOp>(l, b.getZeroAttr(type)));
+
+    b.create<mlir::scf::YieldOp>(l, results);
+  };
+  auto ifOp =
+      builder.create<mlir::scf::IfOp>(loc, types, cond, thenBody, elseBody);
+  llvm::SmallVector<mlir::Value> inits(ifOp.getResults().begin(),
+                                       ifOp.getResults().end());
+
+  auto numResults = loop.getNumResults();
+  auto newLoop = addIterArgs(builder, loop, inits);
+  auto body = newLoop.getBody();
+  auto args = body->getArguments().drop_front(1 + numResults);
+  llvm::SmallVector<mlir::Value> yields;
+
+  auto redArgs = args.take_front(plan.reductions.size());
+  for (auto it : llvm::zip(plan.reductions, redArgs)) {
+    auto &red = std::get<0>(it);
+    mlir::Value current = std::get<1>(it);
+    // Ops are in the body block, process them in order.
+    for (auto &op : llvm::make_early_inc_range(*body)) {
+      if (!llvm::is_contained(red.ops, &op))
+        continue;
+
+      if (auto store = mlir::dyn_cast<mlir::memref::StoreOp>(op)) {
+        current = store.value();
+      } else {
+        op.getResult(0).replaceAllUsesWith(current);
+      }
+      op.erase();
+    }
+    yields.emplace_back(current);
+  }
+
+  auto rotArgs = args.drop_front(plan.reductions.size());
+  auto getCarriedArg = [&](Rotation *rot, int64_t offset) -> mlir::Value {
+    for (auto it : llvm::zip(carried, rotArgs))
+      if (std::get<0>(it) == std::make_pair(rot, offset))
+        return std::get<1>(it);
+
+    return {};
+  };
+  for (auto &it : carried) {
+    auto rot = it.first;
+    auto next = it.second + plan.step;
+    mlir::Value nextVal = getCarriedArg(rot, next);
+    if (!nextVal)
+      nextVal = rot->loads[next].front().getResult();
+
+    yields.emplace_back(nextVal);
+  }
+  for (auto &it : carried) {
+    auto arg = getCarriedArg(it.first, it.second);
+    for (auto load : it.first->loads[it.second]) {
+      load.getResult().replaceAllUsesWith(arg);
+      load.erase();
+    }
+  }
+
+  auto yield = body->getTerminator();
+  yield->insertOperands(yield->getNumOperands(), yields);
+
+  // Memref can be function argument or global, don't touch it if loop has no
+  // iterations.
+  if (!plan.reductions.empty()) {
+    builder.setInsertionPointAfter(newLoop);
+    auto results = newLoop.getResults().drop_front(numResults);
+    auto storeBody = [&](mlir::OpBuilder &b, mlir::Location l) {
+      for (auto it : llvm::zip(plan.reductions, redIndices, results))
+        b.create<mlir::memref::StoreOp>(l, std::get<2>(it),
+                                        std::get<0>(it).access.memref,
+                                        std::get<1>(it));
+
+      b.create<mlir::scf::YieldOp>(l);
+    };
+    builder.create<mlir::scf::IfOp>(loc, mlir::TypeRange(), cond, storeBody);
+  }
+
+  return newLoop;
+}
+} // namespace
+
+mlir::LogicalResult plier::replaceLoopScalars(mlir::FuncOp func) {
+  auto memssa = buildMemorySSA(func.getRegion());
+  if (!memssa)
+    return mlir::failure();
+
+  (void)memssa->optimizeUses(&mayAlias);
+
+  // Analyze all loops before changing anything, memssa is not updated.
+  llvm::SmallVector<LoopPlan> plans;
+  func.walk([&](mlir::scf::ForOp loop) {
+    llvm::SmallVector<MemAccess> accesses;
+    if (!collectAccesses(loop, accesses))
+      return;
+
+    LoopPlan plan;
+    plan.loop = loop;
+    collectReductions(plan, accesses);
+    collectRotations(plan, *memssa);
+    if (!plan.empty())
+      plans.emplace_back(std::move(plan));
+  });
+
+  // Plans are in post order, skip outer loops if inner ones were changed as
+  // their bodies are not valid anymore.
+  llvm::SmallVector<mlir::Operation *> changed;
+  for (auto &plan : plans) {
+    auto loop = plan.loop;
+    if (llvm::any_of(changed, [&](mlir::Operation *op) {
+          return loop->isProperAncestor(op);
+        }))
+      continue;
+
+    changed.emplace_back(applyPlan(plan));
+  }
+  return mlir::success(!changed.empty());
+}
@@ -0,0 +1,499 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "plier/transforms/vectorize_linalg.hpp"
+
+#include <llvm/ADT/SmallVector.h>
+
+#include <mlir/Dialect/Linalg/IR/LinalgOps.h>
+#include <mlir/Dialect/Linalg/Transforms/Transforms.h>
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/Dialect/SCF/SCF.h>
+#include <mlir/Dialect/StandardOps/IR/Ops.h>
+#include <mlir/Dialect/Vector/VectorOps.h>
+#include <mlir/IR/BlockAndValueMapping.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+
+#include "plier/dialect.hpp"
+
+namespace {
+int64_t getIntAttr(mlir::Operation *op, llvm::StringRef name) {
+  auto attr = op->getAttrOfType<mlir::IntegerAttr>(name);
+  if (!attr)
+    return 0;
+
+  return std::max(static_cast<int64_t>(0), attr.getInt());
+}
+
+bool isParallelIterator(mlir::Attribute attr) {
+  return attr.cast<mlir::StringAttr>().getValue() ==
+         mlir::getParallelIteratorTypeName();
+}
+
+/// Checks if any operand is accessed in order, different from loops order.
+bool hasTransposedAccess(mlir::linalg::GenericOp op) {
+  for (auto map : op.getIndexingMaps()) {
+    llvm::Optional<unsigned> prev;
+    for (auto expr : map.getResults()) {
+      auto dim = expr.dyn_cast<mlir::AffineDimExpr>();
+      if (!dim)
+        continue;
+
+      auto pos = dim.getPosition();
+      if (prev && pos < *prev)
+        return true;
+
+      prev = pos;
+    }
+  }
+  return false;
+}
+
+mlir::linalg::GenericOp tileOp(mlir::OpBuilder &builder,
+                               mlir::linalg::GenericOp op, int64_t tileSize) {
+  llvm::SmallVector<int64_t> tileSizes(op.getNumLoops(), tileSize);
+  mlir::linalg::LinalgTilingOptions options;
+  options.setTileSizes(tileSizes).setLoopType(
+      mlir::linalg::LinalgTilingLoopType::ParallelLoops);
+
+  builder.setInsertionPoint(op);
+  auto tiled = mlir::linalg::tileLinalgOp(builder, op, options);
+  if (!tiled)
+    return nullptr;
+
+  op.erase();
+  return mlir::cast<mlir::linalg::GenericOp>(tiled->op.getOperation());
+}
+
+/// Returns same memref type but with unit innermost stride or null type if
+/// innermost stride is statically known and is not unit.
+mlir::MemRefType getContiguousType(mlir::MemRefType type) {
+  int64_t offset;
+  llvm::SmallVector<int64_t> strides;
+  if (mlir::failed(mlir::getStridesAndOffset(type, strides, offset)))
+    return {};
+
+  assert(!strides.empty());
+  if (strides.back() == 1)
+    return type;
+
+  if (strides.back() != mlir::ShapedType::kDynamicStrideOrOffset)
+    return {};
+
+  strides.back() = 1;
+  auto layout =
+      mlir::makeStridedLinearLayoutMap(strides, offset, type.getContext());
+  return mlir::MemRefType::get(type.getShape(), type.getElementType(), layout,
+                               type.getMemorySpace());
+}
+
+bool isVectorizableBodyOp(mlir::Operation &op) {
+  if (op.getNumRegions() != 0 ||
+      !mlir::MemoryEffectOpInterface::hasNoEffect(&op))
+    return false;
+
+  // Masked remainder is computed on padding values, avoid division by zero.
+  if (mlir::isa<mlir::SignedDivIOp, mlir::UnsignedDivIOp, mlir::SignedRemIOp,
+                mlir::UnsignedRemIOp, mlir::SignedFloorDivIOp,
+                mlir::SignedCeilDivIOp>(op))
+    return false;
+
+  return op.hasTrait<mlir::OpTrait::ConstantLike>() ||
+         op.hasTrait<mlir::OpTrait::Elementwise>();
+}
+
+struct VectorizeInfo {
+  int64_t vectorSize = 0;
+  /// Operands accessed along the innermost loop.
+  llvm::SmallVector<bool> isVector;
+};
+
+llvm::Optional<VectorizeInfo> getVectorizeInfo(mlir::linalg::GenericOp op,
+                                               int64_t vectorLength) {
+  if (!op.hasBufferSemantics())
+    return {};
+
+  auto numLoops = op.getNumLoops();
+  if (numLoops == 0)
+    return {};
+
+  auto innerDim = numLoops - 1;
+  if (!isParallelIterator(op.iterator_types()[innerDim]))
+    return {};
+
+  unsigned maxWidth = 0;
+  auto checkType = [&](mlir::Type type) {
+    if (!type.isIntOrFloat())
+      return false;
+
+    maxWidth = std::max(maxWidth, type.getIntOrFloatBitWidth());
+    return true;
+  };
+
+  // Vector transfers of sub-byte types are bit-packed, while memrefs store
+  // such elements (e.g. i1 masks) one per byte.
+  auto checkMemType = [&](mlir::Type type) {
+    return checkType(type) && type.getIntOrFloatBitWidth() >= 8;
+  };
+
+  VectorizeInfo info;
+  auto numInputs = op.getNumInputs();
+  auto maps = op.getIndexingMaps();
+  for (auto it : llvm::enumerate(op->getOperands())) {
+    auto index = static_cast<unsigned>(it.index());
+    auto type = it.value().getType().dyn_cast<mlir::MemRefType>();
+    if (!type || !checkMemType(type.getElementType()))
+      return {};
+
+    llvm::Optional<unsigned> innerPos;
+    auto map = maps[index];
+    for (auto mapIt : llvm::enumerate(map.getResults())) {
+      auto expr = mapIt.value();
+      if (expr.isa<mlir::AffineConstantExpr>())
+        continue;
+
+      auto dim = expr.dyn_cast<mlir::AffineDimExpr>();
+      if (!dim)
+        return {};
+
+      if (dim.getPosition() == innerDim) {
+        if (innerPos)
+          return {};
+
+        innerPos = static_cast<unsigned>(mapIt.index());
+      }
+    }
+
+    bool isVector = static_cast<bool>(innerPos);
+    if (isVector && (*innerPos != map.getNumResults() - 1 ||
+                     !getContiguousType(type)))
+      return {};
+
+    // Every output element must be written by the single vector lane.
+    if (index >= numInputs && !isVector)
+      return {};
+
+    info.isVector.emplace_back(isVector);
+  }
+
+  for (auto &bodyOp : op.region().front().without_terminator()) {
+    if (!isVectorizableBodyOp(bodyOp))
+      return {};
+
+    for (auto type : bodyOp.getResultTypes())
+      if (!checkType(type))
+        return {};
+
+    for (auto type : bodyOp.getOperandTypes())
+      if (!checkType(type))
+        return {};
+  }
+
+  assert(maxWidth != 0);
+  info.vectorSize = vectorLength * 8 / maxWidth;
+  if (info.vectorSize < 2)
+    return {};
+
+  return info;
+}
+
+/// Generates loop nest over linalg op iteration space, with innermost loop
+/// vectorized. All parallel loops are mapped to the single scf.parallel, with
+/// reduction loops nested as scf.for.
+class VectorLoopsBuilder {
+public:
+  VectorLoopsBuilder(mlir::linalg::GenericOp op, mlir::ValueRange operands,
+                     mlir::ValueRange sizes, const VectorizeInfo &info)
+      : op(op), operands(operands), sizes(sizes), info(info) {}
+
+  void build(mlir::OpBuilder &builder, mlir::Location loc) {
+    auto numLoops = op.getNumLoops();
+    auto innerDim = numLoops - 1;
+    for (auto it : llvm::enumerate(op.iterator_types())) {
+      auto dim = static_cast<unsigned>(it.index());
+      if (isParallelIterator(it.value())) {
+        parallelDims.emplace_back(dim);
+      } else {
+        reductionDims.emplace_back(dim);
+      }
+    }
+    ivs.resize(numLoops);
+
+    zero = builder.create<mlir::ConstantIndexOp>(loc, 0);
+    one = builder.create<mlir::ConstantIndexOp>(loc, 1);
+    auto vecSize = builder.create<mlir::ConstantIndexOp>(loc, info.vectorSize);
+    auto size = sizes[innerDim];
+    auto rem = builder.createOrFold<mlir::UnsignedRemIOp>(loc, size, vecSize);
+    auto mainSize = builder.createOrFold<mlir::SubIOp>(loc, size, rem);
+
+    auto genLoops = [&](mlir::Value begin, mlir::Value end, bool inBounds) {
+      llvm::SmallVector<mlir::Value> lowerBounds;
+      llvm::SmallVector<mlir::Value> upperBounds;
+      llvm::SmallVector<mlir::Value> steps;
+      for (auto dim : parallelDims) {
+        if (dim == innerDim) {
+          lowerBounds.emplace_back(begin);
+          upperBounds.emplace_back(end);
+          steps.emplace_back(vecSize);
+        } else {
+          lowerBounds.emplace_back(zero);
+          upperBounds.emplace_back(sizes[dim]);
+          steps.emplace_back(one);
+        }
+      }
+      auto bodyBuilder = [&](mlir::OpBuilder &b, mlir::Location l,
+                             mlir::ValueRange parallelIvs) {
+        for (auto it : llvm::zip(parallelDims, parallelIvs))
+          ivs[std::get<0>(it)] = std::get<1>(it);
+
+        genReductionLoops(b, l, reductionDims, inBounds);
+      };
+      builder.create<mlir::scf::ParallelOp>(loc, lowerBounds, upperBounds,
+                                            steps, bodyBuilder);
+    };
+
+    // Main part, vector accesses are always in bounds.
+    genLoops(zero, mainSize, /*inBounds*/ true);
+    // Remainder, at most one iteration with masked accesses.
+    genLoops(mainSize, size, /*inBounds*/ false);
+  }
+
+private:
+  mlir::linalg::GenericOp op;
+  mlir::ValueRange operands;
+  mlir::ValueRange sizes;
+  const VectorizeInfo &info;
+
+  llvm::SmallVector<unsigned> parallelDims;
+  llvm::SmallVector<unsigned> reductionDims;
+  llvm::SmallVector<mlir::Value> ivs;
+  mlir::Value zero;
+  mlir::Value one;
+
+  void genReductionLoops(mlir::OpBuilder &builder, mlir::Location loc,
+                         llvm::ArrayRef<unsigned> dims, bool inBounds) {
+    if (dims.empty()) {
+      genBody(builder, loc, inBounds);
+      return;
+    }
+
+    auto dim = dims.front();
+    auto bodyBuilder = [&](mlir::OpBuilder &b, mlir::Location l,
+                           mlir::Value iv, mlir::ValueRange) {
+      ivs[dim] = iv;
+      genReductionLoops(b, l, dims.drop_front(), inBounds);
+      b.create<mlir::scf::YieldOp>(l);
+    };
+    builder.create<mlir::scf::ForOp>(loc, zero, sizes[dim], one, llvm::None,
+                                     bodyBuilder);
+  }
+
+  llvm::SmallVector<mlir::Value> getIndices(mlir::OpBuilder &builder,
+                                            mlir::Location loc,
+                                            mlir::AffineMap map) {
+    llvm::SmallVector<mlir::Value> indices;
+    indices.reserve(map.getNumResults());
+    for (auto expr : map.getResults()) {
+      if (auto dim = expr.dyn_cast<mlir::AffineDimExpr>()) {
+        indices.emplace_back(ivs[dim.getPosition()]);
+      } else {
+        auto val = expr.cast<mlir::AffineConstantExpr>().getValue();
+        indices.emplace_back(
+            builder.create<mlir::ConstantIndexOp>(loc, val).getResult());
+      }
+    }
+    return indices;
+  }
+
+  void genBody(mlir::OpBuilder &builder, mlir::Location loc, bool inBounds) {
+    auto vectorSize = info.vectorSize;
+    auto getVecType = [&](mlir::Type type) {
+      return mlir::VectorType::get(vectorSize, type);
+    };
+
+    mlir::BlockAndValueMapping mapping;
+    auto getVal = [&](mlir::Value val) -> mlir::Value {
+      if (auto res = mapping.lookupOrNull(val))
+        return res;
+
+      // Scalar defined outside of the body.
+      mlir::Value res =
+          builder.create<mlir::SplatOp>(loc, val, getVecType(val.getType()));
+      mapping.map(val, res);
+      return res;
+    };
+
+    auto &block = op.region().front();
+    auto maps = op.getIndexingMaps();
+    for (auto it : llvm::enumerate(operands)) {
+      auto index = static_cast<unsigned>(it.index());
+      auto arg = block.getArgument(index);
+      if (arg.use_empty())
+        continue;
+
+      auto memref = it.value();
+      auto indices = getIndices(builder, loc, maps[index]);
+      auto vecType = getVecType(arg.getType());
+      mlir::Value val;
+      if (info.isVector[index]) {
+        val = builder.create<mlir::vector::TransferReadOp>(
+            loc, vecType, memref, indices, llvm::makeArrayRef(inBounds));
+      } else {
+        auto scalar =
+            builder.create<mlir::memref::LoadOp>(loc, memref, indices);
+        val = builder.create<mlir::SplatOp>(loc, scalar, vecType);
+      }
+      mapping.map(arg, val);
+    }
+
+    for (auto &bodyOp : block.without_terminator()) {
+      if (bodyOp.hasTrait<mlir::OpTrait::ConstantLike>()) {
+        auto scalar = builder.clone(bodyOp)->getResult(0);
+        mapping.map(bodyOp.getResult(0), getVal(scalar));
+        continue;
+      }
+
+      llvm::SmallVector<mlir::Value> newOperands;
+      newOperands.reserve(bodyOp.getNumOperands());
+      for (auto operand : bodyOp.getOperands())
+        newOperands.emplace_back(getVal(operand));
+
+      llvm::SmallVector<mlir::Type> newTypes;
+      newTypes.reserve(bodyOp.getNumResults());
+      for (auto type : bodyOp.getResultTypes())
+        newTypes.emplace_back(getVecType(type));
+
+      mlir::OperationState state(loc, bodyOp.getName());
+      state.addOperands(newOperands);
+      state.addTypes(newTypes);
+      state.addAttributes(bodyOp.getAttrs());
+      auto newOp = builder.createOperation(state);
+      mapping.map(bodyOp.getResults(), newOp->getResults());
+    }
+
+    auto yield = mlir::cast<mlir::linalg::YieldOp>(block.getTerminator());
+    auto numInputs = op.getNumInputs();
+    for (auto it : llvm::enumerate(yield.values())) {
+      auto index = numInputs + static_cast<unsigned>(it.index());
+      auto indices = getIndices(builder, loc, maps[index]);
+      builder.create<mlir::vector::TransferWriteOp>(
+          loc, getVal(it.value()), operands[index], indices,
+          llvm::makeArrayRef(inBounds));
+    }
+  }
+};
+
+mlir::LogicalResult vectorizeOp(mlir::OpBuilder &builder,
+                                mlir::linalg::GenericOp op,
+                                int64_t vectorLength) {
+  auto info = getVectorizeInfo(op, vectorLength);
+  if (!info)
+    return mlir::failure();
+
+  auto loc = op.getLoc();
+  builder.setInsertionPoint(op);
+  llvm::SmallVector<mlir::Value> sizes;
+  for (auto range : op.createLoopRanges(builder, loc))
+    sizes.emplace_back(range.size);
+
+  // Innermost stride of the memref can be dynamic, check it at runtime and
+  // fallback to the original op if it is not contiguous.
+  llvm::SmallVector<mlir::Value> operands(op->getOperands());
+  llvm::SmallVector<mlir::MemRefType> contiguousTypes(operands.size());
+  mlir::Value cond;
+  for (auto it : llvm::enumerate(operands)) {
+    auto index = it.index();
+    if (!info->isVector[index])
+      continue;
+
+    auto memref = it.value();
+    auto type = memref.getType().cast<mlir::MemRefType>();
+    auto contiguousType = getContiguousType(type);
+    assert(contiguousType);
+    if (contiguousType == type)
+      continue;
+
+    contiguousTypes[index] = contiguousType;
+    auto stride = builder.create<plier::ExtractMemrefMetadataOp>(
+        loc, memref, type.getRank() - 1);
+    auto one = builder.create<mlir::ConstantIndexOp>(loc, 1);
+    mlir::Value isContiguous = builder.create<mlir::CmpIOp>(
+        loc, mlir::CmpIPredicate::eq, stride, one);
+    if (cond) {
+      cond = builder.create<mlir::AndOp>(loc, cond, isContiguous);
+    } else {
+      cond = isContiguous;
+    }
+  }
+
+  auto genVectorized = [&](mlir::OpBuilder &b, mlir::Location l) {
+    llvm::SmallVector<mlir::Value> newOperands(operands);
+    for (auto it : llvm::enumerate(contiguousTypes)) {
+      if (auto type = it.value()) {
+        auto index = it.index();
+        newOperands[index] =
+            b.create<mlir::memref::CastOp>(l, operands[index], type);
+      }
+    }
+    VectorLoopsBuilder(op, newOperands, sizes, *info).build(b, l);
+  };
+
+  if (cond) {
+    auto thenBody = [&](mlir::OpBuilder &b, mlir::Location l) {
+      genVectorized(b, l);
+      b.create<mlir::scf::YieldOp>(l);
+    };
+    auto elseBody = [&](mlir::OpBuilder &b, mlir::Location l) {
+      b.clone(*op);
+      b.create<mlir::scf::YieldOp>(l);
+    };
+    builder.create<mlir::scf::IfOp>(loc, mlir::TypeRange(), cond, thenBody,
+                                    elseBody);
+  } else {
+    genVectorized(builder, loc);
+  }
+  op.erase();
+  return mlir::success();
+}
+} // namespace
+
+mlir::LogicalResult plier::tileAndVectorizeLinalgOps(mlir::FuncOp func) {
+  auto tileSize = getIntAttr(func, plier::attributes::getTileSizeName());
+  auto vectorLength =
+      getIntAttr(func, plier::attributes::getVectorLengthName());
+  if (tileSize == 0 && vectorLength == 0)
+    return mlir::failure();
+
+  llvm::SmallVector<mlir::linalg::GenericOp> ops;
+  func.walk([&](mlir::linalg::GenericOp op) {
+    if (op.hasBufferSemantics())
+      ops.emplace_back(op);
+  });
+
+  bool changed = false;
+  mlir::OpBuilder builder(func.getContext());
+  for (auto op : ops) {
+    if (tileSize > 1 && op.getNumLoops() > 1 && hasTransposedAccess(op)) {
+      if (auto tiled = tileOp(builder, op, tileSize)) {
+        op = tiled;
+        changed = true;
+      }
+    }
+    if (vectorLength > 0 &&
+        mlir::succeeded(vectorizeOp(builder, op, vectorLength)))
+      changed = true;
+  }
+  return mlir::success(changed);
+}
@@ -12,6 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
 #include "common.hpp"
 
 extern "C" {
@@ -22,4 +26,67 @@ DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_math_runtime_init() {
 DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_math_runtime_finalize() {
   // Nothing
 }
+
+DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_check_reduce_size(int64_t size) {
+  if (size == 0) {
+    fprintf(stderr, "dpcomp: zero-size array to reduction operation which "
+                    "has no identity\n");
+    abort();
+  }
+}
+
+DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_check_gufunc_dim(int64_t size,
+                                                        int64_t expected) {
+  if (size != expected) {
+    fprintf(stderr,
+            "dpcomp: gufunc operands dimension mismatch: %lld != %lld\n",
+            static_cast<long long>(size), static_cast<long long>(expected));
+    abort();
+  }
+}
+
+DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_check_matmul_dim(int64_t size1,
+                                                        int64_t size2) {
+  if (size1 != size2) {
+    fprintf(stderr,
+            "dpcomp: matmul: shapes are not aligned: %lld (dim 1) != %lld "
+            "(dim 0)\n",
+            static_cast<long long>(size1), static_cast<long long>(size2));
+    abort();
+  }
+}
+
+DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_check_index(int64_t index,
+                                                   int64_t size) {
+  if (index < 0 || index >= size) {
+    fprintf(stderr, "dpcomp: index %lld is out of bounds for size %lld\n",
+            static_cast<long long>(index), static_cast<long long>(size));
+    abort();
+  }
+}
+
+DPCOMP_MATH_RUNTIME_EXPORT void
+dpcomp_check_setitem_dim(int64_t size, int64_t expected, int64_t dim) {
+  if (size != expected) {
+    fprintf(stderr,
+            "dpcomp: shape mismatch: value array dimension %lld is %lld but "
+            "indexing result dimension is %lld\n",
+            static_cast<long long>(dim), static_cast<long long>(size),
+            static_cast<long long>(expected));
+    abort();
+  }
+}
+
+DPCOMP_MATH_RUNTIME_EXPORT void
+dpcomp_check_mask_dim(int64_t size, int64_t maskSize, int64_t dim) {
+  if (size != maskSize) {
+    fprintf(stderr,
+            "dpcomp: boolean index did not match indexed array along "
+            "dimension %lld; dimension is %lld but corresponding boolean "
+            "dimension is %lld\n",
+            static_cast<long long>(dim), static_cast<long long>(size),
+            static_cast<long long>(maskSize));
+    abort();
+  }
+}
 }
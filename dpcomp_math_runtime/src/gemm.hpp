@@ -0,0 +1,297 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#ifdef BLAS_ENABLE
+#include <cblas.h>
+#endif
+
+#include "common.hpp"
+
+template <typename T> struct MatrixView {
+  T *data;
+  size_t rows;
+  size_t cols;
+  ptrdiff_t rowStride;
+  ptrdiff_t colStride;
+
+  T &operator()(size_t i, size_t j) const {
+    return data[static_cast<ptrdiff_t>(i) * rowStride +
+                static_cast<ptrdiff_t>(j) * colStride];
+  }
+
+  MatrixView transposed() const {
+    return {data, cols, rows, colStride, rowStride};
+  }
+
+  MatrixView block(size_t i, size_t j, size_t numRows, size_t numCols) const {
+    return {data + static_cast<ptrdiff_t>(i) * rowStride +
+                static_cast<ptrdiff_t>(j) * colStride,
+            numRows, numCols, rowStride, colStride};
+  }
+
+  operator MatrixView<const T>() const {
+    return {data, rows, cols, rowStride, colStride};
+  }
+};
+
+template <typename T> struct VectorView {
+  T *data;
+  size_t size;
+  ptrdiff_t stride;
+
+  T &operator()(size_t i) const {
+    return data[static_cast<ptrdiff_t>(i) * stride];
+  }
+};
+
+template <typename T, size_t NumDims>
+MatrixView<T> getMatrix(Memref<NumDims, T> *src, size_t batch = 0) {
+  static_assert(NumDims >= 2, "Invalid rank");
+  auto base = src->data + src->offset;
+  if (NumDims > 2)
+    base += static_cast<ptrdiff_t>(batch) *
+            static_cast<ptrdiff_t>(src->strides[0]);
+
+  return {base, src->dims[NumDims - 2], src->dims[NumDims - 1],
+          static_cast<ptrdiff_t>(src->strides[NumDims - 2]),
+          static_cast<ptrdiff_t>(src->strides[NumDims - 1])};
+}
+
+template <typename T> VectorView<T> getVector(Memref<1, T> *src) {
+  return {src->data + src->offset, src->dims[0],
+          static_cast<ptrdiff_t>(src->strides[0])};
+}
+
+inline size_t roundUp(size_t val, size_t mult) {
+  return (val + mult - 1) / mult * mult;
+}
+
+// Register block of the micro kernel, MR x NR elements of C. NR covers cache
+// line, so inner loop of the kernel can be vectorized by compiler.
+constexpr size_t MR = 4;
+template <typename T> constexpr size_t NR = 64 / sizeof(T);
+
+// Cache blocking, packed A block (MC x KC) is expected to fit in L2 and packed
+// B panel (KC x NC) in L3.
+constexpr size_t MC = 128;
+constexpr size_t KC = 256;
+constexpr size_t NC = 2048;
+
+// Products smaller than this are computed directly without packing.
+constexpr size_t SmallGemmSize = 32 * 32 * 32;
+
+/// Packs B[k0:k0+kc, j0:j0+nc] into NR-wide column slivers, padded with zeros.
+template <typename T>
+void packB(MatrixView<const T> b, size_t k0, size_t kc, size_t j0, size_t nc,
+           T *dst) {
+  constexpr auto nr = NR<T>;
+  for (size_t js = 0; js < nc; js += nr) {
+    auto width = std::min(nr, nc - js);
+    for (size_t k = 0; k < kc; ++k) {
+      for (size_t j = 0; j < width; ++j)
+        dst[j] = b(k0 + k, j0 + js + j);
+
+      for (size_t j = width; j < nr; ++j)
+        dst[j] = 0;
+
+      dst += nr;
+    }
+  }
+}
+
+/// Packs A[i0:i0+mc, k0:k0+kc] into MR-tall row slivers, padded with zeros.
+template <typename T>
+void packA(MatrixView<const T> a, size_t i0, size_t mc, size_t k0, size_t kc,
+           T *dst) {
+  for (size_t is = 0; is < mc; is += MR) {
+    auto height = std::min(MR, mc - is);
+    for (size_t k = 0; k < kc; ++k) {
+      for (size_t i = 0; i < height; ++i)
+        dst[i] = a(i0 + is + i, k0 + k);
+
+      for (size_t i = height; i < MR; ++i)
+        dst[i] = 0;
+
+      dst += MR;
+    }
+  }
+}
+
+/// Computes C[i0:i0+mr, j0:j0+nr] += alpha * Ap * Bp for packed slivers.
+template <typename T>
+void microKernel(size_t kc, const T *ap, const T *bp, T alpha, MatrixView<T> c,
+                 size_t i0, size_t j0, size_t mr, size_t nr) {
+  constexpr auto NRT = NR<T>;
+  T acc[MR][NRT] = {};
+  for (size_t k = 0; k < kc; ++k) {
+    for (size_t i = 0; i < MR; ++i) {
+      auto val = ap[i];
+      for (size_t j = 0; j < NRT; ++j)
+        acc[i][j] += val * bp[j];
+    }
+    ap += MR;
+    bp += NRT;
+  }
+
+  for (size_t i = 0; i < mr; ++i)
+    for (size_t j = 0; j < nr; ++j)
+      c(i0 + i, j0 + j) += alpha * acc[i][j];
+}
+
+template <typename T>
+void gemmSmall(MatrixView<const T> a, MatrixView<const T> b, T alpha,
+               MatrixView<T> c) {
+  for (size_t i = 0; i < a.rows; ++i) {
+    for (size_t k = 0; k < a.cols; ++k) {
+      auto val = alpha * a(i, k);
+      for (size_t j = 0; j < b.cols; ++j)
+        c(i, j) += val * b(k, j);
+    }
+  }
+}
+
+#ifdef BLAS_ENABLE
+/// Returns false if matrix layout cannot be expressed in terms of row-major
+/// BLAS matrix with leading dimension.
+template <typename T>
+bool getBlasLayout(MatrixView<T> m, CBLAS_TRANSPOSE &trans, int &ld) {
+  auto isLd = [](ptrdiff_t stride, size_t size) {
+    return stride >= std::max(static_cast<ptrdiff_t>(size),
+                              static_cast<ptrdiff_t>(1));
+  };
+  if (m.colStride == 1 && isLd(m.rowStride, m.cols)) {
+    trans = CblasNoTrans;
+    ld = static_cast<int>(m.rowStride);
+    return true;
+  }
+  if (m.rowStride == 1 && isLd(m.colStride, m.rows)) {
+    trans = CblasTrans;
+    ld = static_cast<int>(m.colStride);
+    return true;
+  }
+  return false;
+}
+
+inline void blasGemm(CBLAS_TRANSPOSE ta, CBLAS_TRANSPOSE tb, int m, int n,
+                     int k, float alpha, const float *a, int lda,
+                     const float *b, int ldb, float beta, float *c, int ldc) {
+  cblas_sgemm(CblasRowMajor, ta, tb, m, n, k, alpha, a, lda, b, ldb, beta, c,
+              ldc);
+}
+
+inline void blasGemm(CBLAS_TRANSPOSE ta, CBLAS_TRANSPOSE tb, int m, int n,
+                     int k, double alpha, const double *a, int lda,
+                     const double *b, int ldb, double beta, double *c,
+                     int ldc) {
+  cblas_dgemm(CblasRowMajor, ta, tb, m, n, k, alpha, a, lda, b, ldb, beta, c,
+              ldc);
+}
+
+template <typename T>
+bool tryBlasGemm(MatrixView<const T> a, MatrixView<const T> b, T alpha,
+                 T beta, MatrixView<T> c) {
+  CBLAS_TRANSPOSE ta, tb, tc;
+  int lda, ldb, ldc;
+  if (!getBlasLayout(a, ta, lda) || !getBlasLayout(b, tb, ldb) ||
+      !getBlasLayout(c, tc, ldc) || tc != CblasNoTrans)
+    return false;
+
+  blasGemm(ta, tb, static_cast<int>(a.rows), static_cast<int>(b.cols),
+           static_cast<int>(a.cols), alpha, a.data, lda, b.data, ldb, beta,
+           c.data, ldc);
+  return true;
+}
+#endif
+
+/// Computes C = alpha * A * B + beta * C using packed, register-blocked
+/// kernel. Outer loop over A blocks is distributed between threads. C must
+/// not overlap A or B.
+template <typename T>
+void gemm(MatrixView<const T> a, MatrixView<const T> b, MatrixView<T> c,
+          T alpha = 1, T beta = 0) {
+  auto m = a.rows;
+  auto k = a.cols;
+  auto n = b.cols;
+  if (m == 0 || n == 0)
+    return;
+
+#ifdef BLAS_ENABLE
+  if (k != 0 && tryBlasGemm(a, b, alpha, beta, c))
+    return;
+#endif
+
+  if (beta != T(1))
+    for (size_t i = 0; i < m; ++i)
+      for (size_t j = 0; j < n; ++j)
+        c(i, j) = (beta == T(0) ? T(0) : beta * c(i, j));
+
+  if (k == 0 || alpha == T(0))
+    return;
+
+  if (m * n * k <= SmallGemmSize) {
+    gemmSmall(a, b, alpha, c);
+    return;
+  }
+
+  constexpr auto nr = NR<T>;
+  // Use smaller A blocks for short matrices so all threads have some work.
+  auto numThreads =
+      static_cast<size_t>(std::max(tbb::this_task_arena::max_concurrency(), 1));
+  auto mc = std::min(MC, std::max(MR, roundUp((m + numThreads - 1) /
+                                                  numThreads,
+                                              MR)));
+  auto numBlocks = (m + mc - 1) / mc;
+
+  std::vector<T> packedB(KC * roundUp(std::min(n, NC), nr));
+  tbb::enumerable_thread_specific<std::vector<T>> packedA(
+      [&]() { return std::vector<T>(mc * KC); });
+
+  for (size_t jc = 0; jc < n; jc += NC) {
+    auto ncBlock = std::min(NC, n - jc);
+    for (size_t pc = 0; pc < k; pc += KC) {
+      auto kc = std::min(KC, k - pc);
+      packB(b, pc, kc, jc, ncBlock, packedB.data());
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, numBlocks),
+          [&](const tbb::blocked_range<size_t> &range) {
+            auto &bufA = packedA.local();
+            for (auto ib = range.begin(); ib != range.end(); ++ib) {
+              auto ic = ib * mc;
+              auto mcBlock = std::min(mc, m - ic);
+              packA(a, ic, mcBlock, pc, kc, bufA.data());
+              for (size_t jr = 0; jr < ncBlock; jr += nr) {
+                auto bp = packedB.data() + jr * kc;
+                for (size_t ir = 0; ir < mcBlock; ir += MR) {
+                  auto ap = bufA.data() + ir * kc;
+                  microKernel(kc, ap, bp, alpha, c, ic + ir, jc + jr,
+                              std::min(MR, mcBlock - ir),
+                              std::min(nr, ncBlock - jr));
+                }
+              }
+            }
+          });
+    }
+  }
+}
@@ -0,0 +1,129 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "common.hpp"
+#include "gemm.hpp"
+
+namespace {
+// Result tile computed by single task.
+constexpr size_t TileSize = 64;
+
+/// Computes covariance (or correlation) matrix of `x` rows. Rows are
+/// de-meaned into packed buffer in single pass, then lower triangle of
+/// Xc * Xc^T is computed tile by tile in parallel. Each tile is scaled and
+/// written to both triangles of the result right away.
+template <typename T>
+void cov_impl(Memref<2, const T> *x, T ddof, bool corr, Memref<2, T> *res) {
+  auto src = getMatrix(x);
+  auto dst = getMatrix(res);
+  auto m = src.rows;
+  auto n = src.cols;
+
+  // numpy floors normalization factor at 0.
+  auto fact = std::max(static_cast<T>(n) - ddof, T(0));
+  auto scale = T(1) / fact;
+
+  std::vector<T> centered(m * n);
+  MatrixView<T> xc{centered.data(), m, n, static_cast<ptrdiff_t>(n), 1};
+  std::vector<T> stddev(corr ? m : 0);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, m),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (auto i = range.begin(); i != range.end(); ++i) {
+                        T sum = 0;
+                        for (size_t j = 0; j < n; ++j)
+                          sum += src(i, j);
+
+                        auto mean = sum / static_cast<T>(n);
+                        T sq = 0;
+                        for (size_t j = 0; j < n; ++j) {
+                          auto val = src(i, j) - mean;
+                          xc(i, j) = val;
+                          sq += val * val;
+                        }
+                        if (corr)
+                          stddev[i] = std::sqrt(sq * scale);
+                      }
+                    });
+
+  // Tiles (ti, tj), tj <= ti, are enumerated row by row.
+  auto numTiles = (m + TileSize - 1) / TileSize;
+  auto numLowerTiles = numTiles * (numTiles + 1) / 2;
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, numLowerTiles),
+      [&](const tbb::blocked_range<size_t> &range) {
+        for (auto p = range.begin(); p != range.end(); ++p) {
+          auto ti = static_cast<size_t>(
+              (std::sqrt(8.0 * static_cast<double>(p) + 1.0) - 1.0) / 2.0);
+          while (ti * (ti + 1) / 2 > p)
+            --ti;
+          while ((ti + 1) * (ti + 2) / 2 <= p)
+            ++ti;
+
+          auto tj = p - ti * (ti + 1) / 2;
+          auto i0 = ti * TileSize;
+          auto j0 = tj * TileSize;
+          auto ib = std::min(TileSize, m - i0);
+          auto jb = std::min(TileSize, m - j0);
+
+          // Tile buffer is not thread local, as thread may pick up another
+          // tile while waiting inside the gemm.
+          std::vector<T> buf(ib * jb);
+          MatrixView<T> tile{buf.data(), ib, jb, static_cast<ptrdiff_t>(jb),
+                             1};
+          gemm<T>(xc.block(i0, 0, ib, n), xc.block(j0, 0, jb, n).transposed(),
+                  tile);
+
+          for (size_t i = 0; i < ib; ++i) {
+            auto gi = i0 + i;
+            for (size_t j = 0; j < jb && j0 + j <= gi; ++j) {
+              auto gj = j0 + j;
+              auto val = tile(i, j) * scale;
+              if (corr)
+                val = std::min(std::max(val / stddev[gi] / stddev[gj], T(-1)),
+                               T(1));
+
+              dst(gi, gj) = val;
+              dst(gj, gi) = val;
+            }
+          }
+        }
+      });
+}
+} // namespace
+
+extern "C" {
+
+#define COV_VARIANT(T, Suff)                                                   \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_cov_##Suff(                           \
+      Memref<2, const T> *x, T ddof, Memref<2, T> *res) {                      \
+    cov_impl(x, ddof, false, res);                                             \
+  }                                                                            \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_corrcoef_##Suff(                      \
+      Memref<2, const T> *x, T ddof, Memref<2, T> *res) {                      \
+    cov_impl(x, ddof, true, res);                                              \
+  }
+
+COV_VARIANT(float, float32)
+COV_VARIANT(double, float64)
+
+#undef COV_VARIANT
+}
@@ -0,0 +1,162 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "common.hpp"
+#include "gemm.hpp"
+
+namespace {
+// Minimal rows count per task for gemv.
+constexpr size_t GemvGrainSize = 64;
+
+/// Computes y = A * x. Row-major A is processed as independent dot products,
+/// otherwise A columns are accumulated into the rows block.
+template <typename T>
+void gemv(MatrixView<const T> a, VectorView<const T> x, VectorView<T> y) {
+  auto m = a.rows;
+  auto k = a.cols;
+  if (a.colStride == 1 && x.stride == 1) {
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m, GemvGrainSize),
+        [&](const tbb::blocked_range<size_t> &range) {
+          constexpr auto nr = NR<T>;
+          for (auto i = range.begin(); i != range.end(); ++i) {
+            auto row = &a(i, 0);
+            // Independent partial sums, so compiler can vectorize the loop.
+            T acc[nr] = {};
+            size_t j = 0;
+            for (; j + nr <= k; j += nr)
+              for (size_t jj = 0; jj < nr; ++jj)
+                acc[jj] += row[j + jj] * x.data[j + jj];
+
+            T res = 0;
+            for (; j < k; ++j)
+              res += row[j] * x.data[j];
+
+            for (size_t jj = 0; jj < nr; ++jj)
+              res += acc[jj];
+
+            y(i) = res;
+          }
+        });
+    return;
+  }
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, m, GemvGrainSize),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (auto i = range.begin(); i != range.end(); ++i)
+                        y(i) = 0;
+
+                      for (size_t j = 0; j < k; ++j) {
+                        auto val = x(j);
+                        for (auto i = range.begin(); i != range.end(); ++i)
+                          y(i) += a(i, j) * val;
+                      }
+                    });
+}
+
+template <typename T>
+void matmul_impl(Memref<2, const T> *a, Memref<2, const T> *b,
+                 Memref<2, T> *c) {
+  if (a->dims[1] != b->dims[0] || c->dims[0] != a->dims[0] ||
+      c->dims[1] != b->dims[1]) {
+    fprintf(stderr, "dpcomp: matmul: shapes (%zu,%zu) and (%zu,%zu) are not "
+                    "aligned\n",
+            a->dims[0], a->dims[1], b->dims[0], b->dims[1]);
+    abort();
+  }
+
+  gemm(getMatrix(a), getMatrix(b), getMatrix(c));
+}
+
+/// Batch dims of size 1 are broadcasted, as in numpy.matmul.
+template <typename T>
+void matmul_batch_impl(Memref<3, const T> *a, Memref<3, const T> *b,
+                       Memref<3, T> *c) {
+  auto batch = c->dims[0];
+  auto isCompatible = [&](size_t dim) { return dim == batch || dim == 1; };
+  if (!isCompatible(a->dims[0]) || !isCompatible(b->dims[0]) ||
+      a->dims[2] != b->dims[1]) {
+    fprintf(stderr,
+            "dpcomp: matmul: shapes (%zu,%zu,%zu) and (%zu,%zu,%zu) are not "
+            "aligned\n",
+            a->dims[0], a->dims[1], a->dims[2], b->dims[0], b->dims[1],
+            b->dims[2]);
+    abort();
+  }
+
+  for (size_t i = 0; i < batch; ++i)
+    gemm(getMatrix(a, a->dims[0] == 1 ? 0 : i),
+         getMatrix(b, b->dims[0] == 1 ? 0 : i), getMatrix(c, i));
+}
+
+template <typename T>
+void matvec_impl(Memref<2, const T> *a, Memref<1, const T> *x,
+                 Memref<1, T> *y) {
+  if (a->dims[1] != x->dims[0] || y->dims[0] != a->dims[0]) {
+    fprintf(stderr,
+            "dpcomp: matmul: shapes (%zu,%zu) and (%zu,) are not aligned\n",
+            a->dims[0], a->dims[1], x->dims[0]);
+    abort();
+  }
+
+  gemv(getMatrix(a), getVector(x), getVector(y));
+}
+
+template <typename T>
+void vecmat_impl(Memref<1, const T> *x, Memref<2, const T> *a,
+                 Memref<1, T> *y) {
+  if (x->dims[0] != a->dims[0] || y->dims[0] != a->dims[1]) {
+    fprintf(stderr,
+            "dpcomp: matmul: shapes (%zu,) and (%zu,%zu) are not aligned\n",
+            x->dims[0], a->dims[0], a->dims[1]);
+    abort();
+  }
+
+  gemv(getMatrix(a).transposed(), getVector(x), getVector(y));
+}
+} // namespace
+
+extern "C" {
+
+#define MATMUL_VARIANT(T, Suff)                                                \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_linalg_matmul_##Suff(                 \
+      Memref<2, const T> *a, Memref<2, const T> *b, Memref<2, T> *c) {         \
+    matmul_impl(a, b, c);                                                      \
+  }                                                                            \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_linalg_matmul_batch_##Suff(           \
+      Memref<3, const T> *a, Memref<3, const T> *b, Memref<3, T> *c) {         \
+    matmul_batch_impl(a, b, c);                                                \
+  }                                                                            \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_linalg_matvec_##Suff(                 \
+      Memref<2, const T> *a, Memref<1, const T> *x, Memref<1, T> *y) {         \
+    matvec_impl(a, x, y);                                                      \
+  }                                                                            \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_linalg_vecmat_##Suff(                 \
+      Memref<1, const T> *x, Memref<2, const T> *a, Memref<1, T> *y) {         \
+    vecmat_impl(x, a, y);                                                      \
+  }
+
+MATMUL_VARIANT(float, float32)
+MATMUL_VARIANT(double, float64)
+
+#undef MATMUL_VARIANT
+}
@@ -12,35 +12,938 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "common.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
-#ifdef DPNP_ENABLE
-#include <dpnp_iface.hpp>
+#ifdef LAPACK_ENABLE
+#include <lapacke.h>
 #endif
 
+#include "common.hpp"
+#include "gemm.hpp"
+
 namespace {
+// Panel width of the blocked factorizations, the trailing matrix is updated
+// with gemm once per panel.
+constexpr size_t NB = 64;
+
+// Minimal rows (or columns) count per task for level 2 updates.
+constexpr size_t GrainSize = 32;
+
+// Minimal columns count per task when applying plane rotations.
+constexpr size_t RotationGrainSize = 256;
+
+constexpr int MaxQLIterations = 30;
+constexpr int MaxJacobiSweeps = 60;
+
+[[noreturn]] void reportError(const char *msg) {
+  fprintf(stderr, "dpcomp: %s\n", msg);
+  abort();
+}
+
+template <typename F> void parallelFor(size_t begin, size_t end, F &&func) {
+  tbb::parallel_for(tbb::blocked_range<size_t>(begin, end, GrainSize),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (auto i = range.begin(); i != range.end(); ++i)
+                        func(i);
+                    });
+}
+
+/// Returns row-major view of the `storage`, which is resized to fit.
 template <typename T>
-void eig_impl(Memref<2, const T> *input, Memref<1, T> *vals,
-              Memref<2, T> *vecs) {
-#ifdef DPNP_ENABLE
-  dpnp_eig_c<T, T>(input->data, vals->data, vecs->data, input->dims[0]);
+MatrixView<T> allocMatrix(std::vector<T> &storage, size_t rows, size_t cols) {
+  storage.resize(rows * cols);
+  return {storage.data(), rows, cols, static_cast<ptrdiff_t>(cols), 1};
+}
+
+template <typename T>
+void copyMatrix(MatrixView<const T> src, MatrixView<T> dst) {
+  parallelFor(0, src.rows, [&](size_t i) {
+    for (size_t j = 0; j < src.cols; ++j)
+      dst(i, j) = src(i, j);
+  });
+}
+
+template <typename T> void setIdentity(MatrixView<T> m) {
+  parallelFor(0, m.rows, [&](size_t i) {
+    for (size_t j = 0; j < m.cols; ++j)
+      m(i, j) = (i == j ? T(1) : T(0));
+  });
+}
+
+#ifdef LAPACK_ENABLE
+#define LAPACK_WRAPPERS(T, P)                                                  \
+  lapack_int gesv(lapack_int n, lapack_int nrhs, T *a, lapack_int lda,         \
+                  lapack_int *ipiv, T *b, lapack_int ldb) {                    \
+    return LAPACKE_##P##gesv(LAPACK_ROW_MAJOR, n, nrhs, a, lda, ipiv, b, ldb); \
+  }                                                                            \
+  lapack_int potrf(lapack_int n, T *a, lapack_int lda) {                       \
+    return LAPACKE_##P##potrf(LAPACK_ROW_MAJOR, 'L', n, a, lda);               \
+  }                                                                            \
+  lapack_int geqrf(lapack_int m, lapack_int n, T *a, lapack_int lda, T *tau) { \
+    return LAPACKE_##P##geqrf(LAPACK_ROW_MAJOR, m, n, a, lda, tau);            \
+  }                                                                            \
+  lapack_int orgqr(lapack_int m, lapack_int n, lapack_int k, T *a,             \
+                   lapack_int lda, const T *tau) {                             \
+    return LAPACKE_##P##orgqr(LAPACK_ROW_MAJOR, m, n, k, a, lda, tau);         \
+  }                                                                            \
+  lapack_int syevd(lapack_int n, T *a, lapack_int lda, T *w) {                 \
+    return LAPACKE_##P##syevd(LAPACK_ROW_MAJOR, 'V', 'L', n, a, lda, w);       \
+  }                                                                            \
+  lapack_int gelsd(lapack_int m, lapack_int n, lapack_int nrhs, T *a,          \
+                   lapack_int lda, T *b, lapack_int ldb, T *s, T rcond,        \
+                   lapack_int *rank) {                                         \
+    return LAPACKE_##P##gelsd(LAPACK_ROW_MAJOR, m, n, nrhs, a, lda, b, ldb, s, \
+                              rcond, rank);                                    \
+  }
+
+LAPACK_WRAPPERS(float, s)
+LAPACK_WRAPPERS(double, d)
+
+#undef LAPACK_WRAPPERS
+
+template <typename T> lapack_int getLd(MatrixView<T> m) {
+  return static_cast<lapack_int>(std::max<ptrdiff_t>(m.rowStride, 1));
+}
+#endif
+
+/// Solves L * X = B for lower triangular L, X overwrites B. Diagonal blocks
+/// are solved in parallel over B columns, the rest of B is updated with gemm.
+template <typename T>
+void solveLower(MatrixView<const T> l, MatrixView<T> b, bool unitDiag) {
+  auto n = l.rows;
+  for (size_t k0 = 0; k0 < n; k0 += NB) {
+    auto nb = std::min(NB, n - k0);
+    parallelFor(0, b.cols, [&](size_t j) {
+      for (auto i = k0; i < k0 + nb; ++i) {
+        auto val = b(i, j);
+        for (auto k = k0; k < i; ++k)
+          val -= l(i, k) * b(k, j);
+
+        b(i, j) = (unitDiag ? val : val / l(i, i));
+      }
+    });
+
+    auto rest = n - k0 - nb;
+    if (rest != 0)
+      gemm<T>(l.block(k0 + nb, k0, rest, nb), b.block(k0, 0, nb, b.cols),
+              b.block(k0 + nb, 0, rest, b.cols), T(-1), T(1));
+  }
+}
+
+/// Solves U * X = B for upper triangular U, X overwrites B.
+template <typename T> void solveUpper(MatrixView<const T> u, MatrixView<T> b) {
+  auto n = u.rows;
+  auto numBlocks = (n + NB - 1) / NB;
+  for (auto kb = numBlocks; kb-- > 0;) {
+    auto k0 = kb * NB;
+    auto nb = std::min(NB, n - k0);
+    parallelFor(0, b.cols, [&](size_t j) {
+      for (auto i = k0 + nb; i-- > k0;) {
+        auto val = b(i, j);
+        for (auto k = i + 1; k < k0 + nb; ++k)
+          val -= u(i, k) * b(k, j);
+
+        b(i, j) = val / u(i, i);
+      }
+    });
+
+    if (k0 != 0)
+      gemm<T>(u.block(0, k0, k0, nb), b.block(k0, 0, nb, b.cols),
+              b.block(0, 0, k0, b.cols), T(-1), T(1));
+  }
+}
+
+/// Blocked right-looking LU factorization with partial pivoting, unit lower
+/// L and U overwrite `a`, row i was swapped with row `piv[i]`. Returns false
+/// if matrix is singular.
+template <typename T>
+bool factorizeLU(MatrixView<T> a, std::vector<size_t> &piv) {
+  auto n = a.rows;
+  piv.resize(n);
+  for (size_t k0 = 0; k0 < n; k0 += NB) {
+    auto panelEnd = std::min(k0 + NB, n);
+    for (auto k = k0; k < panelEnd; ++k) {
+      auto p = k;
+      for (auto i = k + 1; i < n; ++i)
+        if (std::abs(a(i, k)) > std::abs(a(p, k)))
+          p = i;
+
+      piv[k] = p;
+      if (a(p, k) == T(0))
+        return false;
+
+      if (p != k)
+        for (size_t j = 0; j < n; ++j)
+          std::swap(a(k, j), a(p, j));
+
+      auto inv = T(1) / a(k, k);
+      parallelFor(k + 1, n, [&](size_t i) {
+        auto l = (a(i, k) *= inv);
+        for (auto j = k + 1; j < panelEnd; ++j)
+          a(i, j) -= l * a(k, j);
+      });
+    }
+
+    auto rest = n - panelEnd;
+    if (rest == 0)
+      break;
+
+    // U12 = L11^-1 * A12, A22 -= L21 * U12.
+    auto nb = panelEnd - k0;
+    auto a12 = a.block(k0, panelEnd, nb, rest);
+    solveLower<T>(a.block(k0, k0, nb, nb), a12, /*unitDiag*/ true);
+    gemm<T>(a.block(panelEnd, k0, rest, nb), a12,
+            a.block(panelEnd, panelEnd, rest, rest), T(-1), T(1));
+  }
+  return true;
+}
+
+/// Solves A * X = B, A is destroyed and X overwrites B. Returns false if A is
+/// singular.
+template <typename T> bool solveSystem(MatrixView<T> a, MatrixView<T> b) {
+#ifdef LAPACK_ENABLE
+  std::vector<lapack_int> ipiv(a.rows);
+  return gesv(static_cast<lapack_int>(a.rows), static_cast<lapack_int>(b.cols),
+              a.data, getLd(a), ipiv.data(), b.data, getLd(b)) == 0;
 #else
-  // direct MKL call or another implementation?
-  abort();
+  std::vector<size_t> piv;
+  if (!factorizeLU(a, piv))
+    return false;
+
+  for (size_t i = 0; i < piv.size(); ++i)
+    if (piv[i] != i)
+      for (size_t j = 0; j < b.cols; ++j)
+        std::swap(b(i, j), b(piv[i], j));
+
+  solveLower<T>(a, b, /*unitDiag*/ true);
+  solveUpper<T>(a, b);
+  return true;
+#endif
+}
+
+/// Blocked right-looking Cholesky factorization, only the lower triangle of
+/// `a` is referenced and is overwritten by L. Returns false if matrix is not
+/// positive definite.
+template <typename T> bool factorizeCholesky(MatrixView<T> a) {
+#ifdef LAPACK_ENABLE
+  return potrf(static_cast<lapack_int>(a.rows), a.data, getLd(a)) == 0;
+#else
+  auto n = a.rows;
+  for (size_t k0 = 0; k0 < n; k0 += NB) {
+    auto panelEnd = std::min(k0 + NB, n);
+    for (auto j = k0; j < panelEnd; ++j) {
+      auto d = a(j, j);
+      for (auto k = k0; k < j; ++k)
+        d -= a(j, k) * a(j, k);
+
+      if (!(d > T(0)))
+        return false;
+
+      d = std::sqrt(d);
+      a(j, j) = d;
+      for (auto i = j + 1; i < panelEnd; ++i) {
+        auto val = a(i, j);
+        for (auto k = k0; k < j; ++k)
+          val -= a(i, k) * a(j, k);
+
+        a(i, j) = val / d;
+      }
+    }
+
+    auto rest = n - panelEnd;
+    if (rest == 0)
+      break;
+
+    // L21 = A21 * L11^-T, A22 -= L21 * L21^T.
+    auto nb = panelEnd - k0;
+    auto l21 = a.block(panelEnd, k0, rest, nb);
+    solveLower<T>(a.block(k0, k0, nb, nb), l21.transposed(),
+                  /*unitDiag*/ false);
+    gemm<T>(l21, l21.transposed(), a.block(panelEnd, panelEnd, rest, rest),
+            T(-1), T(1));
+  }
+  return true;
+#endif
+}
+
+/// Generates elementary reflector H = I - tau * v * v^T, such that
+/// H * x = (beta, 0, ..., 0). v[0] = 1 is implicit, v[1:] overwrites x[1:]
+/// and beta overwrites x[0]. Returns tau.
+template <typename T> T householder(VectorView<T> x) {
+  T scale = 0;
+  for (size_t i = 1; i < x.size; ++i)
+    scale = std::max(scale, std::abs(x(i)));
+
+  if (scale == T(0))
+    return T(0);
+
+  T sum = 0;
+  for (size_t i = 1; i < x.size; ++i) {
+    auto val = x(i) / scale;
+    sum += val * val;
+  }
+
+  auto alpha = x(0);
+  auto beta = -std::copysign(std::hypot(alpha, scale * std::sqrt(sum)), alpha);
+  auto mult = T(1) / (alpha - beta);
+  for (size_t i = 1; i < x.size; ++i)
+    x(i) *= mult;
+
+  x(0) = beta;
+  return (beta - alpha) / beta;
+}
+
+/// Applies H = I - tau * v * v^T to `c` from the left, v[0] = 1 is implicit.
+template <typename T>
+void applyReflector(VectorView<const T> v, T tau, MatrixView<T> c) {
+  if (tau == T(0))
+    return;
+
+  parallelFor(0, c.cols, [&](size_t j) {
+    auto s = c(0, j);
+    for (size_t i = 1; i < c.rows; ++i)
+      s += v(i) * c(i, j);
+
+    s *= tau;
+    c(0, j) -= s;
+    for (size_t i = 1; i < c.rows; ++i)
+      c(i, j) -= s * v(i);
+  });
+}
+
+/// Forms block reflector H_0 * H_1 * ... = I - V * T * V^T for reflectors
+/// stored below the diagonal of `a`, V is unit lower trapezoidal and T is
+/// upper triangular.
+template <typename T>
+void formBlockReflector(MatrixView<const T> a, const T *tau, MatrixView<T> v,
+                        MatrixView<T> t) {
+  auto nb = a.cols;
+  parallelFor(0, a.rows, [&](size_t i) {
+    for (size_t j = 0; j < nb; ++j)
+      v(i, j) = (i > j ? a(i, j) : (i == j ? T(1) : T(0)));
+  });
+
+  // T[0:i, i] = -tau[i] * T[0:i, 0:i] * V[:, 0:i]^T * V[:, i], products of V
+  // columns are computed with single gemm.
+  gemm<T>(v.transposed(), v, t);
+  std::vector<T> w(nb);
+  for (size_t i = 0; i < nb; ++i) {
+    for (size_t j = 0; j < i; ++j)
+      w[j] = -tau[i] * t(j, i);
+
+    for (size_t j = 0; j < i; ++j) {
+      T val = 0;
+      for (auto l = j; l < i; ++l)
+        val += t(j, l) * w[l];
+
+      t(j, i) = val;
+    }
+    t(i, i) = tau[i];
+    for (auto j = i + 1; j < nb; ++j)
+      t(j, i) = 0;
+  }
+}
+
+/// Applies block reflector H = I - V * T * V^T (or H^T) to `c` from the left.
+template <typename T>
+void applyBlockReflector(MatrixView<const T> v, MatrixView<const T> t,
+                         MatrixView<T> c, bool transpose) {
+  std::vector<T> buf1;
+  std::vector<T> buf2;
+  auto w = allocMatrix(buf1, v.cols, c.cols);
+  auto tw = allocMatrix(buf2, v.cols, c.cols);
+  gemm<T>(v.transposed(), c, w);
+  gemm<T>(transpose ? t.transposed() : t, w, tw);
+  gemm<T>(v, tw, c, T(-1), T(1));
+}
+
+/// Blocked Householder QR factorization, R overwrites the upper triangle of
+/// `a` and reflectors are stored below the diagonal. Reflectors are applied
+/// to the rest of the panel one by one and to the trailing matrix once per
+/// panel as block reflector.
+template <typename T> void factorizeQR(MatrixView<T> a, T *tau) {
+  auto m = a.rows;
+  auto n = a.cols;
+  auto k = std::min(m, n);
+  std::vector<T> vBuf;
+  std::vector<T> tBuf;
+  for (size_t j0 = 0; j0 < k; j0 += NB) {
+    auto panelEnd = std::min(j0 + NB, k);
+    for (auto j = j0; j < panelEnd; ++j) {
+      VectorView<T> x{&a(j, j), m - j, a.rowStride};
+      tau[j] = householder(x);
+      applyReflector(VectorView<const T>{x.data, x.size, x.stride}, tau[j],
+                     a.block(j, j + 1, m - j, panelEnd - j - 1));
+    }
+
+    if (panelEnd < n) {
+      auto nb = panelEnd - j0;
+      auto v = allocMatrix(vBuf, m - j0, nb);
+      auto t = allocMatrix(tBuf, nb, nb);
+      formBlockReflector<T>(a.block(j0, j0, m - j0, nb), tau + j0, v, t);
+      applyBlockReflector<T>(v, t, a.block(j0, panelEnd, m - j0, n - panelEnd),
+                             /*transpose*/ true);
+    }
+  }
+}
+
+/// Computes Q = H_0 * ... * H_{k-1} * I[:, 0:q.cols] for `k` reflectors
+/// stored below the diagonal of `a` by `factorizeQR`.
+template <typename T>
+void formQ(MatrixView<const T> a, const T *tau, size_t k, MatrixView<T> q) {
+  auto m = q.rows;
+  setIdentity(q);
+  std::vector<T> vBuf;
+  std::vector<T> tBuf;
+  auto numBlocks = (k + NB - 1) / NB;
+  for (auto kb = numBlocks; kb-- > 0;) {
+    auto j0 = kb * NB;
+    auto nb = std::min(NB, k - j0);
+    auto v = allocMatrix(vBuf, m - j0, nb);
+    auto t = allocMatrix(tBuf, nb, nb);
+    formBlockReflector<T>(a.block(j0, j0, m - j0, nb), tau + j0, v, t);
+    applyBlockReflector<T>(v, t, q.block(j0, j0, m - j0, q.cols - j0),
+                           /*transpose*/ false);
+  }
+}
+
+/// Computes reduced QR decomposition, `a` is overwritten by R in its upper
+/// triangle and `q` receives first min(m, n) columns of Q.
+template <typename T> void decomposeQR(MatrixView<T> a, MatrixView<T> q) {
+  auto k = q.cols;
+  std::vector<T> tau(k);
+#ifdef LAPACK_ENABLE
+  geqrf(static_cast<lapack_int>(a.rows), static_cast<lapack_int>(a.cols),
+        a.data, getLd(a), tau.data());
+  copyMatrix<T>(a.block(0, 0, a.rows, k), q);
+  orgqr(static_cast<lapack_int>(q.rows), static_cast<lapack_int>(k),
+        static_cast<lapack_int>(k), q.data, getLd(q), tau.data());
+#else
+  factorizeQR(a, tau.data());
+  formQ<T>(a, tau.data(), k, q);
+#endif
+}
+
+/// Reduces symmetric `a` to tridiagonal T = Q^T * A * Q with Householder
+/// reflectors, `d` and `e` receive diagonal and subdiagonal of T. Reflectors
+/// are stored below the subdiagonal of `a`, as for QR of `a[1:, :]`.
+template <typename T>
+void tridiagonalize(MatrixView<T> a, T *d, T *e, T *tau) {
+  auto n = a.rows;
+  std::vector<T> p(n);
+  std::vector<T> w(n);
+  for (size_t k = 0; k + 2 < n; ++k) {
+    auto r = n - k - 1;
+    VectorView<T> x{&a(k + 1, k), r, a.rowStride};
+    auto t = householder(x);
+    tau[k] = t;
+    d[k] = a(k, k);
+    e[k] = x(0);
+    if (t == T(0))
+      continue;
+
+    // A22 = H * A22 * H = A22 - v * w^T - w * v^T, where p = tau * A22 * v
+    // and w = p - tau / 2 * (p^T * v) * v.
+    auto v = [&](size_t i) { return i == 0 ? T(1) : x(i); };
+    auto a22 = a.block(k + 1, k + 1, r, r);
+    parallelFor(0, r, [&](size_t i) {
+      T s = 0;
+      for (size_t j = 0; j < r; ++j)
+        s += a22(i, j) * v(j);
+
+      p[i] = t * s;
+    });
+
+    T pv = 0;
+    for (size_t i = 0; i < r; ++i)
+      pv += p[i] * v(i);
+
+    auto alpha = -t / 2 * pv;
+    for (size_t i = 0; i < r; ++i)
+      w[i] = p[i] + alpha * v(i);
+
+    parallelFor(0, r, [&](size_t i) {
+      auto vi = v(i);
+      auto wi = w[i];
+      for (size_t j = 0; j < r; ++j)
+        a22(i, j) -= vi * w[j] + wi * v(j);
+    });
+  }
+
+  if (n >= 2) {
+    d[n - 2] = a(n - 2, n - 2);
+    e[n - 2] = a(n - 1, n - 2);
+  }
+  if (n >= 1) {
+    d[n - 1] = a(n - 1, n - 1);
+    e[n - 1] = 0;
+  }
+}
+
+/// Computes eigenvalues of symmetric tridiagonal matrix with implicit QL
+/// iterations, as EISPACK tql2 does. Plane rotations of each iteration are
+/// applied to the rows of `z` in parallel over columns. Returns false if some
+/// eigenvalue did not converge.
+template <typename T> bool tridiagonalQL(T *d, T *e, MatrixView<T> z) {
+  auto n = z.rows;
+  auto eps = std::numeric_limits<T>::epsilon();
+  std::vector<T> rotations(2 * n);
+  T f = 0;
+  T tst1 = 0;
+  for (size_t l = 0; l < n; ++l) {
+    tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+    auto m = l;
+    while (m + 1 < n && std::abs(e[m]) > eps * tst1)
+      ++m;
+
+    if (m > l) {
+      int iter = 0;
+      do {
+        if (++iter > MaxQLIterations)
+          return false;
+
+        auto g = d[l];
+        auto p = (d[l + 1] - g) / (2 * e[l]);
+        auto r = std::copysign(std::hypot(p, T(1)), p);
+        d[l] = e[l] / (p + r);
+        d[l + 1] = e[l] * (p + r);
+        auto dl1 = d[l + 1];
+        auto h = g - d[l];
+        for (auto i = l + 2; i < n; ++i)
+          d[i] -= h;
+
+        f += h;
+        p = d[m];
+        T c = 1;
+        T c2 = 1;
+        T c3 = 1;
+        auto el1 = e[l + 1];
+        T s = 0;
+        T s2 = 0;
+        for (auto i = m; i-- > l;) {
+          c3 = c2;
+          c2 = c;
+          s2 = s;
+          g = c * e[i];
+          h = c * p;
+          r = std::hypot(p, e[i]);
+          e[i + 1] = s * r;
+          s = e[i] / r;
+          c = p / r;
+          p = c * d[i] - s * g;
+          d[i + 1] = h + s * (c * g + s * d[i]);
+          rotations[2 * i] = c;
+          rotations[2 * i + 1] = s;
+        }
+
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, z.cols, RotationGrainSize),
+            [&](const tbb::blocked_range<size_t> &range) {
+              for (auto i = m; i-- > l;) {
+                auto rc = rotations[2 * i];
+                auto rs = rotations[2 * i + 1];
+                for (auto k = range.begin(); k != range.end(); ++k) {
+                  auto val = z(i + 1, k);
+                  z(i + 1, k) = rs * z(i, k) + rc * val;
+                  z(i, k) = rc * z(i, k) - rs * val;
+                }
+              }
+            });
+
+        p = -s * s2 * c3 * el1 * e[l] / dl1;
+        e[l] = s * p;
+        d[l] = c * p;
+      } while (std::abs(e[l]) > eps * tst1);
+    }
+    d[l] += f;
+    e[l] = 0;
+  }
+  return true;
+}
+
+/// Computes eigenvalues (ascending) and eigenvectors (columns of `vecs`) of
+/// symmetric `a`, only the lower triangle is referenced. `a` is destroyed.
+/// Returns false if eigenvalues did not converge.
+template <typename T>
+bool symmetricEigen(MatrixView<T> a, VectorView<T> vals, MatrixView<T> vecs) {
+  auto n = a.rows;
+#ifdef LAPACK_ENABLE
+  std::vector<T> w(n);
+  if (syevd(static_cast<lapack_int>(n), a.data, getLd(a), w.data()) != 0)
+    return false;
+
+  for (size_t i = 0; i < n; ++i)
+    vals(i) = w[i];
+
+  copyMatrix<T>(a, vecs);
+  return true;
+#else
+  // Reduction works on the full matrix.
+  parallelFor(0, n, [&](size_t i) {
+    for (size_t j = 0; j < i; ++j)
+      a(j, i) = a(i, j);
+  });
+
+  std::vector<T> d(n);
+  std::vector<T> e(n);
+  std::vector<T> tau(n);
+  tridiagonalize(a, d.data(), e.data(), tau.data());
+
+  // Q = diag(1, Q1), eigenvectors are accumulated into rows of Z = Q^T, so
+  // rotations are applied to the contiguous memory.
+  std::vector<T> qBuf;
+  auto q = allocMatrix(qBuf, n, n);
+  setIdentity(q);
+  if (n > 2)
+    formQ<T>(a.block(1, 0, n - 1, n - 2), tau.data(), n - 2,
+             q.block(1, 1, n - 1, n - 1));
+
+  std::vector<T> zBuf;
+  auto z = allocMatrix(zBuf, n, n);
+  copyMatrix<T>(q.transposed(), z);
+  if (!tridiagonalQL(d.data(), e.data(), z))
+    return false;
+
+  std::vector<size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t i, size_t j) { return d[i] < d[j]; });
+  for (size_t j = 0; j < n; ++j)
+    vals(j) = d[order[j]];
+
+  parallelFor(0, n, [&](size_t i) {
+    for (size_t j = 0; j < n; ++j)
+      vecs(i, j) = z(order[j], i);
+  });
+  return true;
 #endif
 }
+
+/// One-sided Jacobi SVD, rows of `g` are orthogonalized by plane rotations,
+/// which are accumulated into rows of `w` (must be identity initially). So
+/// G^T = U * S * W^T, where S are norms of `g` rows. Row pairs are visited in
+/// round-robin order, rotations within each round are independent and are
+/// done in parallel. Returns false if not converged.
+template <typename T> bool jacobiSVD(MatrixView<T> g, MatrixView<T> w) {
+  auto p = g.rows;
+  auto tol = std::numeric_limits<T>::epsilon() *
+             std::sqrt(static_cast<T>(std::max<size_t>(g.cols, 1)));
+  // Odd rows count is padded with dummy slot.
+  auto numSlots = p + p % 2;
+  std::vector<size_t> slots(numSlots);
+  std::iota(slots.begin(), slots.end(), 0);
+
+  auto rotate = [](MatrixView<T> m, size_t i, size_t j, T c, T s) {
+    for (size_t k = 0; k < m.cols; ++k) {
+      auto vi = m(i, k);
+      auto vj = m(j, k);
+      m(i, k) = c * vi - s * vj;
+      m(j, k) = s * vi + c * vj;
+    }
+  };
+
+  for (int sweep = 0; sweep < MaxJacobiSweeps; ++sweep) {
+    std::atomic<bool> rotated(false);
+    for (size_t round = 0; round + 1 < numSlots; ++round) {
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, numSlots / 2),
+          [&](const tbb::blocked_range<size_t> &range) {
+            for (auto pair = range.begin(); pair != range.end(); ++pair) {
+              auto i = slots[pair];
+              auto j = slots[numSlots - 1 - pair];
+              if (i >= p || j >= p)
+                continue;
+
+              T alpha = 0;
+              T beta = 0;
+              T gamma = 0;
+              for (size_t k = 0; k < g.cols; ++k) {
+                alpha += g(i, k) * g(i, k);
+                beta += g(j, k) * g(j, k);
+                gamma += g(i, k) * g(j, k);
+              }
+              if (std::abs(gamma) <= tol * std::sqrt(alpha * beta))
+                continue;
+
+              rotated.store(true, std::memory_order_relaxed);
+              auto zeta = (beta - alpha) / (2 * gamma);
+              auto t = std::copysign(T(1), zeta) /
+                       (std::abs(zeta) + std::hypot(T(1), zeta));
+              auto c = T(1) / std::sqrt(1 + t * t);
+              auto s = c * t;
+              rotate(g, i, j, c, s);
+              rotate(w, i, j, c, s);
+            }
+          });
+
+      // First slot is fixed, the rest are shifted by one.
+      std::rotate(slots.begin() + 1, slots.end() - 1, slots.end());
+    }
+    if (!rotated.load())
+      return true;
+  }
+  return false;
+}
+
+/// Computes minimal norm solution of min ||A * X - B||, `s` receives singular
+/// values of A in descending order. Singular values below `rcond` times the
+/// largest one are treated as zero, negative `rcond` means machine precision
+/// times max(m, n). Returns false if SVD did not converge.
+template <typename T>
+bool leastSquares(MatrixView<const T> a, MatrixView<const T> b, T rcond,
+                  MatrixView<T> x, VectorView<T> s, int64_t &rank) {
+  auto m = a.rows;
+  auto n = a.cols;
+  auto k = std::min(m, n);
+  auto nrhs = b.cols;
+  if (rcond < T(0))
+    rcond = std::numeric_limits<T>::epsilon() * static_cast<T>(std::max(m, n));
+
+#ifdef LAPACK_ENABLE
+  std::vector<T> aBuf;
+  std::vector<T> bBuf;
+  std::vector<T> sv(k);
+  auto aCopy = allocMatrix(aBuf, m, n);
+  auto bCopy = allocMatrix(bBuf, std::max(m, n), nrhs);
+  copyMatrix<T>(a, aCopy);
+  copyMatrix<T>(b, bCopy);
+  lapack_int lapackRank = 0;
+  if (gelsd(static_cast<lapack_int>(m), static_cast<lapack_int>(n),
+            static_cast<lapack_int>(nrhs), aCopy.data, getLd(aCopy),
+            bCopy.data, getLd(bCopy), sv.data(), rcond, &lapackRank) != 0)
+    return false;
+
+  copyMatrix<T>(bCopy.block(0, 0, n, nrhs), x);
+  for (size_t i = 0; i < k; ++i)
+    s(i) = sv[i];
+
+  rank = lapackRank;
+  return true;
+#else
+  // Rows of G are columns of A for tall A and rows of A for wide one, so
+  // A = U * S * W^T or A = W * S * U^T respectively.
+  bool tall = (m >= n);
+  std::vector<T> gBuf;
+  std::vector<T> wBuf;
+  auto g = allocMatrix(gBuf, k, tall ? m : n);
+  auto w = allocMatrix(wBuf, k, k);
+  copyMatrix<T>(tall ? a.transposed() : a, g);
+  setIdentity(w);
+  if (!jacobiSVD(g, w))
+    return false;
+
+  std::vector<T> sv(k);
+  parallelFor(0, k, [&](size_t i) {
+    T sum = 0;
+    for (size_t j = 0; j < g.cols; ++j)
+      sum += g(i, j) * g(i, j);
+
+    sv[i] = std::sqrt(sum);
+  });
+
+  std::vector<size_t> order(k);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t i, size_t j) { return sv[i] > sv[j]; });
+  for (size_t i = 0; i < k; ++i)
+    s(i) = sv[order[i]];
+
+  auto cutoff = (k == 0 ? T(0) : rcond * sv[order[0]]);
+  rank = std::count_if(sv.begin(), sv.end(),
+                       [&](T val) { return val > cutoff; });
+
+  // X = R^T * S^-2 * P * B, where P and R are G and W (or vice versa), rows
+  // of G are not normalized, hence S^-2.
+  auto proj = (tall ? g : w);
+  auto back = (tall ? w : g);
+  std::vector<T> cBuf;
+  auto c = allocMatrix(cBuf, k, nrhs);
+  gemm<T>(proj, b, c);
+  parallelFor(0, k, [&](size_t i) {
+    auto scale = (sv[i] > cutoff ? T(1) / (sv[i] * sv[i]) : T(0));
+    for (size_t j = 0; j < nrhs; ++j)
+      c(i, j) *= scale;
+  });
+  gemm<T>(back.transposed(), c, x);
+  return true;
+#endif
+}
+
+template <typename T>
+void solve_impl(Memref<2, const T> *a, Memref<2, const T> *b,
+                Memref<2, T> *x) {
+  auto n = a->dims[0];
+  std::vector<T> luBuf;
+  std::vector<T> xBuf;
+  auto lu = allocMatrix(luBuf, n, n);
+  auto res = allocMatrix(xBuf, n, b->dims[1]);
+  copyMatrix(getMatrix(a), lu);
+  copyMatrix(getMatrix(b), res);
+  if (n != 0 && res.cols != 0 && !solveSystem(lu, res))
+    reportError("Singular matrix");
+
+  copyMatrix<T>(res, getMatrix(x));
+}
+
+template <typename T> void inv_impl(Memref<2, const T> *a, Memref<2, T> *res) {
+  auto n = a->dims[0];
+  std::vector<T> luBuf;
+  std::vector<T> invBuf;
+  auto lu = allocMatrix(luBuf, n, n);
+  auto inv = allocMatrix(invBuf, n, n);
+  copyMatrix(getMatrix(a), lu);
+  setIdentity(inv);
+  if (n != 0 && !solveSystem(lu, inv))
+    reportError("Singular matrix");
+
+  copyMatrix<T>(inv, getMatrix(res));
+}
+
+template <typename T>
+void cholesky_impl(Memref<2, const T> *a, Memref<2, T> *res) {
+  auto n = a->dims[0];
+  std::vector<T> buf;
+  auto l = allocMatrix(buf, n, n);
+  copyMatrix(getMatrix(a), l);
+  if (n != 0 && !factorizeCholesky(l))
+    reportError("Matrix is not positive definite");
+
+  auto dst = getMatrix(res);
+  parallelFor(0, n, [&](size_t i) {
+    for (size_t j = 0; j < n; ++j)
+      dst(i, j) = (j <= i ? l(i, j) : T(0));
+  });
+}
+
+template <typename T>
+void qr_impl(Memref<2, const T> *a, Memref<2, T> *q, Memref<2, T> *r) {
+  auto m = a->dims[0];
+  auto n = a->dims[1];
+  auto k = std::min(m, n);
+  std::vector<T> aBuf;
+  std::vector<T> qBuf;
+  auto work = allocMatrix(aBuf, m, n);
+  auto qWork = allocMatrix(qBuf, m, k);
+  copyMatrix(getMatrix(a), work);
+  if (k != 0)
+    decomposeQR(work, qWork);
+
+  copyMatrix<T>(qWork, getMatrix(q));
+  auto dst = getMatrix(r);
+  parallelFor(0, k, [&](size_t i) {
+    for (size_t j = 0; j < n; ++j)
+      dst(i, j) = (j >= i ? work(i, j) : T(0));
+  });
+}
+
+template <typename T>
+void eigh_impl(Memref<2, const T> *input, Memref<1, T> *vals,
+               Memref<2, T> *vecs) {
+  auto n = input->dims[0];
+  std::vector<T> buf;
+  auto a = allocMatrix(buf, n, n);
+  copyMatrix(getMatrix(input), a);
+  if (!symmetricEigen(a, getVector(vals), getMatrix(vecs)))
+    reportError("Eigenvalues did not converge");
+}
+
+template <typename T>
+void eig_impl(Memref<2, const T> *input, Memref<1, T> *vals,
+              Memref<2, T> *vecs) {
+  // Complex results are not supported, only symmetric input, which has real
+  // eigenvalues, is handled by the symmetric solver.
+  auto a = getMatrix(input);
+  for (size_t i = 0; i < a.rows; ++i)
+    for (size_t j = 0; j < i; ++j)
+      if (a(i, j) != a(j, i))
+        reportError("eig is only supported for symmetric matrices");
+
+  eigh_impl(input, vals, vecs);
+}
+
+template <typename T>
+void lstsq_impl(Memref<2, const T> *a, Memref<2, const T> *b, T rcond,
+                Memref<2, T> *x, Memref<1, T> *residuals,
+                Memref<1, int64_t> *rank, Memref<1, T> *s) {
+  auto m = a->dims[0];
+  auto n = a->dims[1];
+  auto nrhs = b->dims[1];
+  std::vector<T> xBuf;
+  auto res = allocMatrix(xBuf, n, nrhs);
+  int64_t resRank = 0;
+  if (!leastSquares(getMatrix(a), getMatrix(b), rcond, res, getVector(s),
+                    resRank))
+    reportError("SVD did not converge in Linear Least Squares");
+
+  copyMatrix<T>(res, getMatrix(x));
+  rank->data[rank->offset] = resRank;
+
+  // Residuals are only returned for overdetermined systems.
+  if (residuals->dims[0] == 0)
+    return;
+
+  std::vector<T> rBuf;
+  auto diff = allocMatrix(rBuf, m, nrhs);
+  copyMatrix(getMatrix(b), diff);
+  gemm<T>(getMatrix(a), res, diff, T(-1), T(1));
+  auto dst = getVector(residuals);
+  for (size_t j = 0; j < nrhs; ++j) {
+    T sum = 0;
+    for (size_t i = 0; i < m; ++i)
+      sum += diff(i, j) * diff(i, j);
+
+    dst(j) = sum;
+  }
+}
 } // namespace
 
 extern "C" {
 
-#define EIG_VARIANT(T, Suff)                                                   \
+#define LINALG_VARIANT(T, Suff)                                                \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_linalg_solve_##Suff(                  \
+      Memref<2, const T> *a, Memref<2, const T> *b, Memref<2, T> *x) {         \
+    solve_impl(a, b, x);                                                       \
+  }                                                                            \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_linalg_inv_##Suff(                    \
+      Memref<2, const T> *a, Memref<2, T> *res) {                              \
+    inv_impl(a, res);                                                          \
+  }                                                                            \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_linalg_cholesky_##Suff(               \
+      Memref<2, const T> *a, Memref<2, T> *res) {                              \
+    cholesky_impl(a, res);                                                     \
+  }                                                                            \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_linalg_qr_##Suff(                     \
+      Memref<2, const T> *a, Memref<2, T> *q, Memref<2, T> *r) {               \
+    qr_impl(a, q, r);                                                          \
+  }                                                                            \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_linalg_eigh_##Suff(                   \
+      Memref<2, const T> *input, Memref<1, T> *vals, Memref<2, T> *vecs) {     \
+    eigh_impl(input, vals, vecs);                                              \
+  }                                                                            \
   DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_linalg_eig_##Suff(                    \
       Memref<2, const T> *input, Memref<1, T> *vals, Memref<2, T> *vecs) {     \
     eig_impl(input, vals, vecs);                                               \
+  }                                                                            \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_linalg_lstsq_##Suff(                  \
+      Memref<2, const T> *a, Memref<2, const T> *b, T rcond, Memref<2, T> *x,  \
+      Memref<1, T> *residuals, Memref<1, int64_t> *rank, Memref<1, T> *s) {    \
+    lstsq_impl(a, b, rcond, x, residuals, rank, s);                            \
   }
 
-EIG_VARIANT(float, float32)
-EIG_VARIANT(double, float64)
+LINALG_VARIANT(float, float32)
+LINALG_VARIANT(double, float64)
 
-#undef EIG_VARIANT
+#undef LINALG_VARIANT
 }
@@ -0,0 +1,185 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include "common.hpp"
+
+namespace {
+template <typename T> struct LineView {
+  T *data;
+  size_t size;
+  ptrdiff_t stride;
+
+  T &operator()(size_t i) const {
+    return data[static_cast<ptrdiff_t>(i) * stride];
+  }
+};
+
+// Lines shorter than this are scanned sequentially, parallelizing over lines.
+constexpr size_t MinParallelScanSize = 1 << 15;
+
+// Blocks per thread for the blocked scan, to balance the load.
+constexpr size_t BlocksPerThread = 4;
+
+template <typename T, typename Op>
+void scanSeq(LineView<const T> src, LineView<T> dst, size_t begin, size_t end,
+             T init, Op op) {
+  auto acc = init;
+  for (auto i = begin; i < end; ++i) {
+    acc = op(acc, src(i));
+    dst(i) = acc;
+  }
+}
+
+/// Two pass blocked scan. Line is split into blocks, first pass computes
+/// total of each block in parallel, then block totals are scanned
+/// sequentially, second pass scans each block starting from the total of the
+/// preceding blocks in parallel.
+template <typename T, typename Op>
+void scanParallel(LineView<const T> src, LineView<T> dst, T identity, Op op) {
+  auto n = src.size;
+  auto numThreads =
+      static_cast<size_t>(std::max(tbb::this_task_arena::max_concurrency(), 1));
+  auto numBlocks = std::min(numThreads * BlocksPerThread,
+                            (n + MinParallelScanSize / BlocksPerThread - 1) /
+                                (MinParallelScanSize / BlocksPerThread));
+  auto blockSize = (n + numBlocks - 1) / numBlocks;
+  numBlocks = (n + blockSize - 1) / blockSize;
+
+  std::vector<T> totals(numBlocks, identity);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks - 1),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (auto b = range.begin(); b != range.end(); ++b) {
+                        auto acc = identity;
+                        auto end = std::min(n, (b + 1) * blockSize);
+                        for (auto i = b * blockSize; i < end; ++i)
+                          acc = op(acc, src(i));
+
+                        totals[b + 1] = acc;
+                      }
+                    });
+
+  for (size_t b = 1; b < numBlocks; ++b)
+    totals[b] = op(totals[b - 1], totals[b]);
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (auto b = range.begin(); b != range.end(); ++b)
+                        scanSeq(src, dst, b * blockSize,
+                                std::min(n, (b + 1) * blockSize), totals[b],
+                                op);
+                    });
+}
+
+template <typename T> LineView<T> getLine(Memref<3, T> *src, size_t line) {
+  auto inner = src->dims[2];
+  auto o = line / inner;
+  auto i = line % inner;
+  auto data = src->data + src->offset +
+              static_cast<ptrdiff_t>(o * src->strides[0]) +
+              static_cast<ptrdiff_t>(i * src->strides[2]);
+  return {data, src->dims[1], static_cast<ptrdiff_t>(src->strides[1])};
+}
+
+/// Scans `src` along dim 1 into `dst`, both are (outer, n, inner) arrays.
+template <typename T, typename Op>
+void scan_impl(Memref<3, const T> *src, Memref<3, T> *dst, T identity, Op op) {
+  auto n = src->dims[1];
+  auto numLines = src->dims[0] * src->dims[2];
+  if (n == 0 || numLines == 0)
+    return;
+
+  // Few long lines, parallelize inside each line.
+  auto numThreads =
+      static_cast<size_t>(std::max(tbb::this_task_arena::max_concurrency(), 1));
+  if (n >= MinParallelScanSize && numLines < numThreads) {
+    for (size_t line = 0; line < numLines; ++line)
+      scanParallel(getLine(src, line), getLine(dst, line), identity, op);
+
+    return;
+  }
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, numLines),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (auto line = range.begin(); line != range.end();
+                           ++line)
+                        scanSeq(getLine(src, line), getLine(dst, line), 0, n,
+                                identity, op);
+                    });
+}
+
+/// Copies selected elements of `src` to `dst`, `pos` is inclusive prefix sum
+/// of the selection mask, so element is selected if its position changes.
+template <typename T>
+void compress_impl(Memref<1, const T> *src, Memref<1, const int64_t> *pos,
+                   Memref<1, T> *dst) {
+  auto getElem = [](auto *memref, size_t i) -> auto & {
+    return memref->data[memref->offset + i * memref->strides[0]];
+  };
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, src->dims[0]),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (auto i = range.begin(); i != range.end(); ++i) {
+                        auto p = getElem(pos, i);
+                        auto prev = (i == 0 ? 0 : getElem(pos, i - 1));
+                        if (p != prev)
+                          getElem(dst, static_cast<size_t>(p - 1)) =
+                              getElem(src, i);
+                      }
+                    });
+}
+} // namespace
+
+extern "C" {
+
+#define SCAN_VARIANT(T, Suff)                                                  \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_cumsum_##Suff(                        \
+      Memref<3, const T> *src, Memref<3, T> *dst) {                            \
+    scan_impl(src, dst, static_cast<T>(0), std::plus<T>());                    \
+  }                                                                            \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_cumprod_##Suff(                       \
+      Memref<3, const T> *src, Memref<3, T> *dst) {                            \
+    scan_impl(src, dst, static_cast<T>(1), std::multiplies<T>());              \
+  }
+
+SCAN_VARIANT(int64_t, int64)
+SCAN_VARIANT(float, float32)
+SCAN_VARIANT(double, float64)
+
+#undef SCAN_VARIANT
+
+#define COMPRESS_VARIANT(T, Suff)                                              \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_compress_##Suff(                      \
+      Memref<1, const T> *src, Memref<1, const int64_t> *pos,                  \
+      Memref<1, T> *dst) {                                                     \
+    compress_impl(src, pos, dst);                                              \
+  }
+
+COMPRESS_VARIANT(int8_t, int8)
+COMPRESS_VARIANT(int16_t, int16)
+COMPRESS_VARIANT(int32_t, int32)
+COMPRESS_VARIANT(int64_t, int64)
+COMPRESS_VARIANT(float, float32)
+COMPRESS_VARIANT(double, float64)
+
+#undef COMPRESS_VARIANT
+}
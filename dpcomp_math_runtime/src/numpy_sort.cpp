@@ -0,0 +1,295 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include "common.hpp"
+
+namespace {
+// Lines shorter than this are sorted with comparison sort.
+constexpr size_t MinRadixSortSize = 1 << 10;
+
+// Lines shorter than this are sorted sequentially, parallelizing over lines.
+constexpr size_t MinParallelSortSize = 1 << 16;
+
+// Blocks per thread for the parallel radix sort passes.
+constexpr size_t BlocksPerThread = 4;
+
+constexpr unsigned RadixBits = 8;
+constexpr size_t RadixSize = 1 << RadixBits;
+
+template <typename T>
+using KeyType = std::conditional_t<
+    sizeof(T) == 1, uint8_t,
+    std::conditional_t<
+        sizeof(T) == 2, uint16_t,
+        std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+template <typename T>
+constexpr auto SignBit =
+    static_cast<KeyType<T>>(KeyType<T>(1) << (sizeof(KeyType<T>) * 8 - 1));
+
+// Tags for the key conversion overloads.
+struct FloatTag {};
+struct SignedTag {};
+struct UnsignedTag {};
+
+template <typename T>
+using ValueTag = std::conditional_t<
+    std::is_floating_point<T>::value, FloatTag,
+    std::conditional_t<std::is_signed<T>::value, SignedTag, UnsignedTag>>;
+
+template <typename T> KeyType<T> toKey(T val, bool canonicalZero, FloatTag) {
+  using Key = KeyType<T>;
+  if (std::isnan(val))
+    return static_cast<Key>(~Key(0));
+
+  if (canonicalZero && val == T(0))
+    val = T(0);
+
+  Key bits;
+  std::memcpy(&bits, &val, sizeof(bits));
+  return static_cast<Key>((bits & SignBit<T>) ? ~bits : (bits | SignBit<T>));
+}
+
+template <typename T> KeyType<T> toKey(T val, bool, SignedTag) {
+  using Key = KeyType<T>;
+  return static_cast<Key>(static_cast<Key>(val) ^ SignBit<T>);
+}
+
+template <typename T> KeyType<T> toKey(T val, bool, UnsignedTag) {
+  return static_cast<KeyType<T>>(val);
+}
+
+/// Maps value to unsigned key with the same order. NaNs are mapped to the
+/// largest key, so they go last, as in NumPy. If `canonicalZero` is set, -0.0
+/// has the same key as 0.0, so stable sorts keep their original order.
+template <typename T> KeyType<T> toKey(T val, bool canonicalZero) {
+  return toKey(val, canonicalZero, ValueTag<T>());
+}
+
+template <typename T> T fromKey(KeyType<T> key, FloatTag) {
+  using Key = KeyType<T>;
+  Key bits = static_cast<Key>((key & SignBit<T>) ? (key ^ SignBit<T>) : ~key);
+  T val;
+  std::memcpy(&val, &bits, sizeof(val));
+  return val;
+}
+
+template <typename T> T fromKey(KeyType<T> key, SignedTag) {
+  return static_cast<T>(static_cast<KeyType<T>>(key ^ SignBit<T>));
+}
+
+template <typename T> T fromKey(KeyType<T> key, UnsignedTag) {
+  return static_cast<T>(key);
+}
+
+template <typename T> T fromKey(KeyType<T> key) {
+  return fromKey<T>(key, ValueTag<T>());
+}
+
+/// Stable LSD radix sort of `keys`, `payload` (if not null) is permuted
+/// along. Digit histograms and scatters of each pass are done in parallel
+/// over blocks, block offsets are assigned in block order to keep stability.
+template <typename Key>
+void radixSort(std::vector<Key> &keys, std::vector<int64_t> *payload,
+               bool parallel) {
+  auto n = keys.size();
+  size_t numBlocks = 1;
+  if (parallel) {
+    auto numThreads = static_cast<size_t>(
+        std::max(tbb::this_task_arena::max_concurrency(), 1));
+    numBlocks = std::min(numThreads * BlocksPerThread,
+                         std::max<size_t>(n / MinRadixSortSize, 1));
+  }
+  auto blockSize = (n + numBlocks - 1) / numBlocks;
+
+  std::vector<Key> tmpKeys(n);
+  std::vector<int64_t> tmpPayload(payload ? n : 0);
+  std::vector<std::array<size_t, RadixSize>> offsets(numBlocks);
+
+  auto forEachBlock = [&](auto func) {
+    auto body = [&](const tbb::blocked_range<size_t> &range) {
+      for (auto b = range.begin(); b != range.end(); ++b)
+        func(b, b * blockSize, std::min(n, (b + 1) * blockSize));
+    };
+    if (numBlocks > 1) {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks), body);
+    } else {
+      body(tbb::blocked_range<size_t>(0, 1));
+    }
+  };
+
+  for (unsigned shift = 0; shift < sizeof(Key) * 8; shift += RadixBits) {
+    auto digit = [&](Key key) { return (key >> shift) & (RadixSize - 1); };
+    forEachBlock([&](size_t b, size_t begin, size_t end) {
+      auto &counts = offsets[b];
+      counts.fill(0);
+      for (auto i = begin; i < end; ++i)
+        ++counts[digit(keys[i])];
+    });
+
+    // Pass doesn't change the order if all keys have the same digit.
+    size_t offset = 0;
+    bool skip = false;
+    for (size_t d = 0; d < RadixSize; ++d) {
+      size_t total = 0;
+      for (auto &counts : offsets) {
+        auto count = counts[d];
+        counts[d] = offset;
+        offset += count;
+        total += count;
+      }
+      if (total == n)
+        skip = true;
+    }
+    if (skip)
+      continue;
+
+    forEachBlock([&](size_t b, size_t begin, size_t end) {
+      auto &pos = offsets[b];
+      for (auto i = begin; i < end; ++i) {
+        auto dst = pos[digit(keys[i])]++;
+        tmpKeys[dst] = keys[i];
+        if (payload)
+          tmpPayload[dst] = (*payload)[i];
+      }
+    });
+    keys.swap(tmpKeys);
+    if (payload)
+      payload->swap(tmpPayload);
+  }
+}
+
+template <typename T> struct Line {
+  T *data;
+  size_t size;
+  ptrdiff_t stride;
+
+  T &operator[](size_t i) const {
+    return data[static_cast<ptrdiff_t>(i) * stride];
+  }
+};
+
+template <typename T> Line<T> getLine(Memref<3, T> *src, size_t line) {
+  auto inner = src->dims[2];
+  auto o = line / inner;
+  auto i = line % inner;
+  auto data = src->data + src->offset +
+              static_cast<ptrdiff_t>(o * src->strides[0]) +
+              static_cast<ptrdiff_t>(i * src->strides[2]);
+  return {data, src->dims[1], static_cast<ptrdiff_t>(src->strides[1])};
+}
+
+template <typename T>
+void sortLine(Line<const T> src, Line<T> dst, bool parallel) {
+  auto n = src.size;
+  std::vector<KeyType<T>> keys(n);
+  for (size_t i = 0; i < n; ++i)
+    keys[i] = toKey(src[i], /*canonicalZero*/ false);
+
+  if (n < MinRadixSortSize) {
+    std::sort(keys.begin(), keys.end());
+  } else {
+    radixSort(keys, nullptr, parallel);
+  }
+
+  for (size_t i = 0; i < n; ++i)
+    dst[i] = fromKey<T>(keys[i]);
+}
+
+template <typename T>
+void argsortLine(Line<const T> src, Line<int64_t> dst, bool parallel) {
+  auto n = src.size;
+  std::vector<KeyType<T>> keys(n);
+  for (size_t i = 0; i < n; ++i)
+    keys[i] = toKey(src[i], /*canonicalZero*/ true);
+
+  std::vector<int64_t> indices(n);
+  std::iota(indices.begin(), indices.end(), 0);
+  if (n < MinRadixSortSize) {
+    std::stable_sort(indices.begin(), indices.end(),
+                     [&](int64_t a, int64_t b) {
+                       return keys[static_cast<size_t>(a)] <
+                              keys[static_cast<size_t>(b)];
+                     });
+  } else {
+    radixSort(keys, &indices, parallel);
+  }
+
+  for (size_t i = 0; i < n; ++i)
+    dst[i] = indices[i];
+}
+
+/// Sorts (outer, n, inner) `src` along dim 1.
+template <typename T, typename R, typename F>
+void sort_impl(Memref<3, const T> *src, Memref<3, R> *dst, F sortFunc) {
+  auto n = src->dims[1];
+  auto numLines = src->dims[0] * src->dims[2];
+  if (n == 0 || numLines == 0)
+    return;
+
+  // Few long lines, parallelize inside each line.
+  auto numThreads =
+      static_cast<size_t>(std::max(tbb::this_task_arena::max_concurrency(), 1));
+  if (n >= MinParallelSortSize && numLines < numThreads) {
+    for (size_t line = 0; line < numLines; ++line)
+      sortFunc(getLine(src, line), getLine(dst, line), true);
+
+    return;
+  }
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, numLines),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (auto line = range.begin(); line != range.end();
+                           ++line)
+                        sortFunc(getLine(src, line), getLine(dst, line),
+                                 false);
+                    });
+}
+} // namespace
+
+extern "C" {
+
+#define SORT_VARIANT(T, Suff)                                                  \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_sort_##Suff(Memref<3, const T> *src,  \
+                                                     Memref<3, T> *dst) {      \
+    sort_impl(src, dst, &sortLine<T>);                                         \
+  }                                                                            \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_argsort_##Suff(                       \
+      Memref<3, const T> *src, Memref<3, int64_t> *dst) {                      \
+    sort_impl(src, dst, &argsortLine<T>);                                      \
+  }
+
+SORT_VARIANT(int8_t, int8)
+SORT_VARIANT(int16_t, int16)
+SORT_VARIANT(int32_t, int32)
+SORT_VARIANT(int64_t, int64)
+SORT_VARIANT(float, float32)
+SORT_VARIANT(double, float64)
+
+#undef SORT_VARIANT
+}
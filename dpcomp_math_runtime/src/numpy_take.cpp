@@ -0,0 +1,115 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "common.hpp"
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+namespace {
+// How many rows ahead to prefetch for random access.
+constexpr size_t PrefetchDistance = 8;
+
+// Rows larger than this are streamed well enough by the hw prefetcher.
+constexpr size_t MaxPrefetchRowBytes = 256;
+
+inline void prefetch(const void *ptr) {
+#if defined(_MSC_VER)
+  _mm_prefetch(static_cast<const char *>(ptr), _MM_HINT_T0);
+#else
+  __builtin_prefetch(ptr);
+#endif
+}
+
+template <typename T>
+T &getElem(Memref<3, T> *memref, size_t i, size_t j, size_t k) {
+  return memref->data[memref->offset + i * memref->strides[0] +
+                      j * memref->strides[1] + k * memref->strides[2]];
+}
+
+/// Gathers rows of (outer, n, inner) `src` along dim 1 into (outer, m, inner)
+/// `dst`, negative indices count from the end.
+template <typename T>
+void take_impl(Memref<3, const T> *src, Memref<1, const int64_t> *indices,
+               int64_t checkBounds, Memref<3, T> *dst) {
+  auto outer = dst->dims[0];
+  auto m = dst->dims[1];
+  auto inner = dst->dims[2];
+  auto n = static_cast<int64_t>(src->dims[1]);
+  auto getIndex = [&](size_t i) {
+    auto ind = indices->data[indices->offset + i * indices->strides[0]];
+    if (ind < 0)
+      ind += n;
+
+    if (checkBounds && (ind < 0 || ind >= n)) {
+      fprintf(stderr, "dpcomp: index %lld is out of bounds for size %lld\n",
+              static_cast<long long>(ind), static_cast<long long>(n));
+      abort();
+    }
+    return static_cast<size_t>(ind);
+  };
+
+  bool doPrefetch = inner * sizeof(T) <= MaxPrefetchRowBytes;
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, outer * m),
+      [&](const tbb::blocked_range<size_t> &range) {
+        for (auto r = range.begin(); r != range.end(); ++r) {
+          auto o = r / m;
+          auto i = r % m;
+          if (doPrefetch && i + PrefetchDistance < m) {
+            auto next = indices->data[indices->offset +
+                                      (i + PrefetchDistance) *
+                                          indices->strides[0]];
+            if (next < 0)
+              next += n;
+
+            if (next >= 0 && next < n)
+              prefetch(&getElem(src, o, static_cast<size_t>(next), 0));
+          }
+
+          auto ind = getIndex(i);
+          for (size_t k = 0; k < inner; ++k)
+            getElem(dst, o, i, k) = getElem(src, o, ind, k);
+        }
+      });
+}
+} // namespace
+
+extern "C" {
+
+#define TAKE_VARIANT(T, Suff)                                                  \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_take_##Suff(                          \
+      Memref<3, const T> *src, Memref<1, const int64_t> *indices,              \
+      int64_t checkBounds, Memref<3, T> *dst) {                                \
+    take_impl(src, indices, checkBounds, dst);                                 \
+  }
+
+TAKE_VARIANT(int8_t, int8)
+TAKE_VARIANT(int16_t, int16)
+TAKE_VARIANT(int32_t, int32)
+TAKE_VARIANT(int64_t, int64)
+TAKE_VARIANT(float, float32)
+TAKE_VARIANT(double, float64)
+
+#undef TAKE_VARIANT
+}
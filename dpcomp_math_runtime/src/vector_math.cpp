@@ -0,0 +1,54 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <cstddef>
+
+#include "common.hpp"
+
+namespace {
+// Operand is a contiguous stack buffer holding a single vector register.
+// Loop is compiled with vector math library support (see CMakeLists.txt), so
+// calls are replaced with libmvec vector variants.
+template <typename T, typename F> void applyInplace(Memref<1, T> *a, F func) {
+  auto data = a->data + a->offset;
+  auto size = a->dims[0];
+#pragma omp simd
+  for (size_t i = 0; i < size; ++i)
+    data[i] = func(data[i]);
+}
+} // namespace
+
+extern "C" {
+
+// Each variant is cloned for AVX-512 and AVX2, so the widest libmvec variants
+// supported by the host are picked at load time.
+#define VECTOR_MATH_VARIANT(Name, T, Suff)                                     \
+  __attribute__((target_clones("avx512f", "avx2", "default")))                 \
+  DPCOMP_MATH_RUNTIME_EXPORT void dpcomp_vec_##Name##_##Suff(Memref<1, T> *a) { \
+    applyInplace(a, [](T val) { return std::Name(val); });                     \
+  }
+
+#define VECTOR_MATH_VARIANTS(Name)                                             \
+  VECTOR_MATH_VARIANT(Name, float, float32)                                    \
+  VECTOR_MATH_VARIANT(Name, double, float64)
+
+VECTOR_MATH_VARIANTS(sin)
+VECTOR_MATH_VARIANTS(cos)
+VECTOR_MATH_VARIANTS(exp)
+VECTOR_MATH_VARIANTS(log)
+
+#undef VECTOR_MATH_VARIANTS
+#undef VECTOR_MATH_VARIANT
+}
@@ -0,0 +1,334 @@
+// Copyright 2021 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "dpcomp-runtime_export.h"
+
+namespace {
+// Layout must match numba NRT.
+struct NRTExternalAllocator {
+  void *(*malloc)(size_t size, void *opaque);
+  void *(*realloc)(void *ptr, size_t newSize, void *opaque);
+  void (*free)(void *ptr, void *opaque);
+  void *opaque;
+};
+
+using AllocExternalFunc = void *(*)(size_t, unsigned, NRTExternalAllocator *);
+using AllocFunc = void *(*)(size_t, unsigned);
+
+std::atomic<AllocExternalFunc> nrtAllocExternal{nullptr};
+std::atomic<AllocFunc> nrtAlloc{nullptr};
+
+constexpr size_t MinBlockSize = 64;
+constexpr size_t MaxBlockSize = 1 << 20;
+
+// Size classes are 4 steps per power of two: 64, 80, 96, 112, 128, 160, ...
+constexpr unsigned ClassSteps = 4;
+constexpr unsigned MinClassLog2 = 6;
+constexpr unsigned MaxClassLog2 = 20;
+constexpr unsigned NumClasses = (MaxClassLog2 - MinClassLog2) * ClassSteps + 1;
+
+// Max number of cached blocks per class per thread.
+constexpr unsigned MaxCachedBlocks = 64;
+// Max number of bytes cached per class per thread.
+constexpr size_t MaxCachedBytes = 2 * MaxBlockSize;
+// Max number of bytes cached per thread, for all classes.
+constexpr size_t MaxThreadCachedBytes = 4 * MaxBlockSize;
+
+// Large blocks are rounded to huge page size and cached globally.
+constexpr size_t LargePageSize = 2 << 20;
+constexpr unsigned MaxCachedLarge = 8;
+
+constexpr uint32_t LargeClass = static_cast<uint32_t>(-1);
+
+// Header precedes every returned block, keeps 16 bytes alignment.
+struct alignas(16) BlockHeader {
+  size_t size;
+  uint32_t sizeClass;
+  BlockHeader *next;
+};
+static_assert(sizeof(BlockHeader) % 16 == 0, "Unexpected header size");
+
+unsigned log2Ceil(size_t val) {
+  unsigned ret = 0;
+  while ((size_t(1) << ret) < val)
+    ++ret;
+  return ret;
+}
+
+unsigned getSizeClass(size_t size) {
+  if (size <= MinBlockSize)
+    return 0;
+
+  auto log = log2Ceil(size) - 1;
+  auto base = size_t(1) << log;
+  auto step = base / ClassSteps;
+  auto sub = static_cast<unsigned>((size - base + step - 1) / step);
+  return (log - MinClassLog2) * ClassSteps + sub;
+}
+
+size_t getClassSize(unsigned sizeClass) {
+  if (sizeClass == 0)
+    return MinBlockSize;
+
+  auto log = (sizeClass - 1) / ClassSteps + MinClassLog2;
+  auto sub = (sizeClass - 1) % ClassSteps + 1;
+  auto base = size_t(1) << log;
+  return base + sub * (base / ClassSteps);
+}
+
+void *allocSmall(size_t size) { return std::malloc(size); }
+
+void freeSmall(void *ptr) { std::free(ptr); }
+
+void *allocLarge(size_t size) {
+#ifdef __linux__
+  auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED)
+    return nullptr;
+
+#ifdef MADV_HUGEPAGE
+  (void)madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+  return ptr;
+#else
+  return std::malloc(size);
+#endif
+}
+
+void freeLarge(void *ptr, size_t size) {
+#ifdef __linux__
+  munmap(ptr, size);
+#else
+  (void)size;
+  std::free(ptr);
+#endif
+}
+
+struct LargeCache {
+  std::mutex mutex;
+  std::array<BlockHeader *, MaxCachedLarge> blocks = {};
+
+  BlockHeader *get(size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Reuse smallest block which is not too big.
+    BlockHeader **best = nullptr;
+    for (auto &block : blocks) {
+      if (!block || block->size < size || block->size > size * 2)
+        continue;
+
+      if (!best || (*best)->size > block->size)
+        best = &block;
+    }
+    if (!best)
+      return nullptr;
+
+    auto ret = *best;
+    *best = nullptr;
+    return ret;
+  }
+
+  void put(BlockHeader *header) {
+    BlockHeader *evicted = header;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto &block : blocks) {
+        if (!block) {
+          block = header;
+          return;
+        }
+      }
+      // Cache is full, evict smallest block.
+      auto smallest = &blocks.front();
+      for (auto &block : blocks)
+        if (block->size < (*smallest)->size)
+          smallest = &block;
+
+      if ((*smallest)->size < header->size)
+        std::swap(evicted, *smallest);
+    }
+    freeLarge(evicted, evicted->size);
+  }
+};
+
+LargeCache &getLargeCache() {
+  // Never destroyed, blocks can be freed by NRT during interpreter shutdown.
+  static auto cache = new LargeCache;
+  return *cache;
+}
+
+// Set when thread cache is destroyed, blocks still can be freed after that by
+// other thread local destructors. Trivially destructible, so it stays valid
+// until the thread is gone.
+thread_local bool threadCacheDestroyed = false;
+
+struct ThreadCache {
+  struct FreeList {
+    BlockHeader *head = nullptr;
+    unsigned count = 0;
+  };
+  std::array<FreeList, NumClasses> lists;
+  size_t cachedBytes = 0;
+
+  BlockHeader *get(unsigned sizeClass) {
+    auto &list = lists[sizeClass];
+    auto ret = list.head;
+    if (ret) {
+      list.head = ret->next;
+      --list.count;
+      cachedBytes -= ret->size;
+    }
+    return ret;
+  }
+
+  bool put(BlockHeader *header) {
+    auto &list = lists[header->sizeClass];
+    if (list.count >= MaxCachedBlocks ||
+        (list.count + 1) * header->size > MaxCachedBytes ||
+        cachedBytes + header->size > MaxThreadCachedBytes)
+      return false;
+
+    header->next = list.head;
+    list.head = header;
+    ++list.count;
+    cachedBytes += header->size;
+    return true;
+  }
+
+  ~ThreadCache() {
+    threadCacheDestroyed = true;
+    for (auto &list : lists) {
+      while (auto header = list.head) {
+        list.head = header->next;
+        freeSmall(header);
+      }
+    }
+  }
+};
+
+/// Returns null if the cache of the current thread is already destroyed.
+ThreadCache *getThreadCache() {
+  if (threadCacheDestroyed)
+    return nullptr;
+
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+void *poolAlloc(size_t size) {
+  BlockHeader *header = nullptr;
+  auto fullSize = size + sizeof(BlockHeader);
+  if (fullSize <= MaxBlockSize) {
+    auto sizeClass = getSizeClass(fullSize);
+    if (auto cache = getThreadCache())
+      header = cache->get(sizeClass);
+
+    if (!header) {
+      auto classSize = getClassSize(sizeClass);
+      header = static_cast<BlockHeader *>(allocSmall(classSize));
+      if (!header)
+        return nullptr;
+
+      header->size = classSize;
+      header->sizeClass = sizeClass;
+    }
+  } else {
+    fullSize = (fullSize + LargePageSize - 1) / LargePageSize * LargePageSize;
+    header = getLargeCache().get(fullSize);
+    if (!header) {
+      header = static_cast<BlockHeader *>(allocLarge(fullSize));
+      if (!header)
+        return nullptr;
+
+      header->size = fullSize;
+      header->sizeClass = LargeClass;
+    }
+  }
+  return header + 1;
+}
+
+void poolFree(void *ptr) {
+  if (!ptr)
+    return;
+
+  auto header = static_cast<BlockHeader *>(ptr) - 1;
+  if (header->sizeClass == LargeClass) {
+    getLargeCache().put(header);
+    return;
+  }
+
+  auto cache = getThreadCache();
+  if (!cache || !cache->put(header))
+    freeSmall(header);
+}
+
+void *poolRealloc(void *ptr, size_t newSize) {
+  if (!ptr)
+    return poolAlloc(newSize);
+
+  auto header = static_cast<BlockHeader *>(ptr) - 1;
+  auto oldSize = header->size - sizeof(BlockHeader);
+  if (newSize <= oldSize)
+    return ptr;
+
+  auto ret = poolAlloc(newSize);
+  if (!ret)
+    return nullptr;
+
+  std::memcpy(ret, ptr, oldSize);
+  poolFree(ptr);
+  return ret;
+}
+
+NRTExternalAllocator poolAllocator = {
+    [](size_t size, void *) { return poolAlloc(size); },
+    [](void *ptr, size_t newSize, void *) { return poolRealloc(ptr, newSize); },
+    [](void *ptr, void *) { poolFree(ptr); },
+    nullptr,
+};
+} // namespace
+
+extern "C" {
+DPCOMP_RUNTIME_EXPORT void dpcomp_memory_init(void *allocExternal,
+                                              void *alloc) {
+  nrtAllocExternal = reinterpret_cast<AllocExternalFunc>(allocExternal);
+  nrtAlloc = reinterpret_cast<AllocFunc>(alloc);
+}
+
+/// Allocates NRT meminfo and data, data is allocated from thread local pools.
+/// Falls back to default NRT allocator if external allocators are not
+/// supported.
+DPCOMP_RUNTIME_EXPORT void *dpcomp_alloc_meminfo(size_t size,
+                                                 unsigned alignment) {
+  if (auto func = nrtAllocExternal.load(std::memory_order_relaxed))
+    return func(size, alignment, &poolAllocator);
+
+  auto func = nrtAlloc.load(std::memory_order_relaxed);
+  assert(func && "dpcomp memory runtime is not initialized");
+  return func(size, alignment);
+}
+}
@@ -18,11 +18,13 @@ Define @jit and related decorators.
 
 from .mlir.compiler import mlir_compiler_pipeline
 from .mlir.vectorize import vectorize as mlir_vectorize
+from .mlir.vectorize import guvectorize as mlir_guvectorize
 from .mlir.settings import USE_MLIR
 
 from numba.core.decorators import jit as orig_jit
 from numba.core.decorators import njit as orig_njit
 from numba.np.ufunc import vectorize as orig_vectorize
+from numba.np.ufunc import guvectorize as orig_guvectorize
 
 if USE_MLIR:
     def jit(signature_or_function=None, locals={}, cache=False,
@@ -49,7 +51,9 @@ if USE_MLIR:
         kws.update({'nopython': True})
         return jit(*args, **kws)
     vectorize = mlir_vectorize
+    guvectorize = mlir_guvectorize
 else:
     jit = orig_jit
     njit = orig_njit
     vectorize = orig_vectorize
+    guvectorize = orig_guvectorize
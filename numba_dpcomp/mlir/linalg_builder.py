@@ -14,6 +14,9 @@
 
 from .func_registry import add_func
 
+import functools
+import numpy
+
 class Var:
     def __init__(self, context, ssa_val):
         self._context = context
@@ -66,8 +69,8 @@ class Builder:
     def fill_tensor(self, tensor, value):
         return self._fill_tensor(self._context, tensor, value)
 
-    def generic(self, inputs, outputs, iterators, maps, body):
-        return self._generic(self._context, inputs, outputs, iterators, maps, body)
+    def generic(self, inputs, outputs, iterators, maps, body, indices=()):
+        return self._generic(self._context, inputs, outputs, iterators, maps, body, indices)
 
     def from_elements(self, values, dtype):
         return self._from_elements(self._context, values, dtype)
@@ -122,8 +125,62 @@ def lookup_func(name):
     global _func_registry
     return _func_registry.get(name)
 
+_numpy_type_names = [
+    'bool',
+    'int8',
+    'uint8',
+    'int16',
+    'uint16',
+    'int32',
+    'uint32',
+    'int64',
+    'uint64',
+    'float16',
+    'float32',
+    'float64',
+]
+
+def get_numpy_type(builder, t):
+    for name in _numpy_type_names:
+        if t == getattr(builder, name):
+            return numpy.dtype(name)
+    if t == builder.index:
+        return numpy.dtype(numpy.int64)
+    return None
+
+def _get_type_kind(t):
+    return {'b': 0, 'i': 1, 'u': 1, 'f': 2, 'c': 3}[t.kind]
+
+def promote_numpy_types(array_types, scalar_types):
+    # Follow NumPy promotion rules, scalars only affect the result type if
+    # they are of higher kind (bool < int < float) than all arrays.
+    types = array_types
+    if not array_types or (scalar_types and
+                           max(map(_get_type_kind, scalar_types)) >
+                           max(map(_get_type_kind, array_types))):
+        types = array_types + scalar_types
+
+    return functools.reduce(numpy.promote_types, types)
+
 def broadcast_type(builder, args):
-    return args[0].dtype # TODO
+    array_types = []
+    scalar_types = []
+    for arg in args:
+        if is_literal(arg):
+            scalar_types.append(numpy.dtype(type(arg)))
+            continue
+
+        t = get_numpy_type(builder, arg.dtype)
+        if t is None:
+            return arg.dtype
+
+        if len(arg.shape) == 0:
+            scalar_types.append(t)
+        else:
+            array_types.append(t)
+
+    res = promote_numpy_types(array_types, scalar_types)
+    return getattr(builder, res.name)
 
 def eltwise(builder, args, body, res_type = None):
     if isinstance(args, tuple):
@@ -31,7 +31,23 @@ def load_function_variants(func_name, suffixes):
         func = getattr(runtime_lib, name)
         ll.add_symbol(mlir_name, ctypes.cast(func, ctypes.c_void_p).value)
 
+load_function_variants('dpcomp_check_reduce_size', [''])
+load_function_variants('dpcomp_check_mask_dim', [''])
+load_function_variants('dpcomp_check_gufunc_dim', [''])
+load_function_variants('dpcomp_check_matmul_dim', [''])
+load_function_variants('dpcomp_check_index', [''])
+load_function_variants('dpcomp_check_setitem_dim', [''])
 load_function_variants('dpcomp_linalg_eig_', ['float32','float64'])
+load_function_variants('dpcomp_linalg_matmul_', ['float32','float64'])
+load_function_variants('dpcomp_linalg_matmul_batch_', ['float32','float64'])
+load_function_variants('dpcomp_linalg_matvec_', ['float32','float64'])
+load_function_variants('dpcomp_linalg_vecmat_', ['float32','float64'])
+
+# Vector math variants are only built when libmvec is available.
+vector_math_available = hasattr(runtime_lib, 'dpcomp_vec_sin_float32')
+if vector_math_available:
+    for func in ['sin', 'cos', 'exp', 'log']:
+        load_function_variants(f'dpcomp_vec_{func}_', ['float32','float64'])
 
 _finalize_func = runtime_lib.dpcomp_math_runtime_finalize
 
@@ -12,7 +12,8 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
-from ..linalg_builder import register_func, register_attr, is_literal, broadcast_type, eltwise, convert_array, asarray, is_int
+from ..linalg_builder import register_func, register_attr, is_literal, broadcast_type, eltwise, convert_array, asarray, is_int, get_numpy_type
+from ..settings import BOUNDS_CHECK
 
 import numpy
 import math
@@ -22,13 +23,21 @@ def is_float(t, b):
     return t == b.float16 or t == b.float32 or t == b.float64
 
 def promote_int(t, b):
-    if is_int(t, b):
+    if is_int(t, b) or t == b.bool:
         return b.int64
     return t
 
-@register_func('array.sum')
-@register_func('numpy.sum', numpy.sum)
-def sum_impl(builder, arg, axis=None):
+_INT64_MAX = 0x7fffffffffffffff
+
+def _get_reduce_axis(arg, axis):
+    if isinstance(axis, int) and axis < 0:
+        return axis + len(arg.shape)
+    return axis
+
+def _reduce_impl(builder, arg, axis, res_type, init, body):
+    # Single value accumulator, initialized with reduction identity, so loops
+    # can be promoted to parallel reductions and fused with sibling ones.
+    axis = _get_reduce_axis(arg, axis)
     if axis is None:
         shape = arg.shape
         num_dims = len(shape)
@@ -37,10 +46,7 @@ def sum_impl(builder, arg, axis=None):
         expr1 = f'({dims}) -> ({dims})'
         expr2 = f'({dims}) -> (0)'
         maps = [expr1,expr2]
-        init = builder.from_elements(0, promote_int(arg.dtype, builder))
-
-        def body(a, b):
-            return a + b
+        init = builder.from_elements(init, res_type)
 
         res = builder.generic(arg, init, iterators, maps, body)
         return builder.extract(res, 0)
@@ -54,24 +60,217 @@ def sum_impl(builder, arg, axis=None):
         expr2 = f'({dims1}) -> ({dims2})'
         maps = [expr1,expr2]
         res_shape = tuple(shape[i] for i in range(len(shape)) if i != axis)
+        init = builder.init_tensor(res_shape, res_type, init)
 
-        orig_type = arg.dtype
-        if is_int(orig_type, builder):
-            res_type = builder.int64
-        else:
-            res_type = orig_type
-        init = builder.init_tensor(res_shape, res_type, 0)
+        return builder.generic(arg, init, iterators, maps, body)
 
-        def body(a, b):
-            return a + b
+@register_func('array.sum')
+@register_func('numpy.sum', numpy.sum)
+def sum_impl(builder, arg, axis=None):
+    return _reduce_impl(builder, arg, axis, promote_int(arg.dtype, builder), 0,
+                        lambda a, b: a + b)
+
+@register_func('array.prod')
+@register_func('numpy.prod', numpy.prod)
+def prod_impl(builder, arg, axis=None):
+    return _reduce_impl(builder, arg, axis, promote_int(arg.dtype, builder), 1,
+                        lambda a, b: a * b)
+
+def _get_minmax_init(builder, dtype, is_max):
+    t = get_numpy_type(builder, dtype)
+    if t is None:
+        return None
+    if t.kind == 'f':
+        return -math.inf if is_max else math.inf
+    if t.kind == 'b':
+        return not is_max
+    info = numpy.iinfo(t)
+    val = int(info.min if is_max else info.max)
+    # Constants are created as int64, pass uint64 max as its bit pattern.
+    return -1 if val > _INT64_MAX else val
+
+def _minmax_impl(builder, arg, axis, is_max, body):
+    init = _get_minmax_init(builder, arg.dtype, is_max)
+    axis = _get_reduce_axis(arg, axis)
+    if init is None or not (axis is None or isinstance(axis, int)):
+        return None
+
+    # Min/max have no identity, NumPy raises for empty reductions. Runtime
+    # reports the error and aborts.
+    size = _get_reduce_size(builder, arg, axis)
+    builder.external_call('dpcomp_check_reduce_size', (size,), ())
+    return _reduce_impl(builder, arg, axis, arg.dtype, init, body)
+
+# NaNs are propagated, as in NumPy, `a != a` is only true for NaN.
+@register_func('array.min')
+@register_func('numpy.amin', numpy.amin) # numpy.min is an alias
+def min_impl(builder, arg, axis=None):
+    return _minmax_impl(builder, arg, axis, False,
+                        lambda a, b: a if a != a else (a if a < b else b))
+
+@register_func('array.max')
+@register_func('numpy.amax', numpy.amax) # numpy.max is an alias
+def max_impl(builder, arg, axis=None):
+    return _minmax_impl(builder, arg, axis, True,
+                        lambda a, b: a if a != a else (a if a > b else b))
+
+def _argfind_body(a, m, b, i):
+    # First index of the already reduced min/max value. Reduced value is NaN
+    # only if input has NaNs, the first one is found then.
+    r = i if a == m else (i if a != a else _INT64_MAX)
+    return r if r < b else b
+
+def _argminmax_impl(builder, arg, axis, reduce_func):
+    axis = _get_reduce_axis(arg, axis)
+    if axis is None:
+        arg = flatten_impl(builder, arg)
+        m = reduce_func(builder, arg)
+        if m is None:
+            return None
 
-        return builder.generic(arg, init, iterators, maps, body)
+        iterators = ['reduction']
+        maps = ['(d0) -> (d0)', '(d0) -> (0)', '(d0) -> (0)']
+        m = builder.from_elements(m, arg.dtype)
+        init = builder.from_elements(_INT64_MAX, builder.int64)
+        res = builder.generic((arg, m), init, iterators, maps, _argfind_body, indices=(0,))
+        return builder.extract(res, 0)
+    elif isinstance(axis, int):
+        m = reduce_func(builder, arg, axis)
+        if m is None:
+            return None
+
+        shape = arg.shape
+        num_dims = len(shape)
+        iterators = [('reduction' if i == axis else 'parallel') for i in range(num_dims)]
+        dims1 = ','.join(['d%s' % i for i in range(num_dims)])
+        dims2 = ','.join(['d%s' % i for i in range(num_dims) if i != axis])
+        expr1 = f'({dims1}) -> ({dims1})'
+        expr2 = f'({dims1}) -> ({dims2})'
+        maps = [expr1,expr2,expr2]
+        res_shape = tuple(shape[i] for i in range(len(shape)) if i != axis)
+        init = builder.init_tensor(res_shape, builder.int64, _INT64_MAX)
+        return builder.generic((arg, m), init, iterators, maps, _argfind_body, indices=(axis,))
+
+@register_func('array.argmin')
+@register_func('numpy.argmin', numpy.argmin)
+def argmin_impl(builder, arg, axis=None):
+    return _argminmax_impl(builder, arg, axis, min_impl)
+
+@register_func('array.argmax')
+@register_func('numpy.argmax', numpy.argmax)
+def argmax_impl(builder, arg, axis=None):
+    return _argminmax_impl(builder, arg, axis, max_impl)
 
+def _get_mean_type(t, b):
+    # NumPy computes mean of ints in float64 regardless of their width.
+    return t if is_float(t, b) else b.float64
 
+def _get_reduce_size(builder, arg, axis):
+    if axis is None:
+        return size_impl(builder, arg)
+    return builder.cast(arg.shape[axis], builder.int64)
+
+@register_func('array.mean')
 @register_func('numpy.mean', numpy.mean)
 def mean_impl(builder, arg, axis=None):
-    return sum_impl(builder, arg, axis) / size_impl(builder, arg)
-
+    axis = _get_reduce_axis(arg, axis)
+    res_type = _get_mean_type(arg.dtype, builder)
+    size = _get_reduce_size(builder, arg, axis)
+    res = _reduce_impl(builder, arg, axis, res_type, 0, lambda a, b: a + b)
+    return eltwise(builder, (res, size), lambda a, s, b: a / s, res_type)
+
+def _var_impl(builder, arg, axis, ddof):
+    # Two pass algorithm, as in NumPy, is used instead of the single pass one
+    # for accuracy. Sibling reductions over the same input are fused later.
+    axis = _get_reduce_axis(arg, axis)
+    res_type = _get_mean_type(arg.dtype, builder)
+    mean = mean_impl(builder, arg, axis)
+    dev_body = lambda a, m, b: (a - m) * (a - m)
+    if axis is None:
+        dev = eltwise(builder, (arg, mean), dev_body, res_type)
+    else:
+        shape = arg.shape
+        num_dims = len(shape)
+        iterators = ['parallel' for _ in range(num_dims)]
+        dims1 = ','.join(['d%s' % i for i in range(num_dims)])
+        dims2 = ','.join(['d%s' % i for i in range(num_dims) if i != axis])
+        expr1 = f'({dims1}) -> ({dims1})'
+        expr2 = f'({dims1}) -> ({dims2})'
+        maps = [expr1,expr2,expr1]
+        init = builder.init_tensor(shape, res_type)
+        dev = builder.generic((arg, mean), init, iterators, maps, dev_body)
+
+    size = _get_reduce_size(builder, arg, axis)
+    res = _reduce_impl(builder, dev, axis, res_type, 0, lambda a, b: a + b)
+    return eltwise(builder, (res, size, ddof), lambda a, s, d, b: a / (s - d), res_type)
+
+@register_func('array.var')
+@register_func('numpy.var', numpy.var)
+def var_impl(builder, arg, axis=None, ddof=0):
+    return _var_impl(builder, arg, axis, ddof)
+
+@register_func('array.std')
+@register_func('numpy.std', numpy.std)
+def std_impl(builder, arg, axis=None, ddof=0):
+    return eltwise(builder, _var_impl(builder, arg, axis, ddof), lambda a, b: math.sqrt(a))
+
+def _get_line_view_shape(arr, axis):
+    # (outer, n, inner) view of the contiguous array, used by the runtime
+    # kernels working along single axis.
+    shape = arr.shape
+    outer = 1
+    for i in range(axis):
+        outer = outer * shape[i]
+    inner = 1
+    for i in range(axis + 1, len(shape)):
+        inner = inner * shape[i]
+    return (outer, shape[axis], inner)
+
+def _line_kernel_impl(builder, arg, axis, func_name, res_type):
+    axis = _get_reduce_axis(arg, axis)
+    if axis is None:
+        size = size_impl(builder, arg)
+        src_shape = (1, size, 1)
+        res_shape = size
+    elif isinstance(axis, int):
+        src_shape = _get_line_view_shape(arg, axis)
+        res_shape = arg.shape
+    else:
+        return None
+
+    src = builder.reshape(arg, src_shape)
+    res = builder.init_tensor(src_shape, res_type)
+    res = builder.external_call(func_name, src, res)[0]
+    return builder.reshape(res, res_shape)
+
+def _scan_impl(builder, arg, axis, name):
+    # Scan is done by the runtime along the middle dim of the line view.
+    res_type = promote_int(arg.dtype, builder)
+    if res_type != builder.int64 and res_type != builder.float32 and res_type != builder.float64:
+        return None
+
+    func_name = f'dpcomp_{name}_{dtype_str(builder, res_type)}'
+    arg = convert_array(builder, arg, res_type)
+    return _line_kernel_impl(builder, arg, axis, func_name, res_type)
+
+@register_func('array.cumsum')
+@register_func('numpy.cumsum', numpy.cumsum)
+def cumsum_impl(builder, arg, axis=None):
+    return _scan_impl(builder, arg, axis, 'cumsum')
+
+@register_func('array.cumprod')
+@register_func('numpy.cumprod', numpy.cumprod)
+def cumprod_impl(builder, arg, axis=None):
+    return _scan_impl(builder, arg, axis, 'cumprod')
+
+def _get_float_type(t, b):
+    # Int types are converted to the smallest float type able to represent
+    # them exactly, except float16, which has no math funcs.
+    if is_float(t, b):
+        return t
+    if t == b.int8 or t == b.uint8 or t == b.int16 or t == b.uint16:
+        return b.float32
+    return b.float64
 
 def _gen_unary_ops():
     unary_ops = [
@@ -80,15 +279,18 @@ def _gen_unary_ops():
         (register_func('numpy.log', numpy.log), True, lambda a, b: math.log(a)),
         (register_func('numpy.sin', numpy.sin), True, lambda a, b: math.sin(a)),
         (register_func('numpy.cos', numpy.cos), True, lambda a, b: math.cos(a)),
+        (register_func('numpy.exp', numpy.exp), True, lambda a, b: math.exp(a)),
+        (register_func('numpy.tanh', numpy.tanh), True, lambda a, b: math.tanh(a)),
     ]
 
-    def make_func(f64, body):
+    def make_func(is_float_func, body):
         def func(builder, arg):
-            return eltwise(builder, arg, body, builder.float64 if f64 else None)
+            res_type = _get_float_type(arg.dtype, builder) if is_float_func else None
+            return eltwise(builder, arg, body, res_type)
         return func
 
-    for reg, f64, body in unary_ops:
-        reg(make_func(f64, body))
+    for reg, is_float_func, body in unary_ops:
+        reg(make_func(is_float_func, body))
 
 _gen_unary_ops()
 
@@ -106,16 +308,58 @@ def _gen_binary_ops():
         (register_func('operator.pow'), False, lambda a, b, c: a ** b),
     ]
 
-    def make_func(f64, body):
+    def make_func(is_float_func, body):
         def func(builder, arg1, arg2):
-            return eltwise(builder, (arg1, arg2), body, builder.float64 if f64 else None)
+            res_type = None
+            if is_float_func:
+                # NumPy divides ints in float64 regardless of their width.
+                res_type = broadcast_type(builder, (arg1, arg2))
+                if not is_float(res_type, builder):
+                    res_type = builder.float64
+            return eltwise(builder, (arg1, arg2), body, res_type)
         return func
 
-    for reg, f64, body in binary_ops:
-        reg(make_func(f64, body))
+    for reg, is_float_func, body in binary_ops:
+        reg(make_func(is_float_func, body))
 
 _gen_binary_ops()
 
+def _gen_cmp_ops():
+    cmp_ops = [
+        (register_func('numpy.greater', numpy.greater), lambda a, b, c: a > b),
+        (register_func('operator.gt'), lambda a, b, c: a > b),
+        (register_func('numpy.greater_equal', numpy.greater_equal), lambda a, b, c: a >= b),
+        (register_func('operator.ge'), lambda a, b, c: a >= b),
+        (register_func('numpy.less', numpy.less), lambda a, b, c: a < b),
+        (register_func('operator.lt'), lambda a, b, c: a < b),
+        (register_func('numpy.less_equal', numpy.less_equal), lambda a, b, c: a <= b),
+        (register_func('operator.le'), lambda a, b, c: a <= b),
+        (register_func('numpy.equal', numpy.equal), lambda a, b, c: a == b),
+        (register_func('operator.eq'), lambda a, b, c: a == b),
+        (register_func('numpy.not_equal', numpy.not_equal), lambda a, b, c: a != b),
+        (register_func('operator.ne'), lambda a, b, c: a != b),
+    ]
+
+    def make_func(body):
+        def func(builder, arg1, arg2):
+            return eltwise(builder, (arg1, arg2), body, builder.bool)
+        return func
+
+    for reg, body in cmp_ops:
+        reg(make_func(body))
+
+_gen_cmp_ops()
+
+@register_func('numpy.where', numpy.where)
+def where_impl(builder, cond, x=None, y=None):
+    if x is None or y is None:
+        return None
+
+    # Single forwarding branch in the body is turned into select, so the loop
+    # stays branch-free and can be vectorized.
+    res_type = broadcast_type(builder, (x, y))
+    return eltwise(builder, (cond, x, y), lambda c, a, b, r: a if c else b, res_type)
+
 def _init_impl(builder, shape, dtype, init=None):
     if dtype is None:
         dtype = builder.float64
@@ -137,6 +381,66 @@ def empty_impl(builder, shape, dtype=None):
 def zeros_impl(builder, shape, dtype=None):
     return _init_impl(builder, shape, dtype, 0)
 
+def _get_matmul_func_name(builder, name, a, b):
+    dtype = a.dtype
+    if dtype != b.dtype:
+        return None
+    if dtype != builder.float32 and dtype != builder.float64:
+        return None
+    return f'dpcomp_linalg_{name}_{dtype_str(builder, dtype)}'
+
+def _matmul2d_impl(builder, a, b):
+    shape1 = a.shape
+    shape2 = b.shape
+    res_shape = (shape1[0], shape2[1])
+    func_name = _get_matmul_func_name(builder, 'matmul', a, b)
+    if func_name is not None:
+        res = builder.init_tensor(res_shape, a.dtype)
+        return builder.external_call(func_name, (a, b), res)[0]
+
+    # Runtime functions check shapes themselves.
+    builder.external_call('dpcomp_check_matmul_dim', (shape1[1], shape2[0]), ())
+    iterators = ['parallel','parallel','reduction']
+    expr1 = '(d0,d1,d2) -> (d0,d2)'
+    expr2 = '(d0,d1,d2) -> (d2,d1)'
+    expr3 = '(d0,d1,d2) -> (d0,d1)'
+    maps = [expr1,expr2,expr3]
+    init = builder.init_tensor(res_shape, a.dtype, 0)
+
+    def body(a, b, c):
+        return a * b + c
+
+    return builder.generic((a,b), init, iterators, maps, body)
+
+def _matvec_impl(builder, a, b):
+    shape1 = a.shape
+    shape2 = b.shape
+    if len(shape1) == 2:
+        name = 'matvec'
+        res_size = shape1[0]
+        inner_dims = (shape1[1], shape2[0])
+        iterators = ['parallel','reduction']
+        maps = ['(d0,d1) -> (d0,d1)', '(d0,d1) -> (d1)', '(d0,d1) -> (d0)']
+    else:
+        name = 'vecmat'
+        res_size = shape2[1]
+        inner_dims = (shape1[0], shape2[0])
+        iterators = ['reduction','parallel']
+        maps = ['(d0,d1) -> (d0)', '(d0,d1) -> (d0,d1)', '(d0,d1) -> (d1)']
+
+    func_name = _get_matmul_func_name(builder, name, a, b)
+    if func_name is not None:
+        res = builder.init_tensor([res_size], a.dtype)
+        return builder.external_call(func_name, (a, b), res)[0]
+
+    builder.external_call('dpcomp_check_matmul_dim', inner_dims, ())
+    init = builder.init_tensor([res_size], a.dtype, 0)
+
+    def body(a, b, c):
+        return a * b + c
+
+    return builder.generic((a,b), init, iterators, maps, body)
+
 @register_func('numpy.dot', numpy.dot)
 def dot_impl(builder, a, b):
     shape1 = a.shape
@@ -154,18 +458,27 @@ def dot_impl(builder, a, b):
         res = builder.generic((a,b), init, iterators, maps, body)
         return builder.extract(res, 0)
     if len(shape1) == 2 and len(shape2) == 2:
-        iterators = ['parallel','parallel','reduction']
-        expr1 = '(d0,d1,d2) -> (d0,d2)'
-        expr2 = '(d0,d1,d2) -> (d2,d1)'
-        expr3 = '(d0,d1,d2) -> (d0,d1)'
-        maps = [expr1,expr2,expr3]
-        res_shape = (shape1[0], shape2[1])
-        init = builder.init_tensor(res_shape, a.dtype, 0)
+        return _matmul2d_impl(builder, a, b)
+    if (len(shape1) == 2 and len(shape2) == 1) or (len(shape1) == 1 and len(shape2) == 2):
+        return _matvec_impl(builder, a, b)
 
-        def body(a, b, c):
-            return a * b + c
+def _broadcast_dim_impl(a, b):
+    return b if a == 1 else a
 
-        return builder.generic((a,b), init, iterators, maps, body)
+@register_func('operator.matmul')
+def matmul_impl(builder, a, b):
+    shape1 = a.shape
+    shape2 = b.shape
+    if len(shape1) == 3 and len(shape2) == 3:
+        # batched matmul is only supported through the runtime
+        func_name = _get_matmul_func_name(builder, 'matmul_batch', a, b)
+        if func_name is not None:
+            # Batch dims are broadcasted, mismatch is reported by the runtime.
+            batch = _inline_dims_func(builder, _broadcast_dim_impl, shape1[0], shape2[0])
+            res = builder.init_tensor((batch, shape1[1], shape2[2]), a.dtype)
+            return builder.external_call(func_name, (a, b), res)[0]
+    elif len(shape1) <= 2 and len(shape2) <= 2:
+        return dot_impl(builder, a, b)
 
 @register_attr('array.size')
 def size_impl(builder, arg):
@@ -179,20 +492,24 @@ def size_impl(builder, arg):
 def transpose_impl(builder, arg):
     shape = arg.shape
     dims = len(shape)
-    if dims == 1:
+    if dims <= 1:
         return arg
-    if dims == 2:
-        iterators = ['parallel','parallel']
-        expr1 = '(d0,d1) -> (d0,d1)'
-        expr2 = '(d0,d1) -> (d1,d0)'
-        maps = [expr1,expr2]
-        res_shape = (shape[1], shape[0])
-        init = builder.init_tensor(res_shape, arg.dtype)
 
-        def body(a, b):
-            return a
+    # Result is read through the reversed map, so after bufferization this
+    # copy can be replaced with a strided view of the source.
+    iterators = ['parallel' for _ in range(dims)]
+    dims1 = ','.join(['d%s' % i for i in range(dims)])
+    dims2 = ','.join(['d%s' % i for i in reversed(range(dims))])
+    expr1 = f'({dims1}) -> ({dims2})'
+    expr2 = f'({dims1}) -> ({dims1})'
+    maps = [expr1,expr2]
+    res_shape = tuple(shape[i] for i in reversed(range(dims)))
+    init = builder.init_tensor(res_shape, arg.dtype)
 
-        return builder.generic(arg, init, iterators, maps, body)
+    def body(a, b):
+        return a
+
+    return builder.generic(arg, init, iterators, maps, body)
 
 @register_attr('array.dtype')
 def dtype_impl(builder, arg):
@@ -222,16 +539,207 @@ def dtype_str(builder, dtype):
             return name
     assert(False)
 
+def _has_runtime_variant(builder, dtype):
+    return dtype in (builder.int8, builder.int16, builder.int32, builder.int64,
+                     builder.float32, builder.float64)
+
+def _sort_impl(builder, arr, axis, name, res_type):
+    dtype = arr.dtype
+    if not _has_runtime_variant(builder, dtype) or len(arr.shape) == 0:
+        return None
+
+    func_name = f'dpcomp_{name}_{dtype_str(builder, dtype)}'
+    return _line_kernel_impl(builder, arr, axis, func_name, res_type)
+
+@register_func('numpy.sort', numpy.sort)
+def sort_impl(builder, a, axis=-1):
+    # Result is a sorted copy, in place array.sort is not supported.
+    return _sort_impl(builder, a, axis, 'sort', a.dtype)
+
+@register_func('array.argsort')
+@register_func('numpy.argsort', numpy.argsort)
+def argsort_impl(builder, a, axis=-1):
+    # Runtime sort is stable, as NumPy kind="stable".
+    return _sort_impl(builder, a, axis, 'argsort', builder.int64)
+
+def _compress_impl(builder, arr, mask):
+    # Parallel stream compaction: count selected elements, get their
+    # destinations from the inclusive prefix sum of the mask and scatter them.
+    dtype = arr.dtype
+    if not _has_runtime_variant(builder, dtype):
+        return None
+
+    # Mask must have the same shape as the array, as in NumPy. Runtime reports
+    # the error and aborts.
+    for i, (size, mask_size) in enumerate(zip(arr.shape, mask.shape)):
+        size = builder.cast(size, builder.int64)
+        mask_size = builder.cast(mask_size, builder.int64)
+        builder.external_call('dpcomp_check_mask_dim', (size, mask_size, i), ())
+
+    arr = flatten_impl(builder, arr)
+    mask = flatten_impl(builder, mask)
+    count = _reduce_impl(builder, mask, None, builder.int64, 0, lambda a, b: a + b)
+    pos = _scan_impl(builder, mask, None, 'cumsum')
+    res = builder.init_tensor((count,), dtype)
+    func_name = f'dpcomp_compress_{dtype_str(builder, dtype)}'
+    return builder.external_call(func_name, (arr, pos), res)[0]
+
+def _take_impl(builder, arr, indices, axis):
+    # Gather is done by the runtime along the middle dim of the line view,
+    # rows are copied in parallel with prefetching.
+    dtype = arr.dtype
+    if not _has_runtime_variant(builder, dtype) or not is_int(indices.dtype, builder):
+        return None
+
+    if axis is None:
+        arr = flatten_impl(builder, arr)
+        axis = 0
+
+    axis = _get_reduce_axis(arr, axis)
+    if not isinstance(axis, int):
+        return None
+
+    shape = arr.shape
+    outer, _, inner = _get_line_view_shape(arr, axis)
+    index_shape = indices.shape
+    count = size_impl(builder, indices)
+    indices = convert_array(builder, flatten_impl(builder, indices), builder.int64)
+    src = builder.reshape(arr, _get_line_view_shape(arr, axis))
+    res = builder.init_tensor((outer, count, inner), dtype)
+    func_name = f'dpcomp_take_{dtype_str(builder, dtype)}'
+    res = builder.external_call(func_name, (src, indices, BOUNDS_CHECK), res)[0]
+    res_shape = tuple(shape[:axis]) + tuple(index_shape) + tuple(shape[axis + 1:])
+    return builder.reshape(res, res_shape)
+
+@register_func('numpy.take', numpy.take)
+def take_impl(builder, a, indices, axis=None):
+    if is_literal(indices) or len(indices.shape) == 0:
+        return None
+    return _take_impl(builder, a, indices, axis)
+
+@register_func('operator.getitem')
+def getitem_impl(builder, arr, index):
+    if index.dtype == builder.bool and len(index.shape) == len(arr.shape):
+        return _compress_impl(builder, arr, index)
+    if is_int(index.dtype, builder):
+        return _take_impl(builder, arr, index, 0)
+
+def _linalg_prepare(builder, args, ndims):
+    # Integer inputs are computed in float64, as in numpy.
+    for arg, ndim in zip(args, ndims):
+        if is_literal(arg) or len(arg.shape) not in ndim:
+            return None, args
+    dtype = broadcast_type(builder, args)
+    if is_int(dtype, builder) or dtype == builder.bool:
+        dtype = builder.float64
+    if dtype != builder.float32 and dtype != builder.float64:
+        return None, args
+    return dtype, tuple(convert_array(builder, arg, dtype) for arg in args)
+
+def _linalg_func_name(builder, name, dtype):
+    return f'dpcomp_linalg_{name}_{dtype_str(builder, dtype)}'
+
+def _min_dim_impl(a, b):
+    return a if a < b else b
+
+def _lstsq_residuals_size_impl(m, n, nrhs):
+    return nrhs if m > n else 0
+
+def _inline_dims_func(builder, func, *dims):
+    # Shape values are index, cast them so they can be passed to the inlined
+    # function.
+    dims = tuple(builder.cast(d, builder.int64) for d in dims)
+    return builder.inline_func(func, *dims)
+
+def _as_matrix(builder, arr):
+    if len(arr.shape) == 2:
+        return arr
+    return builder.reshape(arr, (arr.shape[0], 1))
+
+@register_func('numpy.linalg.solve', numpy.linalg.solve)
+def solve_impl(builder, a, b):
+    dtype, (a, b) = _linalg_prepare(builder, (a, b), ((2,), (1, 2)))
+    if dtype is None:
+        return None
+
+    b2 = _as_matrix(builder, b)
+    res = builder.init_tensor(b2.shape, dtype)
+    res = builder.external_call(_linalg_func_name(builder, 'solve', dtype), (a, b2), res)[0]
+    if len(b.shape) == 1:
+        res = builder.reshape(res, b.shape[0])
+    return res
+
+def _square_linalg_impl(builder, name, a):
+    dtype, (a,) = _linalg_prepare(builder, (a,), ((2,),))
+    if dtype is None:
+        return None
+
+    res = builder.init_tensor(a.shape, dtype)
+    return builder.external_call(_linalg_func_name(builder, name, dtype), a, res)[0]
+
+@register_func('numpy.linalg.inv', numpy.linalg.inv)
+def inv_impl(builder, a):
+    return _square_linalg_impl(builder, 'inv', a)
+
+@register_func('numpy.linalg.cholesky', numpy.linalg.cholesky)
+def cholesky_impl(builder, a):
+    return _square_linalg_impl(builder, 'cholesky', a)
+
+@register_func('numpy.linalg.qr', numpy.linalg.qr)
+def qr_impl(builder, a):
+    dtype, (a,) = _linalg_prepare(builder, (a,), ((2,),))
+    if dtype is None:
+        return None
+
+    m, n = a.shape
+    k = _inline_dims_func(builder, _min_dim_impl, m, n)
+    q = builder.init_tensor((m, k), dtype)
+    r = builder.init_tensor((k, n), dtype)
+    return builder.external_call(_linalg_func_name(builder, 'qr', dtype), a, (q, r))
+
+def _eig_impl(builder, name, arg):
+    dtype, (arg,) = _linalg_prepare(builder, (arg,), ((2,),))
+    if dtype is None:
+        return None
+
+    size = arg.shape[0]
+    vals = builder.init_tensor([size], dtype)
+    vecs = builder.init_tensor([size,size], dtype)
+    return builder.external_call(_linalg_func_name(builder, name, dtype), arg, (vals, vecs))
+
+@register_func('numpy.linalg.eigh', numpy.linalg.eigh)
+def eigh_impl(builder, arg):
+    return _eig_impl(builder, 'eigh', arg)
+
+# Only real eigenvalues are supported, runtime reports error for non-symmetric
+# input.
 @register_func('numpy.linalg.eig', numpy.linalg.eig)
 def eig_impl(builder, arg):
-    shape = arg.shape
-    if len(shape) == 2:
-        dtype = arg.dtype
-        func_name = f'dpcomp_linalg_eig_{dtype_str(builder, dtype)}'
-        size = shape[0]
-        vals = builder.init_tensor([size], dtype)
-        vecs = builder.init_tensor([size,size], dtype)
-        return builder.external_call(func_name, arg, (vals, vecs))
+    return _eig_impl(builder, 'eig', arg)
+
+@register_func('numpy.linalg.lstsq', numpy.linalg.lstsq)
+def lstsq_impl(builder, a, b, rcond=None):
+    dtype, (a, b) = _linalg_prepare(builder, (a, b), ((2,), (1, 2)))
+    if dtype is None:
+        return None
+
+    # Negative rcond is replaced with machine precision times max(m, n) by the
+    # runtime.
+    rcond = builder.cast(-1 if rcond is None else rcond, dtype)
+    b2 = _as_matrix(builder, b)
+    m, n = a.shape
+    nrhs = b2.shape[1]
+    k = _inline_dims_func(builder, _min_dim_impl, m, n)
+    res_size = _inline_dims_func(builder, _lstsq_residuals_size_impl, m, n, nrhs)
+    x = builder.init_tensor((n, nrhs), dtype)
+    residuals = builder.init_tensor([res_size], dtype)
+    rank = builder.init_tensor([1], builder.int64)
+    s = builder.init_tensor([k], dtype)
+    func_name = _linalg_func_name(builder, 'lstsq', dtype)
+    x, residuals, rank, s = builder.external_call(func_name, (a, b2, rcond), (x, residuals, rank, s))
+    if len(b.shape) == 1:
+        x = builder.reshape(x, n)
+    return (x, residuals, builder.extract(rank, 0), s)
 
 @register_func('numpy.atleast_2d', numpy.atleast_2d)
 def atleast2d_impl(builder, arr):
@@ -301,6 +809,19 @@ def _cov_impl_inner(X, ddof):
     c = c * numpy.true_divide(1, fact)
     return c
 
+def _cov_runtime_impl(builder, X, ddof, name):
+    # De-meaning, symmetric product and scaling are fused by the runtime, only
+    # lower triangle of the product is computed.
+    dtype = X.dtype
+    if dtype != builder.float32 and dtype != builder.float64:
+        return None
+
+    size = X.shape[0]
+    res = builder.init_tensor((size, size), dtype)
+    ddof = builder.cast(ddof, dtype)
+    func_name = f'dpcomp_{name}_{dtype_str(builder, dtype)}'
+    return builder.external_call(func_name, (X, ddof), res)[0]
+
 def _prepare_cov_input(builder, m, y, rowvar):
     def get_func():
         if y is None:
@@ -358,7 +879,22 @@ def cov_impl(builder, m, y=None, rowvar=True, bias=False, ddof=None):
         y = asarray(builder, y)
     X = _prepare_cov_input(builder, m, y, rowvar)
     ddof = builder.inline_func(_cov_get_ddof_func(ddof is None), bias, ddof)
-    res = builder.inline_func(_cov_impl_inner, X, ddof)
+    res = _cov_runtime_impl(builder, X, ddof, 'cov')
+    if res is None:
+        res = builder.inline_func(_cov_impl_inner, X, ddof)
     if _cov_scalar_result_expected(m, y):
         res = res[0, 0]
     return res
+
+@register_func('numpy.corrcoef', numpy.corrcoef)
+def corrcoef_impl(builder, x, y=None, rowvar=True):
+    x = asarray(builder, x)
+    if not y is None:
+        y = asarray(builder, y)
+    X = _prepare_cov_input(builder, x, y, rowvar)
+    res = _cov_runtime_impl(builder, X, 1, 'corrcoef')
+    if res is None:
+        return None
+    if _cov_scalar_result_expected(x, y):
+        res = res[0, 0]
+    return res
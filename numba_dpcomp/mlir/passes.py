@@ -18,7 +18,7 @@ from numba.core import (types)
 import numba.core.types.functions
 from contextlib import contextmanager
 
-from .settings import DUMP_IR, DEBUG_TYPE, OPT_LEVEL, DUMP_DIAGNOSTICS
+from .settings import DUMP_IR, DEBUG_TYPE, OPT_LEVEL, DUMP_DIAGNOSTICS, TILE_SIZE, VECTOR_LENGTH, POOL_ALLOCATOR, STACK_PROMOTION_SIZE, BOUNDS_CHECK
 from . import func_registry
 from .. import mlir_compiler
 
@@ -124,6 +124,7 @@ class MlirBackendBase(FunctionPass):
             'print_callback' : write_print_buffer}
         ctx['typemap'] = lambda op: state.typemap[op.name]
         ctx['fnargs'] = lambda: state.args
+        ctx['fnargs_layouts'] = lambda: [a.layout if isinstance(a, types.Array) else '' for a in state.args]
         ctx['restype'] = lambda: state.return_type
         ctx['fnname'] = lambda: fn_name
         ctx['resolve_func'] = self._resolve_func_name
@@ -131,6 +132,11 @@ class MlirBackendBase(FunctionPass):
         ctx['force_inline'] = lambda: state.flags.inline.is_always_inline
         ctx['max_concurrency'] = lambda: get_thread_count() if state.flags.auto_parallel.enabled else 0
         ctx['opt_level'] = lambda: OPT_LEVEL
+        ctx['tile_size'] = lambda: TILE_SIZE
+        ctx['vector_length'] = lambda: VECTOR_LENGTH
+        ctx['pool_allocator'] = lambda: POOL_ALLOCATOR
+        ctx['stack_promotion_size'] = lambda: STACK_PROMOTION_SIZE
+        ctx['bounds_check'] = lambda: bool(BOUNDS_CHECK)
         return ctx
 
 @register_pass(mutates_CFG=True, analysis_only=False)
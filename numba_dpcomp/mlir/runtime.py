@@ -30,6 +30,22 @@ _finalize_func = runtime_lib.dpcomp_parallel_finalize
 _parallel_for_func = runtime_lib.dpcomp_parallel_for
 ll.add_symbol('dpcomp_parallel_for', ctypes.cast(_parallel_for_func, ctypes.c_void_p).value)
 
+def _init_memory():
+    from numba.core.runtime import _nrt_python
+    helpers = _nrt_python.c_helpers
+    # External allocators are not available in older numba versions, runtime
+    # will fallback to default NRT allocator in this case.
+    alloc_external = helpers.get('MemInfo_alloc_safe_aligned_external', 0)
+    alloc = helpers['MemInfo_alloc_safe_aligned']
+    init_func = runtime_lib.dpcomp_memory_init
+    init_func.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+    init_func(alloc_external, alloc)
+
+_init_memory()
+
+_alloc_meminfo_func = runtime_lib.dpcomp_alloc_meminfo
+ll.add_symbol('dpcomp_alloc_meminfo', ctypes.cast(_alloc_meminfo_func, ctypes.c_void_p).value)
+
 @atexit.register
 def _cleanup():
     _finalize_func()
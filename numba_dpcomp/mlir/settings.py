@@ -13,19 +13,23 @@
 # limitations under the License.
 
 from os import environ
+import warnings
 
 from ..mlir_compiler import is_dpnp_supported
 
 def _readenv(name, ctor, default):
+    def get_default():
+        return default() if callable(default) else default
+
     value = environ.get(name)
     if value is None:
-        return default() if callable(default) else default
+        return get_default()
     try:
         return ctor(value)
     except Exception:
         warnings.warn("environ %s defined but failed to parse '%s'" %
                       (name, value), RuntimeWarning)
-        return default
+        return get_default()
 
 USE_MLIR = _readenv('DPCOMP_ENABLE', int, 1)
 DUMP_PLIER = _readenv('DPCOMP_DUMP_PLIER', int, 0)
@@ -34,3 +38,22 @@ DUMP_DIAGNOSTICS = _readenv('DPCOMP_DUMP_DIAGNOSTICS', int, 0)
 DEBUG_TYPE = list(filter(None, _readenv('DPCOMP_DEBUG_TYPE', str, '').split(',')))
 DPNP_AVAILABLE = is_dpnp_supported() # TODO: check if dpnp library is available at runtime
 OPT_LEVEL = _readenv('DPCOMP_OPT_LEVEL', int, 3)
+
+def _get_host_vector_length():
+    try:
+        import llvmlite.binding as ll
+        features = ll.get_host_cpu_features()
+    except Exception:
+        return 16
+
+    if features.get('avx512f', False):
+        return 64
+    if features.get('avx', False):
+        return 32
+    return 16
+
+TILE_SIZE = _readenv('DPCOMP_TILE_SIZE', int, 32)
+VECTOR_LENGTH = _readenv('DPCOMP_VECTOR_LENGTH', int, _get_host_vector_length)
+POOL_ALLOCATOR = _readenv('DPCOMP_POOL_ALLOCATOR', int, 1)
+STACK_PROMOTION_SIZE = _readenv('DPCOMP_STACK_PROMOTION_SIZE', int, 1024)
+BOUNDS_CHECK = _readenv('DPCOMP_BOUNDS_CHECK', int, 0)
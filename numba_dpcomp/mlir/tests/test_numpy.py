@@ -14,18 +14,20 @@
 
 import numba
 # from numba_dpcomp import njit
-from numba_dpcomp import vectorize
+from numba_dpcomp import vectorize, guvectorize
 from numba_dpcomp.mlir.passes import print_pass_ir, get_print_buffer
+from numba_dpcomp.mlir.math_runtime import vector_math_available
 from numpy.testing import assert_equal, assert_allclose # for nans comparison
 import numpy as np
 from numba.tests.support import TestCase
 import unittest
 import itertools
+import re
 from functools import partial
 import pytest
 from sklearn.datasets import make_regression
 
-from .utils import parametrize_function_variants
+from .utils import parametrize_function_variants, check_runtime_error
 from .utils import njit_cached as njit
 
 np.seterr(all='ignore')
@@ -90,6 +92,12 @@ _test_binary_test_arrays_ids = ['1', '2.5', 'np.array([1,2,3])', 'np.array([4.4,
     'lambda a, b: a ** b',
     'lambda a, b: np.true_divide(a, b)',
     'lambda a, b: a / b',
+    'lambda a, b: np.greater(a, b)',
+    'lambda a, b: a > b',
+    'lambda a, b: np.less_equal(a, b)',
+    'lambda a, b: a <= b',
+    'lambda a, b: np.equal(a, b)',
+    'lambda a, b: a != b',
 ])
 @pytest.mark.parametrize("a",
                          _test_binary_test_arrays,
@@ -101,6 +109,70 @@ def test_binary(py_func, a, b):
     jit_func = njit(py_func)
     assert_equal(py_func(a,b), jit_func(a,b))
 
+@parametrize_function_variants("py_func", [
+    'lambda a: np.sqrt(a)',
+    'lambda a: np.log(a)',
+    'lambda a: np.sin(a)',
+    'lambda a: np.cos(a)',
+    'lambda a: np.true_divide(a, a)',
+    'lambda a: a / 2.0',
+    'lambda a: a * 2.5 + 1',
+])
+@pytest.mark.parametrize("dtype", [np.float32, np.float64])
+def test_result_dtype(py_func, dtype):
+    jit_func = njit(py_func)
+    a = np.arange(1, 11, dtype=dtype)
+    expected = py_func(a)
+    res = jit_func(a)
+    assert res.dtype == expected.dtype
+    assert_allclose(res, expected, rtol=1e-6)
+
+@pytest.mark.parametrize("dtype", [np.int16, np.int32, np.float32])
+def test_sqrt_int_dtype(dtype):
+    def py_func(a):
+        return np.sqrt(a)
+
+    jit_func = njit(py_func)
+    a = np.arange(1, 11, dtype=dtype)
+    expected = py_func(a)
+    res = jit_func(a)
+    assert res.dtype == expected.dtype
+    assert_allclose(res, expected, rtol=1e-6)
+
+@pytest.mark.parametrize("dtype1,dtype2", [
+    (np.int8, np.uint8),
+    (np.int32, np.uint32),
+    (np.int64, np.uint64),
+    (np.int16, np.float32),
+    (np.int32, np.float32),
+    (np.float32, np.float64),
+])
+def test_broadcast_dtype(dtype1, dtype2):
+    def py_func(a, b):
+        return a + b
+
+    jit_func = njit(py_func)
+    a = np.arange(5, dtype=dtype1)
+    b = np.arange(5, dtype=dtype2)
+    expected = py_func(a, b)
+    res = jit_func(a, b)
+    assert res.dtype == expected.dtype
+    assert_equal(res, expected)
+
+def test_float32_math():
+    def py_func(a, b):
+        return np.sqrt(a) / b + 1.0
+
+    with print_pass_ir([],['PostLinalgOptPass']):
+        jit_func = njit(py_func)
+        a = np.arange(1, 11, dtype=np.float32)
+        b = np.arange(1, 11, dtype=np.float32)
+        assert_allclose(py_func(a, b), jit_func(a, b), rtol=1e-6)
+        ir = get_print_buffer()
+        assert ir.count('math.sqrt') > 0, ir
+        assert ir.count('@sqrt') == 0, ir
+        assert ir.count('memref<?xf64>') == 0, ir
+
 _test_broadcast_test_arrays = [
     1,
     np.array([1]),
@@ -174,6 +246,139 @@ def test_array_len():
     arr = np.asarray([5,6,7])
     assert_equal(py_func(arr), jit_func(arr))
 
+@parametrize_function_variants("py_func", [
+    'lambda a: a[a > 2]',
+    'lambda a: a[a != a.max()]',
+    'lambda a: a[a < 0]',
+    ])
+@pytest.mark.parametrize("arr", [
+    np.array([3,1,4,1,5,9,2,6], dtype=np.int32),
+    np.array([[3,1,4,1],[5,9,2,6]], dtype=np.int64),
+    np.array([[2.5,-1.5,7.0],[-3.0,7.0,0.5]], dtype=np.float32).T,
+    ])
+def test_mask_getitem(py_func, arr):
+    jit_func = njit(py_func)
+    assert_equal(py_func(arr), jit_func(arr))
+
+def test_mask_getitem_large():
+    def py_func(a, m):
+        return a[m]
+
+    jit_func = njit(py_func)
+    arr = np.arange(100003)
+    mask = arr % 3 == 1
+    assert_equal(py_func(arr, mask), jit_func(arr, mask))
+
+@pytest.mark.parametrize("arr", [
+    np.array([3,1,4,1,5,9,2,6], dtype=np.int32),
+    np.array([[2.5,-1.5,7.0],[-3.0,7.0,0.5]], dtype=np.float64),
+    ])
+def test_mask_setitem(arr):
+    def py_func(a):
+        a[a > 2] = 0
+        return a
+
+    jit_func = njit(py_func)
+    assert_equal(py_func(arr.copy()), jit_func(arr.copy()))
+
+@pytest.mark.parametrize("code", [
+    'njit(lambda a, m: a[m])(np.ones((2, 3)), np.ones((3, 2), dtype=np.bool_))',
+    'njit(lambda a, m: a[m])(np.ones(4), np.ones(3, dtype=np.bool_))',
+    'def f(a, m):\n    a[m] = 0\n'
+    'njit(f)(np.ones((2, 3)), np.ones((3, 2), dtype=np.bool_))',
+    ])
+def test_mask_shape_mismatch(code):
+    check_runtime_error(code, 'boolean index did not match indexed array')
+
+@parametrize_function_variants("py_func", [
+    'lambda a, i: a[i]',
+    'lambda a, i: np.take(a, i)',
+    'lambda a, i: np.take(a, i, axis=0)',
+    'lambda a, i: np.take(a, i, axis=-1)',
+    ])
+@pytest.mark.parametrize("arr", [
+    np.array([3,1,4,1,5,9,2,6], dtype=np.int32),
+    np.array([[3,1,4],[1,5,9],[2,6,5]], dtype=np.int64),
+    np.array([[2.5,-1.5,7.0],[-3.0,7.0,0.5],[1.0,2.0,3.0]], dtype=np.float32).T,
+    ])
+@pytest.mark.parametrize("indices", [
+    np.array([0,2,1,2], dtype=np.int64),
+    np.array([-1,0], dtype=np.int32),
+    np.array([[2,0],[1,1]], dtype=np.int64),
+    ])
+def test_gather(py_func, arr, indices):
+    jit_func = njit(py_func)
+    assert_equal(py_func(arr, indices), jit_func(arr, indices))
+
+def test_gather_embedding():
+    def py_func(table, ids):
+        return table[ids].sum(axis=1)
+
+    jit_func = njit(py_func)
+    table = np.arange(1000 * 16, dtype=np.float32).reshape(1000, 16)
+    ids = (np.arange(4096 * 8) * 7919 % 1000).reshape(4096, 8)
+    assert_allclose(py_func(table, ids), jit_func(table, ids), rtol=1e-6)
+
+@pytest.mark.parametrize("arr,indices,values", [
+    (np.arange(8, dtype=np.int32), np.array([1,5,-1], dtype=np.int64), 42),
+    (np.arange(8, dtype=np.float64), np.array([3,3,0]), np.array([1.5,2.5,3.5])),
+    (np.arange(12, dtype=np.float32).reshape(4,3), np.array([2,0]), 7),
+    (np.arange(12, dtype=np.int64).reshape(4,3), np.array([3,1,3]),
+     np.array([[1,2,3],[4,5,6],[7,8,9]], dtype=np.int64)),
+    ])
+def test_scatter(arr, indices, values):
+    def py_func(a, i, v):
+        a[i] = v
+        return a
+
+    jit_func = njit(py_func)
+    assert_equal(py_func(arr.copy(), indices, values),
+                 jit_func(arr.copy(), indices, values))
+
+_scatter_code = 'def f(a, i, v):\n    a[i] = v\nnjit(f)'
+
+@pytest.mark.parametrize("args", [
+    'np.zeros(8), np.array([1,2]), np.ones(3)',
+    'np.zeros((4, 3)), np.array([1,2]), np.ones((3, 3))',
+    'np.zeros((4, 3)), np.array([1,2]), np.ones((2, 2))',
+    ])
+def test_scatter_shape_mismatch(args):
+    check_runtime_error(f'{_scatter_code}({args})', 'shape mismatch')
+
+@pytest.mark.parametrize("args", [
+    'np.zeros(8), np.array([1,8]), 1.0',
+    'np.zeros((4, 3)), np.array([-5]), np.ones((1, 3))',
+    ])
+def test_scatter_bounds_check(args):
+    check_runtime_error(f'{_scatter_code}({args})', 'is out of bounds',
+                        env={'DPCOMP_BOUNDS_CHECK': '1'})
+
+@parametrize_function_variants("py_func", [
+    'lambda a, b: np.where(a > b, a, b)',
+    'lambda a, b: np.where(a > 2, a, 0)',
+    'lambda a, b: np.where(a < b, 1.5, b)',
+    ])
+@pytest.mark.parametrize("a,b", [
+    (np.array([3,1,4,1,5], dtype=np.int32), np.array([2,7,1,8,2], dtype=np.int32)),
+    (np.array([[3,1],[4,1]], dtype=np.float32), np.array([2,7], dtype=np.float64)),
+    ])
+def test_where(py_func, a, b):
+    jit_func = njit(py_func)
+    assert_equal(py_func(a, b), jit_func(a, b))
+
+def test_where_select():
+    def py_func(c, a, b):
+        return np.where(c, a, b)
+
+    with print_pass_ir([],['PostLinalgOptPass']):
+        jit_func = njit(py_func)
+        c = np.arange(1001) % 3 == 0
+        a = np.arange(1001, dtype=np.float32)
+        b = -a
+        assert_equal(py_func(c, a, b), jit_func(c, a, b))
+        ir = get_print_buffer()
+        assert ir.count('select') > 0, ir
+
 @parametrize_function_variants("py_func", [
     'lambda a: np.sum(a, axis=0)',
     'lambda a: np.sum(a, axis=1)',
@@ -186,6 +391,203 @@ def test_sum_axis(py_func, arr):
     jit_func = njit(py_func)
     assert_equal(py_func(arr), jit_func(arr))
 
+@parametrize_function_variants("py_func", [
+    'lambda a: a.min()',
+    'lambda a: np.amin(a)',
+    'lambda a: a.max()',
+    'lambda a: np.amax(a)',
+    'lambda a: a.prod()',
+    'lambda a: np.prod(a)',
+    'lambda a: a.argmin()',
+    'lambda a: np.argmin(a)',
+    'lambda a: a.argmax()',
+    'lambda a: np.argmax(a)',
+    'lambda a: a.mean()',
+    'lambda a: np.var(a)',
+    'lambda a: np.std(a)',
+    ])
+@pytest.mark.parametrize("arr", [
+    np.array([3,1,4,1,5,9,2,6], dtype=np.int32),
+    np.array([3,1,4,1,5,9,2,6], dtype=np.uint8),
+    np.array([2.5,-1.5,7.0,-1.5,7.0,0.5], dtype=np.float32),
+    np.array([[3,1,4,1],[5,9,2,6],[5,3,5,8]], dtype=np.int64),
+    np.array([[2.5,-1.5,7.0],[-3.0,7.0,0.5]], dtype=np.float64),
+    ])
+def test_reduce(py_func, arr):
+    jit_func = njit(py_func)
+    assert_allclose(py_func(arr), jit_func(arr), rtol=1e-6)
+
+@parametrize_function_variants("py_func", [
+    'lambda a: np.amin(a, axis=0)',
+    'lambda a: np.amax(a, axis=1)',
+    'lambda a: np.prod(a, axis=0)',
+    'lambda a: np.argmin(a, axis=0)',
+    'lambda a: np.argmax(a, axis=1)',
+    'lambda a: np.argmax(a, axis=-1)',
+    'lambda a: np.mean(a, axis=0)',
+    'lambda a: np.mean(a, axis=1)',
+    'lambda a: np.var(a, axis=0)',
+    'lambda a: np.std(a, axis=1)',
+    ])
+@pytest.mark.parametrize("arr", [
+    np.array([[3,1,4,1],[5,9,2,6],[5,3,5,8]], dtype=np.int32),
+    np.array([[2.5,-1.5,7.0],[-3.0,7.0,0.5]], dtype=np.float32),
+    np.array([[2.5,-1.5,7.0],[-3.0,7.0,0.5]], dtype=np.float64).T,
+    ])
+def test_reduce_axis(py_func, arr):
+    jit_func = njit(py_func)
+    assert_allclose(py_func(arr), jit_func(arr), rtol=1e-6)
+
+@parametrize_function_variants("py_func", [
+    'lambda a: a.min()',
+    'lambda a: a.max()',
+    'lambda a: a.argmin()',
+    'lambda a: a.argmax()',
+    'lambda a: np.amin(a, axis=0)',
+    'lambda a: np.amax(a, axis=1)',
+    'lambda a: np.argmin(a, axis=0)',
+    'lambda a: np.argmax(a, axis=1)',
+    ])
+@pytest.mark.parametrize("arr", [
+    np.array([[2.5,np.nan,7.0],[-3.0,7.0,np.nan]], dtype=np.float64),
+    np.array([[np.nan,-1.5,np.nan],[-3.0,np.nan,0.5]], dtype=np.float32),
+    np.full((2,3), np.nan),
+    ])
+def test_reduce_minmax_nan(py_func, arr):
+    jit_func = njit(py_func)
+    assert_equal(py_func(arr), jit_func(arr))
+
+@parametrize_function_variants("py_func", [
+    'lambda a: a.min()',
+    'lambda a: a.max()',
+    'lambda a: np.amin(a, axis=0)',
+    'lambda a: np.amax(a, axis=1)',
+    ])
+@pytest.mark.parametrize("arr", [
+    np.array([[True,False,True],[True,True,True]]),
+    np.zeros((2,3), dtype=np.bool_),
+    np.ones((2,3), dtype=np.bool_),
+    ])
+def test_reduce_minmax_bool(py_func, arr):
+    jit_func = njit(py_func)
+    assert_equal(py_func(arr), jit_func(arr))
+
+@pytest.mark.parametrize("py_func", [
+    'a.min()',
+    'np.amax(a)',
+    'np.argmin(a)',
+    'np.argmax(a, axis=0)',
+    ])
+def test_reduce_minmax_empty(py_func):
+    check_runtime_error(f'njit(lambda a: {py_func})(np.empty((0, 3)))',
+                         'zero-size array to reduction operation')
+
+@pytest.mark.parametrize("dtype", [np.int32, np.float32, np.float64])
+def test_reduce_minmax_parallel(dtype):
+    def py_func(a):
+        return a.min() + a.max()
+
+    with print_pass_ir([],['PostLinalgOptPass']):
+        jit_func = njit(py_func)
+        a = np.arange(1001, dtype=dtype)[::-1]
+        assert_equal(py_func(a), jit_func(a))
+        ir = get_print_buffer()
+        # Both reductions are fused into single parallel loop.
+        assert ir.count('scf.parallel') == 1, ir
+        assert ir.count('scf.reduce(') == 2, ir
+
+def test_reduce_mean_std_parallel():
+    def py_func(a):
+        return a.mean(), np.std(a)
+
+    with print_pass_ir([],['PostLinalgOptPass']):
+        jit_func = njit(py_func)
+        a = np.linspace(-1, 1, 1001)
+        assert_allclose(py_func(a), jit_func(a), rtol=1e-12)
+        ir = get_print_buffer()
+        # Sum for mean and sum of squared deviations for std.
+        assert ir.count('scf.reduce(') >= 2, ir
+
+@parametrize_function_variants("py_func", [
+    'lambda a: np.cumsum(a)',
+    'lambda a: np.cumprod(a)',
+    'lambda a: a.cumsum()',
+    'lambda a: np.cumsum(a, axis=0)',
+    'lambda a: np.cumsum(a, axis=1)',
+    'lambda a: np.cumprod(a, axis=-1)',
+    ])
+@pytest.mark.parametrize("arr", [
+    np.array([[3,1,4,1],[5,9,2,6],[5,3,5,8]], dtype=np.int32),
+    np.array([[2.5,-1.5,7.0],[-3.0,7.0,0.5]], dtype=np.float32),
+    np.array([[2.5,-1.5,7.0],[-3.0,7.0,0.5]], dtype=np.float64).T,
+    ])
+def test_scan(py_func, arr):
+    jit_func = njit(py_func)
+    assert_allclose(py_func(arr), jit_func(arr), rtol=1e-6)
+
+@pytest.mark.parametrize("shape", [(100003,), (2, 50001), (50001, 3)])
+@pytest.mark.parametrize("dtype", [np.int64, np.float32, np.float64])
+def test_scan_large(shape, dtype):
+    def py_func(a):
+        return np.cumsum(a), np.cumsum(a, axis=0)
+
+    jit_func = njit(py_func)
+    # Small values, so float sums are exact regardless of the order.
+    a = (np.arange(np.prod(shape)) % 3).astype(dtype).reshape(shape)
+    assert_equal(py_func(a), jit_func(a))
+
+_test_sort_arrays = [
+    np.array([[3,1,4,1],[5,9,2,6],[5,3,5,8]], dtype=np.int32),
+    np.array([[3,-1,4,1],[5,9,-2,6],[5,3,5,-8]], dtype=np.int8),
+    np.array([[2.5,np.nan,-0.0],[-3.0,0.0,np.inf],[np.nan,-np.inf,0.5]], dtype=np.float32),
+    np.array([[2.5,np.nan,7.0],[-3.0,7.0,0.5]], dtype=np.float64).T,
+]
+
+@parametrize_function_variants("py_func", [
+    'lambda a: np.sort(a)',
+    'lambda a: np.sort(a, axis=0)',
+    'lambda a: np.sort(a, axis=None)',
+    ])
+@pytest.mark.parametrize("arr", _test_sort_arrays)
+def test_sort(py_func, arr):
+    jit_func = njit(py_func)
+    assert_equal(py_func(arr), jit_func(arr))
+
+@pytest.mark.parametrize("axis", [-1, 0, None])
+@pytest.mark.parametrize("arr", _test_sort_arrays)
+def test_argsort(arr, axis):
+    def py_func(a):
+        return np.argsort(a, axis=axis, kind='stable')
+
+    def jit_impl(a):
+        return np.argsort(a, axis=axis)
+
+    # Runtime argsort is always stable.
+    jit_func = njit(jit_impl)
+    assert_equal(py_func(arr), jit_func(arr))
+
+def test_argsort_method():
+    def py_func(a):
+        return a.argsort(axis=0)
+
+    jit_func = njit(py_func)
+    arr = np.array([[3,1,4],[1,5,9],[2,6,5]], dtype=np.int64)
+    assert_equal(py_func(arr), jit_func(arr))
+
+@pytest.mark.parametrize("dtype", [np.int16, np.int64, np.float32, np.float64])
+def test_sort_large(dtype):
+    def py_func(a):
+        return np.sort(a), np.argsort(a, kind='stable')
+
+    def jit_impl(a):
+        return np.sort(a), np.argsort(a)
+
+    jit_func = njit(jit_impl)
+    arr = (np.arange(200003) * 7919 % 10007 - 5000).astype(dtype)
+    if np.issubdtype(dtype, np.floating):
+        arr[::101] = np.nan
+    assert_equal(py_func(arr), jit_func(arr))
+
 def test_sum_add():
     def py_func(a, b):
         return np.add(a, b).sum()
@@ -218,6 +620,80 @@ def test_dot(a, b, parallel):
     jit_func = njit(py_func, parallel=parallel)
     assert_equal(py_func(a, b), jit_func(a, b))
 
+def _gen_matmul_args(m, k, n, dtype):
+    a = (np.arange(m * k) % 7).reshape(m, k).astype(dtype)
+    b = (np.arange(k * n) % 5 - 2).reshape(k, n).astype(dtype)
+    return a, b
+
+@pytest.mark.parametrize("m,k,n", [(1,1,1), (3,5,7), (64,64,64), (129,257,65), (300,17,500)])
+@pytest.mark.parametrize("dtype", [np.float32, np.float64, np.int32])
+@pytest.mark.parametrize("transpose", [False, True])
+def test_dot_matmul(m, k, n, dtype, transpose):
+    def py_func(a, b):
+        return np.dot(a, b)
+
+    def py_func_t(a, b):
+        return np.dot(a.T, b.T)
+
+    a, b = _gen_matmul_args(m, k, n, dtype)
+    if transpose:
+        a, b = np.ascontiguousarray(a.T), np.ascontiguousarray(b.T)
+        func = py_func_t
+    else:
+        func = py_func
+
+    jit_func = njit(func)
+    assert_allclose(func(a, b), jit_func(a, b), rtol=1e-4)
+
+@pytest.mark.parametrize("m,k", [(1,1), (3,5), (100,300), (1001,7)])
+@pytest.mark.parametrize("dtype", [np.float32, np.float64, np.int64])
+def test_dot_matvec(m, k, dtype):
+    def py_func1(a, b):
+        return np.dot(a, b)
+
+    def py_func2(a, b):
+        return np.dot(b, a.T)
+
+    a, b = _gen_matmul_args(m, k, 1, dtype)
+    b = b.reshape(k)
+    for func in (py_func1, py_func2):
+        jit_func = njit(func)
+        assert_allclose(func(a, b), jit_func(a, b), rtol=1e-4)
+
+@pytest.mark.parametrize("a,b", [
+    (np.array([1,2,3], np.float32), np.array([4,5,6], np.float32)),
+    (np.array([[1,2,3],[4,5,6]], np.float64), np.array([1,2,3], np.float64)),
+    (np.array([[1,2,3],[4,5,6]], np.float32), np.array([[1,2],[3,4],[5,6]], np.float32)),
+    ])
+def test_matmul_op(a, b):
+    def py_func(a, b):
+        return a @ b
+
+    jit_func = njit(py_func)
+    assert_equal(py_func(a, b), jit_func(a, b))
+
+@pytest.mark.parametrize("args", [
+    'np.ones((2, 3)), np.ones((4, 2))',
+    'np.ones((2, 3)), np.ones(4)',
+    'np.ones(3), np.ones((4, 2))',
+    'np.ones((2, 3), np.int64), np.ones((4, 2), np.int64)',
+    'np.ones((2, 3), np.int64), np.ones(4, np.int64)',
+    ])
+def test_matmul_shape_mismatch(args):
+    check_runtime_error(f'njit(lambda a, b: a @ b)({args})',
+                        'matmul: shapes')
+
+@pytest.mark.parametrize("batch1,batch2", [(3, 3), (1, 3), (3, 1), (1, 1)])
+@pytest.mark.parametrize("dtype", [np.float32, np.float64])
+def test_matmul_op_batch(batch1, batch2, dtype):
+    def py_func(a, b):
+        return a @ b
+
+    jit_func = njit(py_func)
+    a = np.arange(batch1 * 4 * 5, dtype=dtype).reshape(batch1, 4, 5) / 10
+    b = np.arange(batch2 * 5 * 6, dtype=dtype).reshape(batch2, 5, 6) / 10
+    assert_allclose(py_func(a, b), jit_func(a, b), rtol=1e-5)
+
 def test_prange_lowering():
     def py_func(arr):
         res = 0
@@ -233,6 +709,336 @@ def test_prange_lowering():
         ir = get_print_buffer()
         assert ir.count('plier.parallel') == 1, ir
 
+@pytest.mark.parametrize("k", [1, 7, 64])
+def test_prange_temporary_hoisting(k):
+    def py_func(a, k):
+        res = np.empty(a.shape[0])
+        for i in numba.prange(a.shape[0]):
+            tmp = np.empty(k)
+            for j in range(k):
+                tmp[j] = a[i] * j
+            res[i] = tmp.sum()
+        return res
+
+    with print_pass_ir([],['ParallelToTbbPass']):
+        jit_func = njit(py_func)
+        a = np.arange(1000, dtype=np.float64)
+        assert_allclose(py_func(a, k), jit_func(a, k))
+        ir = get_print_buffer()
+        assert ir.count('plier.parallel') == 1, ir
+        loop_body = ir[ir.index('scf.parallel'):]
+        assert loop_body.count('memref.alloc(') == 0, ir
+
+def test_range_alias_versioning():
+    def py_func(a, out):
+        for i in range(len(a)):
+            out[i] = a[i] * 2
+
+    with print_pass_ir([],['PostLinalgOptPass']):
+        jit_func = njit(py_func)
+        a = np.arange(1000, dtype=np.float32)
+        res1 = np.zeros_like(a)
+        res2 = np.zeros_like(a)
+        py_func(a, res1)
+        jit_func(a, res2)
+        assert_equal(res1, res2)
+        ir = get_print_buffer()
+        assert ir.count('scf.parallel') == 1, ir
+        assert ir.count('scf.for') == 1, ir
+
+    # overlapping arguments must use serial loop
+    a1 = np.arange(1000, dtype=np.float32)
+    a2 = a1.copy()
+    py_func(a1[:-1], a1[1:])
+    jit_func(a2[:-1], a2[1:])
+    assert_equal(a1, a2)
+
+    # same array passed twice
+    a1 = np.arange(1000, dtype=np.float32)
+    a2 = a1.copy()
+    py_func(a1, a1)
+    jit_func(a2, a2)
+    assert_equal(a1, a2)
+
+def test_range_dependence_even_odd():
+    def py_func(a):
+        for i in range(len(a) // 2):
+            a[2 * i] = a[2 * i + 1]
+
+    with print_pass_ir([],['PostLinalgOptPass']):
+        jit_func = njit(py_func)
+        a1 = np.arange(1000, dtype=np.float32)
+        a2 = a1.copy()
+        py_func(a1)
+        jit_func(a2)
+        assert_equal(a1, a2)
+        ir = get_print_buffer()
+        assert ir.count('scf.parallel') == 1, ir
+
+@pytest.mark.parametrize("size", [1, 13, 1000, 300000])
+def test_alloc_temporaries(size):
+    def py_func(a, n):
+        res = np.zeros_like(a)
+        for i in range(n):
+            t = a * i + 1
+            res += t
+        return res
+
+    jit_func = njit(py_func)
+    a = np.arange(size, dtype=np.float32)
+    res = [jit_func(a, 10) for _ in range(20)]
+    expected = py_func(a, 10)
+    del a
+    for r in res:
+        assert_allclose(r, expected)
+
+def test_alloc_return_interop():
+    def py_func(n):
+        return np.ones(n) + 1
+
+    jit_func = njit(py_func)
+    res = [jit_func(i) for i in range(1, 200)]
+    for i, r in enumerate(res):
+        assert_equal(r, np.full(i + 1, 2.0))
+    res = res[::2]
+    res.append(jit_func(1 << 20))
+    assert res[-1].sum() == 2 * (1 << 20)
+
+def _gen_large_func(size):
+    # Long chain of loads and stores through the same arrays, stresses
+    # memory opts compile time.
+    lines = ['def py_func(a, b):']
+    for i in range(size):
+        lines.append(f'    a[{i % 7}] = (b[{i % 5}] + a[{(i + 3) % 7}]) * 0.5')
+        lines.append(f'    b[{i % 5}] = a[{i % 7}] + 1')
+    lines.append('    return a[0] + b[0]')
+    g = {}
+    exec('\n'.join(lines), g)
+    return g['py_func']
+
+@pytest.mark.parametrize("size", [10, 1000])
+def test_large_func_memory_opts(size):
+    py_func = _gen_large_func(size)
+    jit_func = njit(py_func)
+    a1 = np.arange(7, dtype=np.float64) / 7
+    b1 = np.arange(5, dtype=np.float64) / 5
+    a2 = a1.copy()
+    b2 = b1.copy()
+    assert_allclose(py_func(a1, b1), jit_func(a2, b2))
+    assert_allclose(a1, a2)
+    assert_allclose(b1, b2)
+
+@pytest.mark.parametrize("same", [False, True])
+def test_store_forwarding_alias(same):
+    def py_func(a, b):
+        a[0] = 1
+        a[1] = 2
+        b[0] = 3
+        c = np.empty(2)
+        c[0] = a[1]
+        c[1] = 4
+        return a[0] + a[1] + c[0] + c[1]
+
+    jit_func = njit(py_func)
+    a1 = np.zeros(3)
+    b1 = a1 if same else np.zeros(3)
+    a2 = np.zeros(3)
+    b2 = a2 if same else np.zeros(3)
+    assert_equal(py_func(a1, b1), jit_func(a2, b2))
+    assert_equal(a1, a2)
+    assert_equal(b1, b2)
+
+def test_scalar_replacement_reduction():
+    def py_func(a):
+        m, n = a.shape
+        res = np.empty((m, 1), dtype=a.dtype)
+        for i in numba.prange(m):
+            res[i, 0] = 0
+            for j in range(n):
+                res[i, 0] += a[i, j]
+        return res
+
+    jit_func = njit(py_func)
+    a = np.arange(35, dtype=np.float64).reshape(5, 7)
+    assert_allclose(py_func(a), jit_func(a))
+
+@pytest.mark.parametrize("size", [0, 1, 2, 3, 10])
+def test_scalar_replacement_stencil(size):
+    def py_func(a):
+        res = np.zeros(a.shape[0])
+        for i in range(1, a.shape[0] - 1):
+            res[i] = a[i - 1] + a[i] + a[i + 1]
+        return res
+
+    jit_func = njit(py_func)
+    a = np.arange(size, dtype=np.float64)
+    assert_equal(py_func(a), jit_func(a))
+
+def test_scalar_replacement_inplace():
+    def py_func(a):
+        for i in range(1, a.shape[0]):
+            a[i] = a[i - 1] + a[i]
+
+    jit_func = njit(py_func)
+    a1 = np.arange(10, dtype=np.float64)
+    a2 = a1.copy()
+    py_func(a1)
+    jit_func(a2)
+    assert_equal(a1, a2)
+
+@pytest.mark.parametrize("shape", [(3,), (3, 4), (2, 3, 4), (2, 3, 4, 5)])
+def test_transpose_nd(shape):
+    def py_func(a):
+        return a.T
+
+    jit_func = njit(py_func)
+    a = np.arange(np.prod(shape)).reshape(shape)
+    assert_equal(py_func(a), jit_func(a))
+
+def test_transpose_view():
+    def py_func(a, b):
+        return np.dot(a.T, b)
+
+    with print_pass_ir([],['CopyElisionPass']):
+        jit_func = njit(py_func)
+        a = np.arange(12, dtype=np.float64).reshape(4, 3)
+        b = np.arange(8, dtype=np.float64).reshape(4, 2)
+        assert_allclose(py_func(a, b), jit_func(a, b))
+        ir = get_print_buffer()
+        assert ir.count('memref.reinterpret_cast') > 0, ir
+
+def test_atleast2d_view():
+    def py_func(a):
+        return np.atleast_2d(a).sum()
+
+    jit_func = njit(py_func)
+    a = np.arange(5, dtype=np.float64)
+    assert_equal(py_func(a), jit_func(a))
+
+def test_getitem_reduce_rank():
+    def py_func(a):
+        res = 0
+        for i in range(a.shape[0]):
+            b = a[i, :]
+            for j in range(b.shape[0]):
+                res += b[j] * (i + 1)
+        return res
+
+    jit_func = njit(py_func)
+    a = np.arange(12).reshape(3, 4)
+    assert_equal(py_func(a), jit_func(a))
+
+_layout_test_arrays = [
+    np.arange(24, dtype=np.float64).reshape(4, 6),
+    np.arange(24, dtype=np.float64).reshape(4, 6)[:, 1:5],
+    np.arange(24, dtype=np.float64).reshape(4, 6)[:, ::2],
+    np.asfortranarray(np.arange(24, dtype=np.float64).reshape(4, 6)),
+]
+
+_layout_test_ids = ['C', 'slice', 'step', 'F']
+
+@pytest.mark.parametrize("a", _layout_test_arrays, ids=_layout_test_ids)
+def test_layout_elementwise(a):
+    def py_func(a):
+        return a * 2 + 1
+
+    jit_func = njit(py_func)
+    assert_equal(py_func(a), jit_func(a))
+
+@pytest.mark.parametrize("a", _layout_test_arrays, ids=_layout_test_ids)
+def test_layout_reduction(a):
+    def py_func(a):
+        res = 0.0
+        for i in range(a.shape[0]):
+            for j in range(a.shape[1]):
+                res += a[i, j]
+        return res
+
+    jit_func = njit(py_func)
+    assert_equal(py_func(a), jit_func(a))
+
+@pytest.mark.parametrize("a,versioned", [
+    (np.arange(10, dtype=np.float64), False),
+    (np.arange(10, dtype=np.float64)[::2], True),
+    ])
+def test_layout_versioning(a, versioned):
+    def py_func(a):
+        return a + 1
+
+    with print_pass_ir([],['MakeStridedLayout']):
+        jit_func = njit(py_func)
+        assert_equal(py_func(a), jit_func(a))
+        ir = get_print_buffer()
+        assert (ir.count('plier.extract_memref_metadata') > 0) == versioned, ir
+
+def test_retain_elision():
+    def py_func(a):
+        return a + 1
+
+    with print_pass_ir([],['ElideRetainReleasePass']):
+        jit_func = njit(py_func)
+        a = np.arange(10, dtype=np.float64)
+        assert_equal(py_func(a), jit_func(a))
+        ir = get_print_buffer()
+        assert ir.count('plier.retain') == 0, ir
+
+def test_retain_returned_arg():
+    def py_func(a):
+        return a
+
+    jit_func = njit(py_func)
+    res = jit_func(np.arange(10))
+    assert_equal(res, np.arange(10))
+
+def test_buffer_reuse_chain():
+    def py_func(a, b):
+        c = a * 2 + b
+        d = np.sqrt(c) - a
+        e = np.sin(d) * d
+        return e + 1
+
+    with print_pass_ir([],['MemoryPlanningPass']):
+        jit_func = njit(py_func)
+        a = np.arange(100, dtype=np.float32)
+        b = np.arange(100, dtype=np.float32) + 1
+        assert_allclose(py_func(a, b), jit_func(a, b), rtol=1e-5)
+        ir = get_print_buffer()
+        assert ir.count('memref.dealloc') <= 1, ir
+
+def test_small_array_promotion():
+    def py_func(a, b):
+        res = 0.0
+        for i in range(a.shape[0]):
+            v = np.empty(3)
+            v[0] = a[i, 1] * b[i, 2] - a[i, 2] * b[i, 1]
+            v[1] = a[i, 2] * b[i, 0] - a[i, 0] * b[i, 2]
+            v[2] = a[i, 0] * b[i, 1] - a[i, 1] * b[i, 0]
+            res += v[0] * v[0] + v[1] * v[1] + v[2] * v[2]
+        return res
+
+    with print_pass_ir([],['PromoteSmallBuffersPass']):
+        jit_func = njit(py_func)
+        a = np.arange(30, dtype=np.float64).reshape(10, 3)
+        b = np.arange(30, dtype=np.float64).reshape(10, 3)[::-1].copy()
+        assert_allclose(py_func(a, b), jit_func(a, b), rtol=1e-5)
+        ir = get_print_buffer()
+        assert ir.count('memref.alloc()') == 0, ir
+
+def _buffer_reuse_transposed(a):
+    t = a + 1
+    return t + t.T
+
+def _buffer_reuse_reversed(a):
+    t = a + 1
+    return t[::-1] + t
+
+@pytest.mark.parametrize("py_func", [_buffer_reuse_transposed, _buffer_reuse_reversed])
+@pytest.mark.parametrize("shape", [(7, 7), (64, 64)])
+def test_buffer_reuse_aliased(py_func, shape):
+    jit_func = njit(py_func)
+    a = np.arange(np.prod(shape), dtype=np.float32).reshape(shape)
+    assert_equal(py_func(a), jit_func(a))
+
 def test_loop_fusion1():
     def py_func(arr):
         l = len(arr)
@@ -298,6 +1104,162 @@ def test_loop_fusion3():
         assert ir.count('scf.parallel') == 2, ir
         assert ir.count('memref.load') == 2, ir
 
+def test_loop_fusion_shifted_index():
+    def py_func(arr):
+        l = len(arr) - 1
+        tmp = np.empty(len(arr))
+        for i in numba.prange(l):
+            tmp[i + 1] = arr[i] * 2
+
+        res = 0
+        for i in numba.prange(l):
+            res += tmp[i + 1]
+
+        return res
+
+    with print_pass_ir([],['PostLinalgOptPass']):
+        jit_func = njit(py_func)
+        arr = np.arange(10000, dtype=np.float32)
+        assert_equal(py_func(arr), jit_func(arr))
+        ir = get_print_buffer()
+        assert ir.count('scf.parallel') == 1, ir
+        assert ir.count('memref.alloc') == 0, ir
+
+def test_loop_fusion_eltwise_reduce():
+    def py_func(a, b):
+        c = a * b
+        d = c + 1
+        return d.sum()
+
+    with print_pass_ir([],['PostLinalgOptPass']):
+        jit_func = njit(py_func)
+        a = np.arange(10000, dtype=np.float32)
+        b = np.arange(10000, dtype=np.float32) / 10000
+        assert_allclose(py_func(a, b), jit_func(a, b), rtol=1e-5)
+        ir = get_print_buffer()
+        assert ir.count('scf.parallel') == 1, ir
+
+@pytest.mark.parametrize("shape", [(1,), (7,), (64,), (1001,), (3,17), (16,33)])
+@pytest.mark.parametrize("dtype", [np.int32, np.int64, np.float32, np.float64])
+def test_vectorize_eltwise(shape, dtype):
+    def py_func(a, b):
+        return a * b + 1
+
+    with print_pass_ir([],['TileAndVectorizeLinalgPass']):
+        jit_func = njit(py_func)
+        a = np.arange(np.prod(shape), dtype=dtype).reshape(shape)
+        b = a + 2
+        assert_equal(py_func(a, b), jit_func(a, b))
+        ir = get_print_buffer()
+        assert ir.count('vector.transfer_write') > 0, ir
+
+def test_vectorize_strided():
+    def py_func(a):
+        return a + 1
+
+    jit_func = njit(py_func)
+    a = np.arange(1001, dtype=np.float32)
+    assert_equal(py_func(a[::3]), jit_func(a[::3]))
+    assert_equal(py_func(a[1:-2]), jit_func(a[1:-2]))
+
+@pytest.mark.parametrize("py_func", [
+    lambda a: a > 500,
+    lambda a: a[a > 500],
+    lambda a: np.where(a > 500, a, 0),
+    ])
+def test_vectorize_mask(py_func):
+    with print_pass_ir([],['TileAndVectorizeLinalgPass']):
+        jit_func = njit(py_func)
+        a = np.arange(1001, dtype=np.float32)
+        assert_equal(py_func(a), jit_func(a))
+        ir = get_print_buffer()
+        transfers = [l for l in ir.splitlines() if 'vector.transfer_' in l]
+        assert not any('xi1>' in l for l in transfers), ir
+
+@pytest.mark.parametrize("shape", [(7,5), (64,64), (100,33)])
+def test_vectorize_transpose(shape):
+    def py_func(a):
+        return a.T + 1
+
+    jit_func = njit(py_func)
+    a = np.arange(np.prod(shape), dtype=np.float32).reshape(shape)
+    assert_equal(py_func(a), jit_func(a))
+
+@pytest.mark.parametrize("shape", [(7,5), (64,64), (100,33)])
+def test_vectorize_outer_reduction(shape):
+    def py_func(a):
+        return a.sum(axis=0)
+
+    jit_func = njit(py_func)
+    a = np.arange(np.prod(shape), dtype=np.float64).reshape(shape)
+    assert_allclose(py_func(a), jit_func(a))
+
+_math_funcs = [np.sqrt, np.log, np.exp, np.sin, np.cos, np.tanh]
+
+@pytest.mark.parametrize("func", _math_funcs, ids=lambda f: f.__name__)
+@pytest.mark.parametrize("dtype", [np.float32, np.float64])
+@pytest.mark.parametrize("fastmath", [False, True])
+def test_vectorize_math(func, dtype, fastmath):
+    def py_func(a):
+        return func(a)
+
+    jit_func = njit(py_func, fastmath=fastmath)
+    a = np.linspace(0.1, 10, 1001, dtype=dtype)
+    rtol = 1e-5 if dtype == np.float32 else 1e-12
+    if fastmath:
+        rtol = 1e-4 if dtype == np.float32 else 1e-10
+    assert_allclose(py_func(a), jit_func(a), rtol=rtol)
+    assert_allclose(py_func(a[::3]), jit_func(a[::3]), rtol=rtol)
+
+@pytest.mark.parametrize("func", [np.sqrt, np.exp, np.sin], ids=lambda f: f.__name__)
+def test_vectorize_math_ir(func):
+    def py_func(a):
+        return func(a)
+
+    with print_pass_ir([],['TileAndVectorizeLinalgPass']):
+        jit_func = njit(py_func)
+        a = np.linspace(0.1, 10, 1001, dtype=np.float32)
+        assert_allclose(py_func(a), jit_func(a), rtol=1e-5)
+        ir = get_print_buffer()
+        assert ir.count('vector.transfer_write') > 0, ir
+        assert ir.count('math.' + func.__name__) > 0, ir
+        assert ir.count('@' + func.__name__) == 0, ir
+
+@pytest.mark.skipif(not vector_math_available, reason="No vector math runtime")
+@pytest.mark.parametrize("func", [np.exp, np.log, np.sin, np.cos], ids=lambda f: f.__name__)
+@pytest.mark.parametrize("fastmath", [False, True])
+def test_vector_math_runtime(func, fastmath):
+    def py_func(a):
+        return func(a)
+
+    # f64 math ops don't have polynomial approximations, so they go to the
+    # runtime under fastmath.
+    with print_pass_ir([],['PreLLVMLowering']):
+        jit_func = njit(py_func, fastmath=fastmath)
+        a = np.linspace(0.1, 10, 1001, dtype=np.float64)
+        assert_allclose(py_func(a), jit_func(a), rtol=1e-10)
+        ir = get_print_buffer()
+        name = func.__name__
+        if fastmath:
+            assert ir.count(f'call @dpcomp_vec_{name}_') > 0, ir
+            # Vector math ops must not reach LLVM, it will scalarize them into
+            # libm calls.
+            assert re.search(f'math\\.{name} .*vector<', ir) is None, ir
+        else:
+            assert ir.count('@dpcomp_vec_') == 0, ir
+
+def test_math_tanh_fastmath():
+    def py_func(a):
+        return np.tanh(a)
+
+    with print_pass_ir([],['PreLLVMLowering']):
+        jit_func = njit(py_func, fastmath=True)
+        a = np.linspace(-5, 5, 1001, dtype=np.float32)
+        assert_allclose(py_func(a), jit_func(a), rtol=1e-4, atol=1e-6)
+        ir = get_print_buffer()
+        assert ir.count('math.tanh') == 0, ir
+        assert ir.count('@tanhf') == 0, ir
+
 @pytest.mark.parametrize("dtype", [np.int32, np.int64, np.float32])
 def test_np_reduce(dtype):
     def py_func(arr):
@@ -577,6 +1539,113 @@ class TestMlirBasic(TestCase):
             arr = np.array(a)
             assert_equal(_vectorize_reference(func, arr), jit_func(arr))
 
+    def test_vectorize_multiple_args(self):
+        def func(a, b, c):
+            return a * b + c
+
+        vec_func = vectorize(func)
+        a = np.arange(12, dtype=np.float64).reshape(3, 4)
+        b = np.arange(4, dtype=np.int64)
+        c = np.arange(3, dtype=np.int32).reshape(3, 1)
+        assert_equal(func(a, b, c), vec_func(a, b, c))
+        assert_equal(func(b, b, 2.5), vec_func(b, b, 2.5))
+
+        def py_func(a, b, c):
+            return vec_func(a, b, c) + 1
+
+        jit_func = njit(py_func)
+        assert_equal(py_func(a, b, c), jit_func(a, b, c))
+
+    def test_vectorize_res_type(self):
+        # Result dtype is the kernel return type, not the promoted input type.
+        funcs = [
+            lambda a, b: a / b,
+            lambda a, b: a < b,
+            lambda a, b: a == b,
+        ]
+
+        a = np.arange(1, 13, dtype=np.int64).reshape(3, 4)
+        b = np.arange(1, 5, dtype=np.int32)
+        for func in funcs:
+            vec_func = vectorize(func)
+            res = vec_func(a, b)
+            assert res.dtype == func(a, b).dtype
+            assert_equal(func(a, b), res)
+
+            def py_func(a, b):
+                return vec_func(a, b)
+
+            jit_func = njit(py_func)
+            res = jit_func(a, b)
+            assert res.dtype == func(a, b).dtype
+            assert_equal(func(a, b), res)
+
+    def test_guvectorize(self):
+        @guvectorize(['void(float64[:], float64[:], float64[:])'],
+                     '(n),(n)->()')
+        def dot(a, b, res):
+            acc = 0
+            for i in range(a.shape[0]):
+                acc += a[i] * b[i]
+            res[0] = acc
+
+        @guvectorize(['void(float64[:,:], float64[:], float64[:])'],
+                     '(m,n),(n)->(m)')
+        def matvec(a, x, res):
+            for i in range(a.shape[0]):
+                acc = 0
+                for j in range(a.shape[1]):
+                    acc += a[i, j] * x[j]
+                res[i] = acc
+
+        a = np.arange(24, dtype=np.float64).reshape(2, 3, 4)
+        x = np.arange(4, dtype=np.float64)
+        assert_allclose(np.einsum('ijk,k->ij', a, x), dot(a, x))
+        assert_allclose(np.dot(x, x), dot(x, x))
+        assert_allclose(np.einsum('ijk,k->ij', a, x), matvec(a, x))
+        assert_allclose(np.einsum('ijk,ik->ij', a, a[:, 0]), matvec(a, a[:, 0]))
+
+        def py_func(a, x):
+            return matvec(a, x) * 2
+
+        jit_func = njit(py_func, parallel=True)
+        assert_allclose(np.einsum('ijk,k->ij', a, x) * 2, jit_func(a, x))
+
+    def test_guvectorize_types(self):
+        @guvectorize(['void(int64[:], int64[:])',
+                      'void(float64[:], float64[:])'],
+                     '(n)->(n)')
+        def cumsum(a, res):
+            acc = 0
+            for i in range(a.shape[0]):
+                acc += a[i]
+                res[i] = acc
+
+        # Args are cast to the first declared signature they safely cast to.
+        a = np.arange(6, dtype=np.int32).reshape(2, 3)
+        res = cumsum(a)
+        assert res.dtype == np.int64
+        assert_equal(np.cumsum(a, axis=1), res)
+
+        res = cumsum(a.astype(np.float32))
+        assert res.dtype == np.float64
+        assert_equal(np.cumsum(a, axis=1), res)
+
+        with pytest.raises(numba.core.errors.TypingError):
+            cumsum(a.astype(np.complex128))
+
+    def test_guvectorize_shape_mismatch(self):
+        code = '\n'.join([
+            'from numba_dpcomp import guvectorize',
+            '@guvectorize(["void(float64[:], float64[:], float64[:])"], "(n),(n)->()")',
+            'def dot(a, b, res):',
+            '    res[0] = 0',
+            ])
+        for args in ['np.ones(3), np.ones(4)',
+                     'np.ones((2, 3)), np.ones((3, 3))']:
+            check_runtime_error(f'{code}\ndot({args})',
+                                'gufunc operands dimension mismatch')
+
     def test_fortran_layout(self):
         def py_func(a):
             return a.T
@@ -791,6 +1860,35 @@ def test_cov_edge_cases(m, y, rowvar):
     jit_func = njit(py_func)
     assert_allclose(py_func(m=m, y=y, rowvar=rowvar), jit_func(m=m, y=y, rowvar=rowvar), rtol=1e-14, atol=1e-14)
 
+@pytest.mark.parametrize("dtype", [np.float64, np.float32])
+@pytest.mark.parametrize("shape", [(65, 40), (150, 300)])
+def test_cov_large(dtype, shape):
+    def py_func(m):
+        return np.cov(m)
+
+    jit_func = njit(py_func)
+    m = _rnd.randn(*shape).astype(dtype)
+    tol = 1e-12 if dtype == np.float64 else 1e-4
+    assert_allclose(py_func(m), jit_func(m), rtol=tol, atol=tol)
+
+def _corrcoef(x, y=None, rowvar=True):
+    return np.corrcoef(x, y, rowvar)
+
+@parametrize_function_variants("x, y, rowvar", [
+    '(np.array([[0, 2], [1, 1], [2, 0]]).T, None, True)',
+    '(_rnd.randn(100).reshape(5, 20), None, True)',
+    '(_rnd.randn(100).reshape(5, 20)[:, ::2], None, True)',
+    '(_rnd.randn(100).reshape(5, 20), None, False)',
+    '(np.array([0.3942, 0.5969, 0.7730, 0.9918, 0.7964]), None, True)',
+    '(_cov_inputs_m, _cov_inputs_m[::-1], True)',
+    '(_cov_inputs_m, _cov_inputs_m[::-1], False)',
+    '(_rnd.randn(150, 70), None, True)',
+    ])
+def test_corrcoef(x, y, rowvar):
+    py_func = _corrcoef
+    jit_func = njit(py_func)
+    assert_allclose(py_func(x, y, rowvar), jit_func(x, y, rowvar), rtol=1e-13, atol=1e-13)
+
 @pytest.mark.parametrize("arr", [
     np.array([1,2,3,4,5,6,7,8,9], dtype=np.int32).reshape((3,3)),
     np.array([1,2,3,4,5,6,7,8,9], dtype=np.float32).reshape((3,3)),
@@ -15,7 +15,9 @@
 import sys
 import pytest
 import numpy
-from numba_dpcomp import njit, DPNP_AVAILABLE
+from numpy.testing import assert_allclose
+from numba_dpcomp import njit
+from .utils import check_runtime_error
 
 def vvsort(val, vec, size):
     for i in range(size):
@@ -33,7 +35,6 @@ def vvsort(val, vec, size):
             vec[k, i] = vec[k, imax]
             vec[k, imax] = temp
 
-@pytest.mark.skipif(not DPNP_AVAILABLE, reason="DPNP is not available")
 @pytest.mark.parametrize("type",
                          [numpy.float64, numpy.float32],
                          ids=['float64', 'float32'])
@@ -80,3 +81,138 @@ def test_eig_arange(type, size):
     numpy.testing.assert_allclose(dpnp_val, np_val, rtol=1e-05, atol=1e-05)
     numpy.testing.assert_allclose(dpnp_vec, np_vec, rtol=1e-05, atol=1e-05)
 
+def test_eig_non_symmetric():
+    # Complex eigenvalues are not supported, so non-symmetric input is rejected
+    # instead of silently returning wrong results.
+    check_runtime_error('njit(lambda a: np.linalg.eig(a))(np.array([[1.0, 2.0], [0.0, 3.0]]))',
+                        'eig is only supported for symmetric matrices')
+
+
+_linalg_types = pytest.mark.parametrize("type",
+                                        [numpy.float64, numpy.float32],
+                                        ids=['float64', 'float32'])
+
+def _get_tol(type):
+    return 1e-10 if type == numpy.float64 else 1e-3
+
+def _random_matrix(rows, cols, type, seed=0):
+    return numpy.random.RandomState(seed).uniform(-1, 1, (rows, cols)).astype(type)
+
+def _well_conditioned(size, type):
+    return _random_matrix(size, size, type) + numpy.eye(size, dtype=type) * size
+
+@_linalg_types
+@pytest.mark.parametrize("size", [1, 3, 16, 65, 150])
+def test_solve(type, size):
+    def py_func(a, b):
+        return numpy.linalg.solve(a, b)
+
+    jit_func = njit(py_func)
+    a = _well_conditioned(size, type)
+    tol = _get_tol(type)
+    for b in (_random_matrix(size, 3, type, 1), _random_matrix(size, 1, type, 2)[:, 0]):
+        res = jit_func(a, b)
+        assert res.dtype == type
+        assert_allclose(res, py_func(a, b), rtol=tol, atol=tol)
+
+@_linalg_types
+@pytest.mark.parametrize("size", [1, 3, 16, 65, 150])
+def test_inv(type, size):
+    def py_func(a):
+        return numpy.linalg.inv(a)
+
+    jit_func = njit(py_func)
+    a = _well_conditioned(size, type)
+    tol = _get_tol(type)
+    assert_allclose(jit_func(a), py_func(a), rtol=tol, atol=tol)
+
+def test_inv_int():
+    def py_func(a):
+        return numpy.linalg.inv(a)
+
+    jit_func = njit(py_func)
+    a = numpy.array([[2, 1], [1, 3]])
+    assert_allclose(jit_func(a), py_func(a))
+
+@_linalg_types
+@pytest.mark.parametrize("size", [1, 3, 16, 65, 150])
+def test_cholesky(type, size):
+    def py_func(a):
+        return numpy.linalg.cholesky(a)
+
+    jit_func = njit(py_func)
+    m = _random_matrix(size, size, type)
+    a = m @ m.T + numpy.eye(size, dtype=type)
+    tol = _get_tol(type)
+    assert_allclose(jit_func(a), py_func(a), rtol=tol, atol=tol)
+
+@_linalg_types
+@pytest.mark.parametrize("shape", [(1, 1), (5, 3), (3, 5), (16, 16), (130, 70), (70, 130)])
+def test_qr(type, shape):
+    def py_func(a):
+        return numpy.linalg.qr(a)
+
+    jit_func = njit(py_func)
+    a = _random_matrix(*shape, type)
+    tol = _get_tol(type)
+    q, r = jit_func(a)
+    k = min(shape)
+    assert q.shape == (shape[0], k)
+    assert r.shape == (k, shape[1])
+    assert_allclose(q @ r, a, rtol=tol, atol=tol)
+    assert_allclose(q.T @ q, numpy.eye(k), rtol=tol, atol=tol)
+    numpy.testing.assert_array_equal(r, numpy.triu(r))
+    assert_allclose(numpy.abs(r), numpy.abs(py_func(a)[1]), rtol=tol, atol=tol)
+
+@_linalg_types
+@pytest.mark.parametrize("size", [1, 3, 16, 65, 150])
+def test_eigh(type, size):
+    def py_func(a):
+        return numpy.linalg.eigh(a)
+
+    jit_func = njit(py_func)
+    m = _random_matrix(size, size, type)
+    a = m + m.T
+    tol = _get_tol(type)
+    vals, vecs = jit_func(a)
+    np_vals, _ = py_func(a)
+    assert_allclose(vals, np_vals, rtol=tol, atol=tol)
+    assert_allclose(a @ vecs, vecs * vals, rtol=tol, atol=tol * size)
+    assert_allclose(vecs.T @ vecs, numpy.eye(size), rtol=tol, atol=tol)
+
+@_linalg_types
+@pytest.mark.parametrize("shape", [(1, 1), (5, 3), (3, 5), (16, 16), (130, 70), (70, 130)])
+@pytest.mark.parametrize("nrhs", [0, 2])
+def test_lstsq(type, shape, nrhs):
+    def py_func(a, b):
+        return numpy.linalg.lstsq(a, b, rcond=None)
+
+    jit_func = njit(py_func)
+    a = _random_matrix(*shape, type)
+    b = _random_matrix(shape[0], max(nrhs, 1), type, 1)
+    if nrhs == 0:
+        b = b[:, 0]
+
+    tol = _get_tol(type) * 10
+    x, residuals, rank, s = jit_func(a, b)
+    np_x, np_residuals, np_rank, np_s = py_func(a, b)
+    assert_allclose(x, np_x, rtol=tol, atol=tol)
+    assert_allclose(residuals, np_residuals, rtol=tol, atol=tol)
+    assert rank == np_rank
+    assert_allclose(s, np_s, rtol=tol, atol=tol)
+
+def test_lstsq_rank_deficient():
+    # Residuals are always returned for the overdetermined systems, unlike
+    # numpy, which returns empty array for rank deficient ones.
+    def py_func(a, b):
+        res = numpy.linalg.lstsq(a, b, rcond=None)
+        return res[0], res[2]
+
+    jit_func = njit(py_func)
+    a = _random_matrix(20, 4, numpy.float64)
+    a[:, 3] = a[:, 2]
+    b = _random_matrix(20, 2, numpy.float64, 1)
+    x, rank = jit_func(a, b)
+    np_x, np_rank = py_func(a, b)
+    assert rank == np_rank
+    assert_allclose(x, np_x, rtol=1e-10, atol=1e-10)
@@ -14,7 +14,10 @@
 
 from numba_dpcomp import njit
 import inspect
+import os
 import pytest
+import subprocess
+import sys
 
 def parametrize_function_variants(name, strings):
     caller_frame = inspect.stack()[1]
@@ -34,3 +37,14 @@ def njit_cached(func, *args, **kwargs):
     jitted = njit(func)
     _cached_funcs[func] = jitted
     return jitted
+
+def check_runtime_error(code, msg, env=None):
+    # Errors are reported by the runtime, which aborts, so code is run in
+    # a separate process.
+    code = '\n'.join(['import numpy as np', 'from numba_dpcomp import njit', code])
+    if env is not None:
+        env = dict(os.environ, **env)
+    res = subprocess.run([sys.executable, '-c', code], capture_output=True,
+                         text=True, env=env)
+    assert res.returncode != 0
+    assert msg in res.stderr, res.stderr
@@ -13,9 +13,15 @@
 # limitations under the License.
 
 import inspect
-from .linalg_builder import register_func, eltwise
+import re
+from .linalg_builder import (register_func, eltwise, broadcast_type,
+                             get_numpy_type, promote_numpy_types,
+                             convert_array)
 from numba.core.typing.templates import infer_global, CallableTemplate
-from numba.core import types
+from numba.core import sigutils, types
+from numba.np import numpy_support
+from numba import prange
+import numpy
 import sys
 
 def vectorize(arg_or_function=(), **kws):
@@ -24,12 +30,70 @@ def vectorize(arg_or_function=(), **kws):
 
     return _gen_vectorize
 
-class _VecFuncTyper(CallableTemplate):
-    def generic(self):
-        def typer(a):
-            if isinstance(a, types.Array):
-                return a
-        return typer
+def guvectorize(ftylist, signature, **kws):
+    def _decorator(func):
+        return _gen_guvectorize(func, ftylist, signature)
+
+    return _decorator
+
+def _get_arg_dtype(arg):
+    if isinstance(arg, types.Array):
+        return numpy_support.as_dtype(arg.dtype)
+    if isinstance(arg, (types.Number, types.Boolean)):
+        return numpy_support.as_dtype(arg)
+    return None
+
+def _get_promoted_dtype(args):
+    # Must follow broadcast_type rules, so typing agrees with generated code.
+    array_types = []
+    scalar_types = []
+    for arg in args:
+        dtype = _get_arg_dtype(arg)
+        if dtype is None:
+            return None
+        if _get_ndim(arg) == 0:
+            scalar_types.append(dtype)
+        else:
+            array_types.append(dtype)
+
+    return promote_numpy_types(array_types, scalar_types)
+
+def _get_kernel_res_dtype(kernel, num_args, dtype):
+    # Args are converted to the promoted type by broadcast, so kernel is typed
+    # on it and result dtype is the kernel return type, as in numba.
+    arg_types = (numpy_support.from_dtype(dtype),) * num_args
+    sig = kernel.typingctx.resolve_function_type(types.Dispatcher(kernel),
+                                                 arg_types, {})
+    if sig is None:
+        return None
+
+    try:
+        return numpy_support.as_dtype(sig.return_type)
+    except NotImplementedError:
+        return None
+
+def _get_ndim(arg):
+    return arg.ndim if isinstance(arg, types.Array) else 0
+
+def _make_vec_func_typer(kernel):
+    class _VecFuncTyper(CallableTemplate):
+        def generic(self):
+            def typer(*args):
+                ndim = max(map(_get_ndim, args), default=0)
+                if ndim == 0:
+                    return None
+
+                dtype = _get_promoted_dtype(args)
+                if dtype is None:
+                    return None
+
+                dtype = _get_kernel_res_dtype(kernel, len(args), dtype)
+                if dtype is not None:
+                    return types.Array(numpy_support.from_dtype(dtype), ndim,
+                                       'C')
+            return typer
+
+    return _VecFuncTyper
 
 def _gen_vectorized_func_name(func, mod):
     func_name =  f'_{func.__module__}_{func.__qualname__}_vectorized'
@@ -43,28 +107,279 @@ def _gen_vectorized_func_name(func, mod):
             return new_name
         i += 1
 
+def _make_func(name, params, body, glob):
+    # Builder and numba inspect function signature, so generated functions
+    # must have explicit params instead of *args.
+    params = ', '.join(params)
+    exec(f'def {name}({params}):\n    {body}\n', glob)
+    return glob[name]
+
+def _gen_stub_and_wrapper(func, params, typer, impl):
+    mod = sys.modules[__name__]
+    func_name = _gen_vectorized_func_name(func, mod)
+
+    vec_func_inner = _make_func(func_name, params, 'pass',
+                                {'__name__': __name__})
+    setattr(mod, func_name, vec_func_inner)
+    infer_global(vec_func_inner)(typer)
+
+    args = ', '.join(params)
+    impl = _make_func('impl', ['_builder'] + params,
+                      f'return _impl(_builder, ({args},))',
+                      {'_impl': impl})
+    register_func(func_name, vec_func_inner)(impl)
+
+    vec_func = _make_func('vec_func', params, f'return _inner({args})',
+                          {'_inner': vec_func_inner})
+
+    from ..decorators import njit
+    return njit(vec_func, inline='always')
+
 def _gen_vectorize(func):
-    num_args = len(inspect.signature(func).parameters)
-    if num_args == 1:
-        mod = sys.modules[__name__]
-        func_name = _gen_vectorized_func_name(func, mod)
+    params = list(inspect.signature(func).parameters)
+
+    from ..decorators import njit
+    jit_func = njit(func, inline='always')
+    body = _make_func('body', params + ['_out'],
+                      f'return _func({", ".join(params)})', {'_func': jit_func})
+
+    def impl(builder, args):
+        dtype = get_numpy_type(builder, broadcast_type(builder, args))
+        if dtype is None:
+            return None
+
+        res_dtype = _get_kernel_res_dtype(jit_func, len(args), dtype)
+        if res_dtype is None:
+            return None
+
+        res_type = getattr(builder, res_dtype.name)
+        if len(args) == 1:
+            return eltwise(builder, args[0], body, res_type)
+
+        # Args are broadcasted by eltwise, so generated ufunc is a single
+        # linalg.generic which can be fused with surrounding ops.
+        return eltwise(builder, args, body, res_type)
+
+    return _gen_stub_and_wrapper(func, params, _make_vec_func_typer(jit_func),
+                                 impl)
+
+def _parse_gufunc_layout(layout):
+    def parse_dims(s):
+        return [tuple(d for d in dims.split(',') if d)
+                for dims in re.findall(r'\(([^)]*)\)', s)]
+
+    ins, outs = layout.replace(' ', '').split('->')
+    return parse_dims(ins), parse_dims(outs)
+
+def _get_loop_ndim(ndims, in_dims):
+    # Operands either have all loop dims or none of them, operands without
+    # loop dims are passed as is to every iteration.
+    if len(ndims) != len(in_dims):
+        return None
+
+    res = 0
+    for ndim, core_dims in zip(ndims, in_dims):
+        loop_ndim = ndim - len(core_dims)
+        if loop_ndim < 0 or (loop_ndim != 0 and res != 0 and loop_ndim != res):
+            return None
+        res = max(res, loop_ndim)
+
+    return res
+
+def _parse_gufunc_types(ftylist, num_args):
+    # Declared signatures as (input dtypes, output dtype) pairs.
+    if isinstance(ftylist, str):
+        ftylist = [ftylist]
+
+    res = []
+    for sig in ftylist:
+        args, _ = sigutils.normalize_signature(sig)
+        if len(args) != num_args:
+            raise ValueError(f'Signature "{sig}" doesn\'t match function arguments')
 
-        exec(f'def {func_name}(arg): pass')
-        vec_func_inner = eval(func_name)
+        dtypes = [numpy_support.as_dtype(getattr(t, 'dtype', t)) for t in args]
+        res.append((tuple(dtypes[:-1]), dtypes[-1]))
 
-        setattr(mod, func_name, vec_func_inner)
-        infer_global(vec_func_inner)(_VecFuncTyper)
+    return res
 
-        from ..decorators import njit
-        jit_func = njit(func, inline='always')
+def _select_gufunc_types(sigs, dtypes):
+    # First declared signature, which args can be safely cast to, as in numba.
+    for in_types, out_type in sigs:
+        if all(numpy.can_cast(src, dst, 'safe')
+               for src, dst in zip(dtypes, in_types)):
+            return in_types, out_type
 
-        @register_func(func_name, vec_func_inner)
-        def impl(builder, arg):
-            return eltwise(builder, arg, lambda a, b: jit_func(a))
+    return None
 
-        def vec_func(arg):
-            return vec_func_inner(arg)
+def _make_gufunc_typer(in_dims, out_dims, sigs):
+    class _GUFuncTyper(CallableTemplate):
+        def generic(self):
+            def typer(*args):
+                loop_ndim = _get_loop_ndim(list(map(_get_ndim, args)), in_dims)
+                if loop_ndim is None:
+                    return None
 
-        return njit(vec_func, inline='always')
+                if sigs:
+                    dtypes = list(map(_get_arg_dtype, args))
+                    if None in dtypes:
+                        return None
+
+                    sig_types = _select_gufunc_types(sigs, dtypes)
+                    if sig_types is None:
+                        return None
+
+                    dtype = sig_types[1]
+                else:
+                    dtype = _get_promoted_dtype(args)
+                    if dtype is None:
+                        return None
+
+                dtype = numpy_support.from_dtype(dtype)
+                ndim = loop_ndim + len(out_dims)
+                if ndim == 0:
+                    return dtype
+
+                return types.Array(dtype, ndim, 'C')
+            return typer
+
+    return _GUFuncTyper
+
+def _gen_gufunc_loop(kernel, in_dims, out_dims, ndims, loop_ndim, dtype):
+    args = [f'a{i}' for i in range(len(ndims))]
+    loop_ids = [f'i{i}' for i in range(loop_ndim)]
+
+    def get_dim(i, dim):
+        return f'{args[i]}.shape[{dim}]'
+
+    ref = next(i for i, ndim in enumerate(ndims)
+               if ndim - len(in_dims[i]) == loop_ndim)
+    shape = [get_dim(ref, d) for d in range(loop_ndim)]
+    for name in out_dims:
+        i = next(i for i, dims in enumerate(in_dims) if name in dims)
+        shape.append(get_dim(i, ndims[i] - len(in_dims[i]) +
+                                in_dims[i].index(name)))
+
+    # Scalar output is passed to kernel as 1-element array, as in numba.
+    if not out_dims:
+        shape.append('1')
+
+    # Dims with the same symbol, and loop dims, must match, numba raises on
+    # mismatch.
+    checks = []
+    for i, (ndim, dims) in enumerate(zip(ndims, in_dims)):
+        if i != ref and ndim != len(dims):
+            checks += [(get_dim(i, d), shape[d]) for d in range(loop_ndim)]
+
+    core_dims = {}
+    for i, (ndim, dims) in enumerate(zip(ndims, in_dims)):
+        for j, name in enumerate(dims):
+            dim = get_dim(i, ndim - len(dims) + j)
+            if name in core_dims:
+                checks.append((dim, core_dims[name]))
+            else:
+                core_dims[name] = dim
+
+    def index(val, has_loop_dims):
+        if loop_ndim == 0 or not has_loop_dims:
+            return val
+        return f'{val}[{", ".join(loop_ids)}]'
+
+    call_args = [index(arg, ndim != len(dims))
+                 for arg, ndim, dims in zip(args, ndims, in_dims)]
+    call_args.append(index('res', True))
+
+    lines = [f'_check_dim({dim}, {expected})' for dim, expected in checks]
+    lines.append(f'res = numpy.empty(({", ".join(shape)},), dtype=_dtype)')
+    indent = ''
+    for i, loop_id in enumerate(loop_ids):
+        lines.append(f'{indent}for {loop_id} in prange({shape[i]}):')
+        indent += '    '
+    lines.append(f'{indent}_kernel({", ".join(call_args)})')
+    if out_dims:
+        lines.append('return res')
     else:
-        assert(False)
+        lines.append(f'return res[{":, " * loop_ndim}0]')
+
+    glob = {'numpy': numpy, 'prange': prange, '_kernel': kernel,
+            '_dtype': dtype.type, '_check_dim': _check_gufunc_dim}
+    return _make_func('_gufunc', args, '\n    '.join(lines), glob)
+
+def _check_gufunc_dim(size, expected):
+    pass
+
+@infer_global(_check_gufunc_dim)
+class _CheckGUFuncDimTyper(CallableTemplate):
+    def generic(self):
+        def typer(size, expected):
+            if (isinstance(size, types.Integer) and
+                isinstance(expected, types.Integer)):
+                return types.int64
+        return typer
+
+@register_func(f'{__name__}._check_gufunc_dim', _check_gufunc_dim)
+def _check_gufunc_dim_impl(builder, size, expected):
+    # Compiled code can't raise, runtime reports the error and aborts.
+    size = builder.cast(size, builder.int64)
+    expected = builder.cast(expected, builder.int64)
+    builder.external_call('dpcomp_check_gufunc_dim', (size, expected), ())
+    return size
+
+def _gen_guvectorize(func, ftylist, layout):
+    in_dims, out_dims = _parse_gufunc_layout(layout)
+    if len(out_dims) != 1:
+        raise ValueError(f'Only single output gufuncs are supported: "{layout}"')
+
+    out_dims = out_dims[0]
+    params = list(inspect.signature(func).parameters)
+    if len(params) != len(in_dims) + 1:
+        raise ValueError(f'Layout "{layout}" doesn\'t match function arguments')
+
+    for name in out_dims:
+        if not any(name in dims for dims in in_dims):
+            raise ValueError(f'Output dimension "{name}" is not defined by inputs')
+
+    # Args are cast to the declared types, without them types are deduced
+    # from the call site.
+    sigs = _parse_gufunc_types(ftylist, len(params))
+
+    from ..decorators import njit
+    jit_func = njit(func, inline='always')
+
+    # Loops over loop dims are parallel, core dims loops are inside the kernel.
+    # Generated code is cached per operands ranks and result type.
+    loops_cache = {}
+    def impl(builder, args):
+        ndims = tuple(len(arg.shape) for arg in args)
+        loop_ndim = _get_loop_ndim(ndims, in_dims)
+        if loop_ndim is None:
+            return None
+
+        if sigs:
+            dtypes = [get_numpy_type(builder, arg.dtype) for arg in args]
+            if None in dtypes:
+                return None
+
+            sig_types = _select_gufunc_types(sigs, dtypes)
+            if sig_types is None:
+                return None
+
+            in_types, dtype = sig_types
+            args = tuple(convert_array(builder, arg, getattr(builder, t.name))
+                         for arg, t in zip(args, in_types))
+        else:
+            dtype = get_numpy_type(builder, broadcast_type(builder, args))
+            if dtype is None:
+                return None
+
+        key = (ndims, dtype)
+        loop_func = loops_cache.get(key)
+        if loop_func is None:
+            loop_func = _gen_gufunc_loop(jit_func, in_dims, out_dims, ndims,
+                                         loop_ndim, dtype)
+            loops_cache[key] = loop_func
+
+        return builder.inline_func(loop_func, *args)
+
+    return _gen_stub_and_wrapper(func, params[:-1],
+                                 _make_gufunc_typer(in_dims, out_dims, sigs),
+                                 impl)
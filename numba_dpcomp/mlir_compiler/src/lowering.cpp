@@ -153,6 +153,15 @@ struct plier_lowerer final {
     auto typ = get_func_type(compilation_context["fnargs"],
                              compilation_context["restype"]);
     func = mlir::FuncOp::create(builder.getUnknownLoc(), name, typ);
+    unsigned argIndex = 0;
+    for (auto arg : compilation_context["fnargs_layouts"]()) {
+      auto layout = arg.cast<std::string>();
+      if (layout == "C" || layout == "F")
+        func.setArgAttr(argIndex, plier::attributes::getArrayLayoutName(),
+                        builder.getStringAttr(layout));
+      ++argIndex;
+    }
+
     if (compilation_context["fastmath"]().cast<bool>())
       func->setAttr(plier::attributes::getFastmathName(),
                     mlir::UnitAttr::get(&ctx));
@@ -164,6 +173,31 @@ struct plier_lowerer final {
     func->setAttr(plier::attributes::getOptLevelName(),
                   builder.getI64IntegerAttr(
                       compilation_context["opt_level"]().cast<int64_t>()));
+    auto tile_size = compilation_context["tile_size"]().cast<int64_t>();
+    if (tile_size > 0)
+      func->setAttr(plier::attributes::getTileSizeName(),
+                    builder.getI64IntegerAttr(tile_size));
+
+    auto vector_length =
+        compilation_context["vector_length"]().cast<int64_t>();
+    if (vector_length > 0)
+      func->setAttr(plier::attributes::getVectorLengthName(),
+                    builder.getI64IntegerAttr(vector_length));
+
+    auto stack_promotion_size =
+        compilation_context["stack_promotion_size"]().cast<int64_t>();
+    if (stack_promotion_size > 0)
+      func->setAttr(plier::attributes::getStackPromotionSizeName(),
+                    builder.getI64IntegerAttr(stack_promotion_size));
+
+    if (compilation_context["bounds_check"]().cast<bool>())
+      func->setAttr(plier::attributes::getBoundsCheckName(),
+                    mlir::UnitAttr::get(&ctx));
+
+    if (compilation_context["pool_allocator"]().cast<bool>())
+      mod->setAttr(plier::attributes::getPoolAllocatorName(),
+                   mlir::UnitAttr::get(&ctx));
+
     auto max_concurrency = compilation_context["max_concurrency"]().cast<int>();
     if (max_concurrency > 0) {
       mod->setAttr(plier::attributes::getMaxConcurrencyName(),
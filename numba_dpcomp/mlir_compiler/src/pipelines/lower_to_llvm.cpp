@@ -24,10 +24,14 @@
 #include <mlir/Conversion/SCFToStandard/SCFToStandard.h>
 #include <mlir/Conversion/StandardToLLVM/ConvertStandardToLLVM.h>
 #include <mlir/Conversion/StandardToLLVM/ConvertStandardToLLVMPass.h>
+#include <mlir/Conversion/VectorToLLVM/ConvertVectorToLLVM.h>
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/Dialect/Math/IR/Math.h>
+#include <mlir/Dialect/Math/Transforms/Passes.h>
 #include <mlir/Dialect/MemRef/IR/MemRef.h>
 #include <mlir/Dialect/SCF/SCF.h>
 #include <mlir/Dialect/StandardOps/IR/Ops.h>
+#include <mlir/Dialect/Vector/VectorOps.h>
 #include <mlir/IR/BlockAndValueMapping.h>
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/PatternMatch.h>
@@ -730,8 +734,12 @@ struct AllocOpLowering : public mlir::AllocLikeOpLLVMLowering {
         loc, rewriter.getIntegerType(32), alignment);
 
     auto mod = allocOp->getParentOfType<mlir::ModuleOp>();
+    auto allocFuncName =
+        mod->hasAttr(plier::attributes::getPoolAllocatorName())
+            ? "dpcomp_alloc_meminfo"
+            : "NRT_MemInfo_alloc_safe_aligned";
     auto meminfo_ptr =
-        createAllocCall(loc, "NRT_MemInfo_alloc_safe_aligned", getVoidPtrType(),
+        createAllocCall(loc, allocFuncName, getVoidPtrType(),
                         {sizeBytes, alignment}, mod, rewriter);
     auto data_ptr =
         createAllocCall(loc, "NRT_MemInfo_data_fast", getVoidPtrType(),
@@ -1209,12 +1217,79 @@ struct LowerParallelToCFGPass
   }
 };
 
+// No vector math library is available to the JIT, so LLVM scalarizes vector
+// math intrinsics back into libm calls. Call runtime vector variants instead,
+// vector is passed through the stack buffer and updated in place. Variants
+// are only built when libmvec is available (see VECTOR_MATH_ENABLE).
+template <typename Op>
+struct LowerVectorMathOp : public mlir::OpRewritePattern<Op> {
+  LowerVectorMathOp(mlir::MLIRContext *ctx, llvm::StringRef name)
+      // Inline polynomial approximations are preferred when enabled.
+      : mlir::OpRewritePattern<Op>(ctx, /*benefit*/ 0), funcName(name) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(Op op, mlir::PatternRewriter &rewriter) const override {
+    auto vecType = op.getType().template dyn_cast<mlir::VectorType>();
+    if (!vecType || vecType.getRank() != 1)
+      return mlir::failure();
+
+    auto elemType = vecType.getElementType();
+    llvm::StringRef suffix;
+    if (elemType.isF32()) {
+      suffix = "float32";
+    } else if (elemType.isF64()) {
+      suffix = "float64";
+    } else {
+      return mlir::failure();
+    }
+
+    auto mod = op->template getParentOfType<mlir::ModuleOp>();
+    if (!mod)
+      return mlir::failure();
+
+    auto name = ("dpcomp_vec_" + funcName + "_" + suffix).str();
+    auto argType =
+        mlir::MemRefType::get(mlir::ShapedType::kDynamicSize, elemType);
+    auto func = mod.lookupSymbol<mlir::FuncOp>(name);
+    if (!func) {
+      auto funcType =
+          mlir::FunctionType::get(op.getContext(), argType, llvm::None);
+      func = plier::add_function(rewriter, mod, name, funcType);
+      func->setAttr("llvm.emit_c_interface",
+                    mlir::UnitAttr::get(op.getContext()));
+    }
+
+    auto loc = op.getLoc();
+    auto bufferType = mlir::MemRefType::get(vecType.getShape(), elemType);
+    auto buffer = plier::AllocaInsertionPoint(op).insert(rewriter, [&]() {
+      return rewriter.create<mlir::memref::AllocaOp>(loc, bufferType);
+    });
+    const mlir::Value indices[] = {
+        rewriter.create<mlir::ConstantIndexOp>(loc, 0)};
+    const bool inBounds[] = {true};
+    rewriter.create<mlir::vector::TransferWriteOp>(loc, op.operand(), buffer,
+                                                   indices, inBounds);
+    mlir::Value arg =
+        rewriter.create<mlir::memref::CastOp>(loc, buffer, argType);
+    rewriter.create<mlir::CallOp>(loc, func, arg);
+    rewriter.replaceOpWithNewOp<mlir::vector::TransferReadOp>(
+        op, vecType, buffer, indices, inBounds);
+    return mlir::success();
+  }
+
+private:
+  std::string funcName;
+};
+
 struct PreLLVMLowering
     : public mlir::PassWrapper<PreLLVMLowering, mlir::FunctionPass> {
   virtual void
   getDependentDialects(mlir::DialectRegistry &registry) const override {
     registry.insert<mlir::StandardOpsDialect>();
     registry.insert<mlir::LLVM::LLVMDialect>();
+    registry.insert<mlir::math::MathDialect>();
+    registry.insert<mlir::memref::MemRefDialect>();
+    registry.insert<mlir::vector::VectorDialect>();
   }
 
   void runOnFunction() override final {
@@ -1231,6 +1306,19 @@ struct PreLLVMLowering
     patterns.insert<ReturnOpLowering>(&context,
                                       type_helper.get_type_converter());
 
+    // Expand f32 math ops, which don't have vectorizable libm counterparts,
+    // into polynomial approximations with relaxed accuracy. Remaining vector
+    // math ops are passed to runtime variants, which have libmvec accuracy.
+    if (func->hasAttr(plier::attributes::getFastmathName())) {
+      mlir::populateMathPolynomialApproximationPatterns(patterns);
+#ifdef VECTOR_MATH_ENABLE
+      patterns.insert<LowerVectorMathOp<mlir::math::SinOp>>(&context, "sin");
+      patterns.insert<LowerVectorMathOp<mlir::math::CosOp>>(&context, "cos");
+      patterns.insert<LowerVectorMathOp<mlir::math::ExpOp>>(&context, "exp");
+      patterns.insert<LowerVectorMathOp<mlir::math::LogOp>>(&context, "log");
+#endif
+    }
+
     (void)mlir::applyPatternsAndFoldGreedily(getOperation(),
                                              std::move(patterns));
   }
@@ -1370,6 +1458,29 @@ struct LowerExtractMemrefMetadataOp
   }
 };
 
+struct LowerExtractMemrefPointerOp
+    : public mlir::ConvertOpToLLVMPattern<plier::ExtractMemrefPointerOp> {
+  using mlir::ConvertOpToLLVMPattern<
+      plier::ExtractMemrefPointerOp>::ConvertOpToLLVMPattern;
+
+  mlir::LogicalResult
+  matchAndRewrite(plier::ExtractMemrefPointerOp op,
+                  llvm::ArrayRef<mlir::Value> operands,
+                  mlir::ConversionPatternRewriter &rewriter) const override {
+    plier::ExtractMemrefPointerOp::Adaptor transformed(operands);
+    auto arg = transformed.source();
+    if (!arg.getType().isa<mlir::LLVM::LLVMStructType>())
+      return mlir::failure();
+
+    auto loc = op.getLoc();
+    mlir::MemRefDescriptor src(arg);
+    auto ptr = src.alignedPtr(rewriter, loc);
+    rewriter.replaceOpWithNewOp<mlir::LLVM::PtrToIntOp>(op, getIndexType(),
+                                                        ptr);
+    return mlir::success();
+  }
+};
+
 struct LowerBuildTuple
     : public mlir::ConvertOpToLLVMPattern<plier::BuildTupleOp> {
   using mlir::ConvertOpToLLVMPattern<
@@ -1459,6 +1570,7 @@ struct LLVMLoweringPass
     populateMathToLLVMConversionPatterns(typeConverter, patterns);
     populateMemRefToLLVMConversionPatterns(typeConverter, patterns);
     populateLinalgToLLVMConversionPatterns(typeConverter, patterns);
+    populateVectorToLLVMConversionPatterns(typeConverter, patterns);
 
     patterns.insert<
         // clang-format off
@@ -1469,7 +1581,8 @@ struct LLVMLoweringPass
         DeallocOpLowering,
         ReshapeLowering,
         LowerReduceRankOp,
-        LowerExtractMemrefMetadataOp
+        LowerExtractMemrefMetadataOp,
+        LowerExtractMemrefPointerOp
         // clang-format on
         >(typeConverter);
 
@@ -14,10 +14,12 @@
 
 #include "pipelines/parallel_to_tbb.hpp"
 
+#include <mlir/Analysis/BufferViewFlowAnalysis.h>
 #include <mlir/Dialect/MemRef/IR/MemRef.h>
 #include <mlir/Dialect/SCF/SCF.h>
 #include <mlir/Dialect/StandardOps/IR/Ops.h>
 #include <mlir/IR/BlockAndValueMapping.h>
+#include <mlir/Interfaces/CallInterfaces.h>
 #include <mlir/Pass/Pass.h>
 #include <mlir/Pass/PassManager.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
@@ -56,6 +58,74 @@ mlir::Attribute getReduceInitVal(mlir::Type type, mlir::Block &reduceBlock) {
   return plier::getConstAttr(type, reduceInit);
 }
 
+/// Returns dealloc op if allocation inside parallel loop can be replaced by
+/// single buffer reused across iterations executed by the same thread.
+/// Buffer must have loop invariant sizes, must not escape the iteration and
+/// must not be used concurrently by nested parallel loops.
+mlir::memref::DeallocOp
+getHoistableDealloc(mlir::memref::AllocOp alloc, mlir::scf::ParallelOp loop,
+                    const mlir::BufferViewFlowAnalysis &analysis) {
+  if (!alloc.symbolOperands().empty())
+    return {};
+
+  for (auto size : alloc.dynamicSizes())
+    if (loop->isAncestor(size.getParentRegion()->getParentOp()))
+      return {};
+
+  for (auto parent = alloc->getParentOp(); parent != loop;
+       parent = parent->getParentOp()) {
+    if (auto nested = mlir::dyn_cast<mlir::scf::ParallelOp>(parent)) {
+      if (nested->hasAttr(plier::attributes::getParallelName()))
+        return {};
+    } else if (!mlir::isa<mlir::scf::ForOp>(parent)) {
+      return {};
+    }
+  }
+
+  mlir::memref::DeallocOp dealloc;
+  auto memref = alloc.getResult();
+  for (auto alias : analysis.resolve(memref)) {
+    for (auto user : alias.getUsers()) {
+      if (!loop->isAncestor(user) || mlir::isa<mlir::CallOpInterface>(user))
+        return {};
+
+      if (auto op = mlir::dyn_cast<mlir::memref::DeallocOp>(user)) {
+        if (alias != memref || dealloc || op->getBlock() != alloc->getBlock())
+          return {};
+
+        dealloc = op;
+      }
+    }
+  }
+  return dealloc;
+}
+
+/// Replaces temporary allocations inside parallel loop body with single
+/// buffer allocated before the loop.
+void hoistAllocs(mlir::PatternRewriter &rewriter, mlir::scf::ParallelOp loop) {
+  llvm::SmallVector<mlir::memref::AllocOp> allocs;
+  loop.getBody()->walk(
+      [&](mlir::memref::AllocOp alloc) { allocs.emplace_back(alloc); });
+  if (allocs.empty())
+    return;
+
+  mlir::OpBuilder::InsertionGuard g(rewriter);
+  mlir::BufferViewFlowAnalysis analysis(loop);
+  for (auto alloc : allocs) {
+    auto dealloc = getHoistableDealloc(alloc, loop, analysis);
+    if (!dealloc)
+      continue;
+
+    rewriter.setInsertionPoint(loop);
+    auto newAlloc = rewriter.clone(*alloc)->getResult(0);
+    rewriter.setInsertionPointAfter(loop);
+    rewriter.create<mlir::memref::DeallocOp>(dealloc.getLoc(), newAlloc);
+
+    rewriter.replaceOp(alloc, newAlloc);
+    rewriter.eraseOp(dealloc);
+  }
+}
+
 struct ParallelToTbb : public mlir::OpRewritePattern<mlir::scf::ParallelOp> {
   using mlir::OpRewritePattern<mlir::scf::ParallelOp>::OpRewritePattern;
 
@@ -154,6 +224,7 @@ struct ParallelToTbb : public mlir::OpRewritePattern<mlir::scf::ParallelOp> {
     auto orig_lower_bound = op.lowerBound();
     auto orig_upper_bound = op.upperBound();
     auto orig_step = op.step();
+    mlir::scf::ParallelOp chunk_loop;
     auto body_builder = [&](mlir::OpBuilder &builder, ::mlir::Location loc,
                             mlir::ValueRange lower_bound,
                             mlir::ValueRange upper_bound,
@@ -172,6 +243,7 @@ struct ParallelToTbb : public mlir::OpRewritePattern<mlir::scf::ParallelOp> {
       new_op.lowerBoundMutable().assign(lower_bound);
       new_op.upperBoundMutable().assign(upper_bound);
       new_op.initValsMutable().assign(initVals);
+      chunk_loop = new_op;
       for (auto it : llvm::enumerate(new_op->getResults())) {
         auto reduce_var = reduce_vars[it.index()];
         builder.create<mlir::memref::StoreOp>(loc, it.value(), reduce_var,
@@ -182,6 +254,11 @@ struct ParallelToTbb : public mlir::OpRewritePattern<mlir::scf::ParallelOp> {
     rewriter.create<plier::ParallelOp>(loc, orig_lower_bound, orig_upper_bound,
                                        orig_step, body_builder);
 
+    // Chunk iterations are executed sequentially by single thread, so
+    // temporary buffers can be allocated once per chunk.
+    assert(chunk_loop);
+    hoistAllocs(rewriter, chunk_loop);
+
     auto reduce_body_builder = [&](mlir::OpBuilder &builder, mlir::Location loc,
                                    mlir::Value index, mlir::ValueRange args) {
       assert(args.size() == reduce_vars.size());
@@ -31,6 +31,7 @@
 #include <mlir/Dialect/StandardOps/Transforms/Passes.h>
 #include <mlir/Dialect/Tensor/IR/Tensor.h>
 #include <mlir/Dialect/Tensor/Transforms/Passes.h>
+#include <mlir/Dialect/Vector/VectorOps.h>
 #include <mlir/IR/Dialect.h>
 #include <mlir/Pass/Pass.h>
 #include <mlir/Pass/PassManager.h>
@@ -48,7 +49,6 @@
 #include "plier/pass/rewrite_wrapper.hpp"
 #include "plier/rewrites/arg_lowering.hpp"
 #include "plier/rewrites/call_lowering.hpp"
-#include "plier/rewrites/canonicalize_reductions.hpp"
 #include "plier/rewrites/cast_lowering.hpp"
 #include "plier/rewrites/common_opts.hpp"
 #include "plier/rewrites/cse.hpp"
@@ -59,8 +59,14 @@
 #include "plier/rewrites/type_conversion.hpp"
 #include "plier/transforms/cast_utils.hpp"
 #include "plier/transforms/const_utils.hpp"
+#include "plier/transforms/copy_elision.hpp"
+#include "plier/transforms/func_utils.hpp"
 #include "plier/transforms/loop_utils.hpp"
+#include "plier/transforms/memory_planning.hpp"
 #include "plier/transforms/pipeline_utils.hpp"
+#include "plier/transforms/refcount_opts.hpp"
+#include "plier/transforms/scalar_replacement.hpp"
+#include "plier/transforms/vectorize_linalg.hpp"
 
 #include "base_pipeline.hpp"
 #include "loop_utils.hpp"
@@ -82,12 +88,32 @@ int64_t getOptLevel(mlir::Operation *op) {
   return std::max(static_cast<int64_t>(0), attr.getInt());
 }
 
+/// Cheap IR fingerprint, based on ops, values and attributes identity.
+llvm::hash_code getIRHash(mlir::Operation *root) {
+  llvm::hash_code hash(0);
+  root->walk([&](mlir::Operation *op) {
+    // Op name is included as erased op memory can be reused by the new op.
+    hash = llvm::hash_combine(hash, op, op->getName().getAsOpaquePointer(),
+                              op->getAttrDictionary().getAsOpaquePointer());
+    for (auto arg : op->getOperands())
+      hash = llvm::hash_combine(hash, arg.getAsOpaquePointer());
+
+    for (auto type : op->getResultTypes())
+      hash = llvm::hash_combine(hash, type.getAsOpaquePointer());
+
+    for (auto block : op->getSuccessors())
+      hash = llvm::hash_combine(hash, block);
+  });
+  return hash;
+}
+
 mlir::LogicalResult applyOptimizations(
     mlir::FuncOp op, const mlir::FrozenRewritePatternSet &patterns,
     mlir::AnalysisManager am,
     llvm::function_ref<mlir::LogicalResult(mlir::FuncOp)> additionalOpts =
         nullptr) {
   bool repeat = false;
+  llvm::Optional<llvm::hash_code> memssaHash;
   do {
     repeat = false;
     (void)mlir::applyPatternsAndFoldGreedily(op, patterns);
@@ -95,6 +121,12 @@ mlir::LogicalResult applyOptimizations(
       repeat = true;
     }
 
+    // Memory opts keep memssa up to date, rebuild it only if other
+    // transforms changed the IR.
+    if (memssaHash && *memssaHash != getIRHash(op)) {
+      am.invalidate({});
+    }
+
     auto memOptRes = plier::optimizeMemoryOps(am);
     if (!memOptRes) {
       op.emitError() << "Failed to build memssa analysis";
@@ -103,13 +135,11 @@ mlir::LogicalResult applyOptimizations(
     if (mlir::succeeded(*memOptRes)) {
       repeat = true;
     }
+    memssaHash = getIRHash(op);
 
     if (additionalOpts && mlir::succeeded(additionalOpts(op))) {
       repeat = true;
     }
-    if (repeat) {
-      am.invalidate({});
-    }
   } while (repeat);
   return mlir::success();
 }
@@ -315,6 +345,20 @@ struct CallLowerer {
     return mlir::failure();
   }
 
+  mlir::LogicalResult operator()(plier::GetItemOp op, mlir::Value value,
+                                 mlir::Value index,
+                                 mlir::PatternRewriter &rewriter) {
+    // Scalar and slice indices are handled by GetitemOpLowering.
+    if (!value.getType().isa<mlir::ShapedType>() ||
+        !index.getType().isa<mlir::ShapedType>()) {
+      return mlir::failure();
+    }
+    return applyRewrite(op, rewriter,
+                        linalg_resolver.rewrite_func(
+                            "operator.getitem", op.getLoc(), rewriter,
+                            {value, index}, {}));
+  }
+
 private:
   PyLinalgResolver linalg_resolver;
   PyFuncResolver py_resolver;
@@ -489,11 +533,13 @@ struct GetitemOpLowering : public mlir::OpRewritePattern<plier::GetItemOp> {
       auto numDims = static_cast<unsigned>(dimsIndices.size());
       auto needReshape = (numDims != type.cast<mlir::ShapedType>().getRank());
       if (isMemref) {
-        if (needReshape) {
-          return mlir::failure(); // TODO: not implemented
-        }
         res = rewriter.create<mlir::memref::SubViewOp>(loc, value, offsets,
                                                        sizes, strides);
+        if (needReshape) {
+          llvm::SmallVector<int32_t> mapping(dimsIndices.begin(),
+                                             dimsIndices.end());
+          res = rewriter.create<plier::ReduceRankOp>(loc, res, mapping);
+        }
       } else if (isTensor) {
         res = rewriter.create<mlir::tensor::ExtractSliceOp>(loc, value, offsets,
                                                             sizes, strides);
@@ -719,7 +765,6 @@ struct FixStridedIf : public mlir::OpRewritePattern<mlir::scf::YieldOp> {
 
       if (origType.isa<mlir::MemRefType>() || origType != trueType ||
           origType != falseType) {
-        changed = true;
         auto trueMemref = trueType.cast<mlir::MemRefType>();
         auto falseMemref = falseType.cast<mlir::MemRefType>();
         bool isTrueIdentity = llvm::all_of(
@@ -733,11 +778,15 @@ struct FixStridedIf : public mlir::OpRewritePattern<mlir::scf::YieldOp> {
             auto newVal =
                 unstride(rewriter, trueYield.getLoc(), arg, resultType);
             if (newVal != arg) {
+              changed = true;
               yield.setOperand(index, newVal);
             }
           }
         }
 
+        if (resultType != origType)
+          changed = true;
+
         resultTypes[index] = resultType;
       } else {
         resultTypes[index] = origType;
@@ -915,6 +964,123 @@ struct MakeStridedLayout
   void runOnOperation() override;
 };
 
+/// Returns layout for public function array argument. Arrays, known to be C
+/// or F contiguous from their numba type, get identity layout or unit first
+/// dim stride, other arrays get fully dynamic strided layout.
+llvm::SmallVector<mlir::AffineMap, 1>
+getArgLayout(mlir::FuncOp func, unsigned index, unsigned rank) {
+  auto context = func.getContext();
+  auto strideVal = mlir::ShapedType::kDynamicStrideOrOffset;
+  llvm::SmallVector<int64_t> strides(rank, strideVal);
+  auto layout = func.getArgAttrOfType<mlir::StringAttr>(
+      index, plier::attributes::getArrayLayoutName());
+  if (layout && layout.getValue() == "C")
+    return {};
+
+  if (layout && layout.getValue() == "F" && rank > 0) {
+    strides.front() = 1;
+    return {mlir::makeStridedLinearLayoutMap(strides, 0, context)};
+  }
+
+  return {mlir::makeStridedLinearLayoutMap(strides, strideVal, context)};
+}
+
+bool isDynamicLayout(mlir::FuncOp func, unsigned index) {
+  return !func.getArgAttr(index, plier::attributes::getArrayLayoutName());
+}
+
+/// Duplicates function body for the case when all dynamically strided
+/// `args` have unit innermost stride at runtime, so inner loops over them can
+/// be vectorized. Original body is kept as fallback.
+void versionStridedArgs(mlir::FuncOp func, llvm::ArrayRef<unsigned> args) {
+  auto &block = func.getBody().front();
+  auto ret = mlir::dyn_cast<mlir::ReturnOp>(block.getTerminator());
+  if (!ret)
+    return;
+
+  auto hasLoops = [&]() {
+    return func
+        .walk([](mlir::Operation *op) {
+          if (mlir::isa<mlir::scf::ForOp, mlir::scf::ParallelOp,
+                        mlir::linalg::LinalgOp>(op))
+            return mlir::WalkResult::interrupt();
+
+          return mlir::WalkResult::advance();
+        })
+        .wasInterrupted();
+  };
+  if (args.empty() || !llvm::hasSingleElement(func.getBody()) || !hasLoops())
+    return;
+
+  llvm::SmallVector<mlir::Operation *> oldOps;
+  for (auto &op : block.without_terminator())
+    oldOps.emplace_back(&op);
+
+  auto loc = ret.getLoc();
+  mlir::OpBuilder builder(&block, block.begin());
+  auto one = builder.create<mlir::ConstantIndexOp>(loc, 1);
+  mlir::Value cond;
+  for (auto i : args) {
+    auto arg = block.getArgument(i);
+    auto rank = arg.getType().cast<mlir::MemRefType>().getRank();
+    auto stride =
+        builder.create<plier::ExtractMemrefMetadataOp>(loc, arg, rank - 1);
+    mlir::Value isUnit = builder.create<mlir::CmpIOp>(
+        loc, mlir::CmpIPredicate::eq, stride, one);
+    if (cond)
+      isUnit = builder.create<mlir::AndOp>(loc, cond, isUnit);
+
+    cond = isUnit;
+  }
+
+  auto resTypes = func.getType().getResults();
+  auto yieldResults = [&](mlir::OpBuilder &builder, mlir::Location loc,
+                          mlir::ValueRange results) {
+    llvm::SmallVector<mlir::Value> values(results.begin(), results.end());
+    for (auto it : llvm::enumerate(resTypes)) {
+      auto &val = values[it.index()];
+      if (val.getType() != it.value() && it.value().isa<mlir::MemRefType>())
+        val = builder.create<mlir::memref::CastOp>(loc, val, it.value());
+    }
+    builder.create<mlir::scf::YieldOp>(loc, values);
+  };
+  auto thenBuilder = [&](mlir::OpBuilder &builder, mlir::Location loc) {
+    mlir::BlockAndValueMapping mapping;
+    auto strideVal = mlir::ShapedType::kDynamicStrideOrOffset;
+    for (auto i : args) {
+      auto arg = block.getArgument(i);
+      auto type = arg.getType().cast<mlir::MemRefType>();
+      llvm::SmallVector<int64_t> strides(static_cast<size_t>(type.getRank()),
+                                         strideVal);
+      strides.back() = 1;
+      auto newType = mlir::MemRefType::get(
+          type.getShape(), type.getElementType(),
+          mlir::makeStridedLinearLayoutMap(strides, strideVal,
+                                           builder.getContext()));
+      mapping.map(arg, builder.create<mlir::memref::CastOp>(loc, arg, newType)
+                           .getResult());
+    }
+    for (auto op : oldOps)
+      builder.clone(*op, mapping);
+
+    llvm::SmallVector<mlir::Value> results;
+    for (auto val : ret.operands())
+      results.emplace_back(mapping.lookupOrDefault(val));
+
+    yieldResults(builder, loc, results);
+  };
+  auto elseBuilder = [&](mlir::OpBuilder &builder, mlir::Location loc) {
+    yieldResults(builder, loc, ret.operands());
+  };
+  auto ifOp = builder.create<mlir::scf::IfOp>(loc, resTypes, cond, thenBuilder,
+                                              elseBuilder);
+  auto elseTerm = ifOp.elseBlock()->getTerminator();
+  for (auto op : oldOps)
+    op->moveBefore(elseTerm);
+
+  ret->setOperands(ifOp.getResults());
+}
+
 void MakeStridedLayout::runOnOperation() {
   auto context = &getContext();
   auto mod = getOperation();
@@ -936,6 +1102,7 @@ void MakeStridedLayout::runOnOperation() {
     auto resTypes = funcType.getResults();
     llvm::SmallVector<mlir::Type> newArgTypes;
     llvm::SmallVector<mlir::Type> newResTypes;
+    llvm::SmallVector<unsigned> stridedArgs;
     newArgTypes.assign(argTypes.begin(), argTypes.end());
     newResTypes.assign(resTypes.begin(), resTypes.end());
     bool hasBody = !func.getBody().empty();
@@ -944,16 +1111,12 @@ void MakeStridedLayout::runOnOperation() {
       auto type = it.value();
       if (auto tensor = type.dyn_cast<mlir::RankedTensorType>()) {
         auto rank = static_cast<unsigned>(tensor.getRank());
-        auto makeShape = [&](int64_t val) {
-          return llvm::SmallVector<int64_t>(rank, val);
-        };
-        auto strideVal = mlir::ShapedType::kDynamicStrideOrOffset;
-        auto affineMap = mlir::makeStridedLinearLayoutMap(
-            makeShape(strideVal), strideVal, builder.getContext());
-        auto memrefType =
-            mlir::MemRefType::get(makeShape(mlir::ShapedType::kDynamicSize),
-                                  tensor.getElementType(), affineMap);
+        auto memrefType = mlir::MemRefType::get(
+            llvm::SmallVector<int64_t>(rank, mlir::ShapedType::kDynamicSize),
+            tensor.getElementType(), getArgLayout(func, i, rank));
         newArgTypes[i] = memrefType;
+        if (rank > 0 && isDynamicLayout(func, i))
+          stridedArgs.emplace_back(i);
 
         if (hasBody) {
           auto arg = func.getBody().front().getArgument(i);
@@ -963,16 +1126,12 @@ void MakeStridedLayout::runOnOperation() {
         }
       } else if (auto memref = type.dyn_cast<mlir::MemRefType>()) {
         auto rank = static_cast<unsigned>(memref.getRank());
-        auto makeShape = [&](int64_t val) {
-          return llvm::SmallVector<int64_t>(rank, val);
-        };
-        auto strideVal = mlir::ShapedType::kDynamicStrideOrOffset;
-        auto affineMap = mlir::makeStridedLinearLayoutMap(makeShape(strideVal),
-                                                          strideVal, context);
-        auto memrefType =
-            mlir::MemRefType::get(makeShape(mlir::ShapedType::kDynamicSize),
-                                  memref.getElementType(), affineMap);
+        auto memrefType = mlir::MemRefType::get(
+            llvm::SmallVector<int64_t>(rank, mlir::ShapedType::kDynamicSize),
+            memref.getElementType(), getArgLayout(func, i, rank));
         newArgTypes[i] = memrefType;
+        if (rank > 0 && isDynamicLayout(func, i))
+          stridedArgs.emplace_back(i);
 
         if (hasBody) {
           auto arg = func.getBody().front().getArgument(i);
@@ -1004,6 +1163,9 @@ void MakeStridedLayout::runOnOperation() {
       changed = true;
       func.setType(newFuncType);
     }
+
+    if (hasBody)
+      versionStridedArgs(func, stridedArgs);
   }
 
   if (changed) {
@@ -1040,6 +1202,231 @@ struct PlierToLinalgPass
   void runOnOperation() override;
 };
 
+/// Returns signless memref for shaped `val`, tensors are converted with
+/// buffer_cast.
+mlir::Value toSignlessMemref(mlir::OpBuilder &builder, mlir::Location loc,
+                             mlir::Value val) {
+  auto type = val.getType().cast<mlir::ShapedType>();
+  auto elemType = type.getElementType();
+  auto signlessElemType = plier::makeSignlessType(elemType);
+  if (auto tensorType = type.dyn_cast<mlir::RankedTensorType>()) {
+    if (elemType != signlessElemType) {
+      auto signlessType = mlir::RankedTensorType::get(
+          tensorType.getShape(), signlessElemType, tensorType.getEncoding());
+      val = builder.create<plier::SignCastOp>(loc, signlessType, val);
+    }
+    auto memrefType =
+        mlir::MemRefType::get(tensorType.getShape(), signlessElemType);
+    return builder.create<mlir::memref::BufferCastOp>(loc, memrefType, val);
+  }
+
+  auto memrefType = type.cast<mlir::MemRefType>();
+  if (elemType != signlessElemType) {
+    auto signlessType =
+        mlir::MemRefType::get(memrefType.getShape(), signlessElemType,
+                              memrefType.getAffineMaps());
+    val = builder.create<plier::SignCastOp>(loc, signlessType, val);
+  }
+  return val;
+}
+
+bool isSetitemMask(mlir::ShapedType targetType, mlir::Value index,
+                   mlir::Value value) {
+  auto maskType = index.getType().dyn_cast<mlir::ShapedType>();
+  return maskType && maskType.hasRank() &&
+         maskType.getElementType().isInteger(1) &&
+         maskType.getRank() == targetType.getRank() &&
+         !value.getType().isa<mlir::ShapedType>();
+}
+
+/// Checks for `a[idx] = v`, where `idx` is 1D int array, indexing the first
+/// dim, and `v` is scalar or array with `len(idx)` rows of `a`.
+bool isSetitemIndexArray(mlir::ShapedType targetType, mlir::Value index,
+                         mlir::Value value) {
+  auto indexType = index.getType().dyn_cast<mlir::ShapedType>();
+  if (!indexType || !indexType.hasRank() || indexType.getRank() != 1 ||
+      !indexType.getElementType().isa<mlir::IntegerType>() ||
+      indexType.getElementType().isInteger(1) || !targetType.hasRank() ||
+      targetType.getRank() == 0) {
+    return false;
+  }
+
+  auto valueType = value.getType().dyn_cast<mlir::ShapedType>();
+  if (!valueType) {
+    return true;
+  }
+
+  return valueType.hasRank() && valueType.getRank() == targetType.getRank() &&
+         plier::makeSignlessType(valueType.getElementType()) ==
+             plier::makeSignlessType(targetType.getElementType());
+}
+
+/// Returns runtime function, which checks its i64 args and aborts on failure.
+mlir::FuncOp getRuntimeCheckFunc(mlir::OpBuilder &builder,
+                                 llvm::StringRef name, unsigned numArgs) {
+  auto mod =
+      builder.getBlock()->getParentOp()->getParentOfType<mlir::ModuleOp>();
+  assert(mod);
+  auto func = mod.lookupSymbol<mlir::FuncOp>(name);
+  if (!func) {
+    llvm::SmallVector<mlir::Type, 3> argTypes(numArgs,
+                                              builder.getIntegerType(64));
+    auto funcType =
+        mlir::FunctionType::get(builder.getContext(), argTypes, llvm::None);
+    func = plier::add_function(builder, mod, name, funcType);
+    func->setAttr("llvm.emit_c_interface", builder.getUnitAttr());
+  }
+  return func;
+}
+
+/// Mask must have the same shape as the target, as in NumPy. Dims, which are
+/// not statically known to be equal, are checked by the runtime, which
+/// reports the error and aborts.
+void genMaskShapeChecks(mlir::OpBuilder &builder, mlir::Location loc,
+                        mlir::Value target, mlir::Value mask) {
+  auto targetType = target.getType().cast<mlir::MemRefType>();
+  auto maskType = mask.getType().cast<mlir::MemRefType>();
+  assert(targetType.getRank() == maskType.getRank());
+
+  auto i64 = builder.getIntegerType(64);
+  for (auto i : llvm::seq<int64_t>(0, targetType.getRank())) {
+    auto size = targetType.getDimSize(i);
+    if (size != mlir::ShapedType::kDynamicSize &&
+        size == maskType.getDimSize(i))
+      continue;
+
+    auto func = getRuntimeCheckFunc(builder, "dpcomp_check_mask_dim", 3);
+    auto getDim = [&](mlir::Value memref) -> mlir::Value {
+      auto dim = builder.createOrFold<mlir::memref::DimOp>(loc, memref, i);
+      return builder.createOrFold<mlir::IndexCastOp>(loc, dim, i64);
+    };
+    const mlir::Value args[] = {
+        getDim(target), getDim(mask),
+        builder.create<mlir::ConstantIntOp>(loc, i, i64)};
+    builder.create<mlir::CallOp>(loc, func, args);
+  }
+}
+
+/// Value rows must match the indices, other dims must match the target, as
+/// values are not broadcasted. Dims, which are not statically known to be
+/// equal, are checked by the runtime.
+void genIndexArrayValueChecks(mlir::OpBuilder &builder, mlir::Location loc,
+                              mlir::Value target, mlir::Value indices,
+                              mlir::Value value) {
+  auto valueType = value.getType().cast<mlir::MemRefType>();
+  auto i64 = builder.getIntegerType(64);
+  for (auto i : llvm::seq<int64_t>(0, valueType.getRank())) {
+    auto expected = (i == 0 ? indices : target);
+    auto size = valueType.getDimSize(i);
+    if (size != mlir::ShapedType::kDynamicSize &&
+        size == expected.getType().cast<mlir::MemRefType>().getDimSize(i))
+      continue;
+
+    auto func = getRuntimeCheckFunc(builder, "dpcomp_check_setitem_dim", 3);
+    auto getDim = [&](mlir::Value memref) -> mlir::Value {
+      auto dim = builder.createOrFold<mlir::memref::DimOp>(loc, memref, i);
+      return builder.createOrFold<mlir::IndexCastOp>(loc, dim, i64);
+    };
+    const mlir::Value args[] = {
+        getDim(value), getDim(expected),
+        builder.create<mlir::ConstantIntOp>(loc, i, i64)};
+    builder.create<mlir::CallOp>(loc, func, args);
+  }
+}
+
+void lowerMaskSetitem(mlir::OpBuilder &builder, mlir::Location loc,
+                      mlir::Value target, mlir::Value mask, mlir::Value value) {
+  genMaskShapeChecks(builder, loc, target, mask);
+
+  // Masked elements are updated in place with select, without branches.
+  auto rank =
+      static_cast<unsigned>(target.getType().cast<mlir::ShapedType>().getRank());
+  auto map = builder.getMultiDimIdentityMap(rank);
+  mlir::AffineMap maps[] = {map, map};
+  llvm::SmallVector<llvm::StringRef> iterators(rank, "parallel");
+  auto body = [&](mlir::OpBuilder &bodyBuilder, mlir::Location bodyLoc,
+                  mlir::ValueRange args) {
+    assert(args.size() == 2);
+    auto res =
+        bodyBuilder.create<mlir::SelectOp>(bodyLoc, args[0], value, args[1]);
+    bodyBuilder.create<mlir::linalg::YieldOp>(bodyLoc, res.getResult());
+  };
+  builder.create<mlir::linalg::GenericOp>(loc, llvm::None, mask, target, maps,
+                                          iterators, body);
+}
+
+void lowerIndexArraySetitem(mlir::OpBuilder &builder, mlir::Location loc,
+                            mlir::Value target, mlir::Value indices,
+                            mlir::Value value, bool checkBounds) {
+  // Indices are processed in order, so for duplicated indices last value
+  // wins, as in NumPy. Rows are copied by linalg ops, which are parallelized
+  // later.
+  auto targetType = target.getType().cast<mlir::MemRefType>();
+  auto rank = static_cast<unsigned>(targetType.getRank());
+  auto isArrayValue = value.getType().isa<mlir::MemRefType>();
+  if (isArrayValue)
+    genIndexArrayValueChecks(builder, loc, target, indices, value);
+
+  mlir::FuncOp checkIndexFunc;
+  if (checkBounds)
+    checkIndexFunc = getRuntimeCheckFunc(builder, "dpcomp_check_index", 2);
+
+  auto zero = builder.create<mlir::ConstantIndexOp>(loc, 0);
+  auto one = builder.create<mlir::ConstantIndexOp>(loc, 1);
+  auto count = builder.createOrFold<mlir::memref::DimOp>(loc, indices, 0);
+  auto size = builder.createOrFold<mlir::memref::DimOp>(loc, target, 0);
+  auto body = [&](mlir::OpBuilder &b, mlir::Location l, mlir::Value iv,
+                  mlir::ValueRange /*iterArgs*/) {
+    mlir::Value ind = b.create<mlir::memref::LoadOp>(l, indices, iv);
+    ind = b.create<mlir::IndexCastOp>(l, ind, b.getIndexType());
+    // Negative indices count from the end.
+    auto isNeg =
+        b.create<mlir::CmpIOp>(l, mlir::CmpIPredicate::slt, ind, zero);
+    auto wrapped = b.create<mlir::AddIOp>(l, ind, size);
+    ind = b.create<mlir::SelectOp>(l, isNeg, wrapped, ind);
+    if (checkIndexFunc) {
+      auto i64 = b.getIntegerType(64);
+      const mlir::Value args[] = {
+          b.create<mlir::IndexCastOp>(l, ind, i64),
+          b.createOrFold<mlir::IndexCastOp>(l, size, i64)};
+      b.create<mlir::CallOp>(l, checkIndexFunc, args);
+    }
+
+    if (rank == 1 && !isArrayValue) {
+      b.create<mlir::memref::StoreOp>(l, value, target, ind);
+    } else {
+      auto getRow = [&](mlir::Value src, mlir::Value row) -> mlir::Value {
+        llvm::SmallVector<mlir::OpFoldResult> offsets(rank,
+                                                      b.getIndexAttr(0));
+        llvm::SmallVector<mlir::OpFoldResult> sizes(rank);
+        llvm::SmallVector<mlir::OpFoldResult> strides(rank, b.getIndexAttr(1));
+        offsets[0] = row;
+        sizes[0] = b.getIndexAttr(1);
+        for (auto i : llvm::seq(1u, rank))
+          sizes[i] = b.createOrFold<mlir::memref::DimOp>(l, target, i);
+
+        return b.create<mlir::memref::SubViewOp>(l, src, offsets, sizes,
+                                                 strides);
+      };
+      auto dst = getRow(target, ind);
+      if (isArrayValue) {
+        b.create<mlir::linalg::CopyOp>(l, getRow(value, iv), dst);
+      } else {
+        auto map = b.getMultiDimIdentityMap(rank);
+        llvm::SmallVector<llvm::StringRef> iterators(rank, "parallel");
+        auto fillBody = [&](mlir::OpBuilder &fillBuilder,
+                            mlir::Location fillLoc, mlir::ValueRange) {
+          fillBuilder.create<mlir::linalg::YieldOp>(fillLoc, value);
+        };
+        b.create<mlir::linalg::GenericOp>(l, llvm::None, llvm::None, dst, map,
+                                          iterators, fillBody);
+      }
+    }
+    b.create<mlir::scf::YieldOp>(l);
+  };
+  builder.create<mlir::scf::ForOp>(loc, zero, count, one, llvm::None, body);
+}
+
 struct SetitemOpLowering : public mlir::OpRewritePattern<plier::SetItemOp> {
   using OpRewritePattern::OpRewritePattern;
 
@@ -1052,7 +1439,10 @@ struct SetitemOpLowering : public mlir::OpRewritePattern<plier::SetItemOp> {
       return mlir::failure();
     }
     auto index = op.index();
-    if (!isValidGetitemIndex(index.getType())) {
+    auto value = op.value();
+    bool isMask = isSetitemMask(targetType, index, value);
+    bool isIndexArray = isSetitemIndexArray(targetType, index, value);
+    if (!isMask && !isIndexArray && !isValidGetitemIndex(index.getType())) {
       return mlir::failure();
     }
 
@@ -1104,14 +1494,35 @@ struct SetitemOpLowering : public mlir::OpRewritePattern<plier::SetItemOp> {
       return mlir::failure();
     }
 
-    auto value = op.value();
     auto loc = op.getLoc();
-    if (value.getType() != elemType) {
+    if (!value.getType().isa<mlir::ShapedType>() &&
+        value.getType() != elemType) {
       // TODO
       value = rewriter.create<plier::CastOp>(loc, elemType, value);
       rerun_std_pipeline(op);
     }
 
+    if (isMask || isIndexArray) {
+      if (value.getType().isa<mlir::ShapedType>()) {
+        value = toSignlessMemref(rewriter, loc, value);
+      } else if (elemType != signlessElemType) {
+        value =
+            rewriter.create<plier::SignCastOp>(loc, signlessElemType, value);
+      }
+      index = toSignlessMemref(rewriter, loc, index);
+      if (isMask) {
+        lowerMaskSetitem(rewriter, loc, target, index, value);
+      } else {
+        auto func = op->getParentOfType<mlir::FuncOp>();
+        bool checkBounds =
+            func && func->hasAttr(plier::attributes::getBoundsCheckName());
+        lowerIndexArraySetitem(rewriter, loc, target, index, value,
+                               checkBounds);
+      }
+      rewriter.eraseOp(op);
+      return mlir::success();
+    }
+
     llvm::SmallVector<mlir::Value> indices;
     if (auto tupleType = index.getType().template dyn_cast<mlir::TupleType>()) {
       indices.resize(tupleType.size());
@@ -1416,6 +1827,24 @@ private:
   resolver_t resolver;
 };
 
+struct GetitemRewriter : public mlir::OpRewritePattern<plier::GetItemOp> {
+  using resolver_t = std::function<mlir::LogicalResult(
+      plier::GetItemOp, mlir::Value, mlir::Value, mlir::PatternRewriter &)>;
+
+  GetitemRewriter(mlir::TypeConverter & /*typeConverter*/,
+                  mlir::MLIRContext *context, resolver_t resolver)
+      : OpRewritePattern(context), resolver(resolver) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(plier::GetItemOp op,
+                  mlir::PatternRewriter &rewriter) const override {
+    return resolver(op, op.value(), op.index(), rewriter);
+  }
+
+private:
+  resolver_t resolver;
+};
+
 struct SimplifyExpandDims
     : public mlir::OpRewritePattern<mlir::linalg::GenericOp> {
   using mlir::OpRewritePattern<mlir::linalg::GenericOp>::OpRewritePattern;
@@ -1569,7 +1998,8 @@ void PlierToLinalgPass::runOnOperation() {
       // clang-format off
       plier::CallOpLowering,
       GetattrRewriter,
-      BinopRewriter
+      BinopRewriter,
+      GetitemRewriter
       // clang-format on
       >(typeConverter, context, std::ref(callLowerer));
 
@@ -1618,6 +2048,56 @@ void LowerLinalgPass::runOnOperation() {
   (void)mlir::applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
 }
 
+struct CopyElisionPass
+    : public mlir::PassWrapper<CopyElisionPass, mlir::FunctionPass> {
+  void runOnFunction() override {
+    (void)plier::replaceCopiesWithViews(getFunction());
+  }
+};
+
+struct MemoryPlanningPass
+    : public mlir::PassWrapper<MemoryPlanningPass, mlir::FunctionPass> {
+  void runOnFunction() override {
+    (void)plier::planBufferReuse(getFunction());
+  }
+};
+
+struct ElideRetainReleasePass
+    : public mlir::PassWrapper<ElideRetainReleasePass, mlir::FunctionPass> {
+  void runOnFunction() override {
+    (void)plier::elideRetainRelease(getFunction());
+  }
+};
+
+struct PromoteSmallBuffersPass
+    : public mlir::PassWrapper<PromoteSmallBuffersPass, mlir::FunctionPass> {
+  void runOnFunction() override {
+    (void)plier::promoteSmallBuffers(getFunction());
+  }
+};
+
+struct TileAndVectorizeLinalgPass
+    : public mlir::PassWrapper<TileAndVectorizeLinalgPass, mlir::FunctionPass> {
+  virtual void
+  getDependentDialects(mlir::DialectRegistry &registry) const override {
+    registry.insert<mlir::StandardOpsDialect>();
+    registry.insert<mlir::linalg::LinalgDialect>();
+    registry.insert<mlir::memref::MemRefDialect>();
+    registry.insert<mlir::scf::SCFDialect>();
+    registry.insert<mlir::AffineDialect>();
+    registry.insert<mlir::vector::VectorDialect>();
+    registry.insert<plier::PlierDialect>();
+  }
+
+  void runOnFunction() override {
+    auto func = getFunction();
+    if (getOptLevel(func) < 3)
+      return;
+
+    (void)plier::tileAndVectorizeLinalgOps(func);
+  }
+};
+
 struct OptimizeGlobalsConstsLoad
     : public mlir::OpRewritePattern<mlir::memref::LoadOp> {
   using mlir::OpRewritePattern<mlir::memref::LoadOp>::OpRewritePattern;
@@ -1977,13 +2457,14 @@ void PostLinalgOptPass::runOnFunction() {
 
   plier::populate_common_opts_patterns(context, patterns);
 
-  patterns.insert<OptimizeGlobalsConstsLoad, plier::CanonicalizeReduction,
-                  plier::PromoteToParallel, plier::MergeNestedForIntoParallel>(
-      &context);
+  patterns.insert<OptimizeGlobalsConstsLoad, plier::PromoteToParallel,
+                  plier::MergeNestedForIntoParallel>(&context);
 
   auto additionalOpt = [](mlir::FuncOp op) {
+    auto replaced = plier::replaceLoopScalars(op);
     (void)plier::prepareForFusion(op.getRegion());
-    return plier::naivelyFuseParallelOps(op.getRegion());
+    auto fused = plier::fuseParallelOps(op.getRegion());
+    return mlir::success(mlir::succeeded(replaced) || mlir::succeeded(fused));
   };
   if (mlir::failed(applyOptimizations(func, std::move(patterns),
                                       getAnalysisManager(), additionalOpt))) {
@@ -2023,11 +2504,15 @@ void populate_plier_to_linalg_opt_pipeline(mlir::OpPassManager &pm) {
 
   pm.addNestedPass<mlir::FuncOp>(std::make_unique<CloneArgsPass>());
   pm.addPass(std::make_unique<MakeStridedLayout>());
+  pm.addNestedPass<mlir::FuncOp>(std::make_unique<CopyElisionPass>());
   pm.addNestedPass<mlir::FuncOp>(mlir::createBufferDeallocationPass());
   pm.addPass(mlir::createCanonicalizerPass());
 
   pm.addNestedPass<mlir::FuncOp>(std::make_unique<LowerCloneOpsPass>());
+  pm.addNestedPass<mlir::FuncOp>(std::make_unique<MemoryPlanningPass>());
 
+  pm.addNestedPass<mlir::FuncOp>(
+      std::make_unique<TileAndVectorizeLinalgPass>());
   pm.addPass(std::make_unique<LowerLinalgPass>());
   pm.addPass(std::make_unique<ForceInlinePass>());
   pm.addPass(mlir::createSymbolDCEPass());
@@ -2037,6 +2522,8 @@ void populate_plier_to_linalg_opt_pipeline(mlir::OpPassManager &pm) {
   pm.addNestedPass<mlir::FuncOp>(std::make_unique<PostLinalgOptPass>());
 
   pm.addNestedPass<mlir::FuncOp>(std::make_unique<FixDeallocPlacementPass>());
+  pm.addNestedPass<mlir::FuncOp>(std::make_unique<ElideRetainReleasePass>());
+  pm.addNestedPass<mlir::FuncOp>(std::make_unique<PromoteSmallBuffersPass>());
 
   pm.addPass(mlir::createSymbolDCEPass());
 }
@@ -832,8 +832,9 @@ struct BinOpLowering : public mlir::OpRewritePattern<plier::BinOp> {
         {"<=",
          &replace_cmpi_op<mlir::CmpIPredicate::sle, mlir::CmpIPredicate::ule>,
          &replace_cmpf_op<mlir::CmpFPredicate::OLE>},
+        // NaN compares not equal to anything, including itself.
         {"!=", &replace_cmpi_op<mlir::CmpIPredicate::ne>,
-         &replace_cmpf_op<mlir::CmpFPredicate::ONE>},
+         &replace_cmpf_op<mlir::CmpFPredicate::UNE>},
         {"==", &replace_cmpi_op<mlir::CmpIPredicate::eq>,
          &replace_cmpf_op<mlir::CmpFPredicate::OEQ>},
     };
@@ -1800,6 +1801,44 @@ mlir::FuncOp get_lib_symbol(mlir::ModuleOp mod, llvm::StringRef name,
   return plier::add_function(rewriter, mod, name, type);
 }
 
+template <typename Op>
+mlir::Value create_math_op_impl(mlir::OpBuilder &builder, mlir::Location loc,
+                                mlir::Value arg) {
+  return builder.create<Op>(loc, arg);
+}
+
+/// Math dialect ops are elementwise and can be vectorized together with the
+/// surrounding loop, unlike libm calls. They are lowered to LLVM intrinsics.
+/// `tanh` has no intrinsic and is only used for f32 under fastmath, where it
+/// is expanded into polynomial approximation.
+mlir::Value create_math_op(mlir::OpBuilder &builder, mlir::Operation *op,
+                           llvm::StringRef name, mlir::Value arg) {
+  if (!arg.getType().isa<mlir::FloatType>())
+    return {};
+
+  auto loc = op->getLoc();
+  using func_t = mlir::Value (*)(mlir::OpBuilder &, mlir::Location,
+                                 mlir::Value);
+  const std::pair<llvm::StringRef, func_t> handlers[] = {
+      {"sqrt", &create_math_op_impl<mlir::math::SqrtOp>},
+      {"log", &create_math_op_impl<mlir::math::LogOp>},
+      {"exp", &create_math_op_impl<mlir::math::ExpOp>},
+      {"sin", &create_math_op_impl<mlir::math::SinOp>},
+      {"cos", &create_math_op_impl<mlir::math::CosOp>},
+  };
+  for (auto &h : handlers)
+    if (h.first == name)
+      return h.second(builder, loc, arg);
+
+  if (name == "tanh" && arg.getType().isF32()) {
+    auto func = op->getParentOfType<mlir::FuncOp>();
+    if (func && func->hasAttr(plier::attributes::getFastmathName()))
+      return create_math_op_impl<mlir::math::TanhOp>(builder, loc, arg);
+  }
+
+  return {};
+}
+
 mlir::LogicalResult
 lower_math_func(plier::PyCallOp op, llvm::StringRef name,
                 llvm::ArrayRef<mlir::Value> args,
@@ -1816,6 +1855,11 @@ lower_math_func(plier::PyCallOp op, llvm::StringRef name,
       valid_type(args[0].getType())) {
     auto loc = op.getLoc();
     mlir::Value arg = rewriter.create<plier::CastOp>(loc, ret_type, args[0]);
+    if (auto res = create_math_op(rewriter, op, name, arg)) {
+      rewriter.replaceOp(op, res);
+      return mlir::success();
+    }
+
     auto is_float = ret_type.isa<mlir::Float32Type>();
     auto func_type =
         mlir::FunctionType::get(op.getContext(), ret_type, ret_type);
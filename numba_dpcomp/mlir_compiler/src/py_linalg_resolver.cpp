@@ -521,27 +521,70 @@ unsigned get_float_bit_width(mlir::Type type) {
   return type.cast<mlir::FloatType>().getWidth();
 }
 
+/// Type kind order used by NumPy promotion: bool < int < float.
+int get_type_kind(mlir::Type type) {
+  if (type.isInteger(1)) {
+    return 0;
+  }
+  if (is_int(type)) {
+    return 1;
+  }
+  assert(is_float(type));
+  return 2;
+}
+
+/// Returns NumPy `promote_types` equivalent.
 mlir::Type broadcast_type(mlir::Type type1, mlir::Type type2) {
   if (type1 == type2) {
     return type1;
   }
-  // TODO
+  auto context = type1.getContext();
+  if (type1.isInteger(1)) {
+    return type2;
+  }
+  if (type2.isInteger(1)) {
+    return type1;
+  }
   if (is_int(type1) && is_int(type2)) {
-    bool isSigned = type1.isSignedInteger() || type2.isSignedInteger();
-    auto signess =
-        (isSigned ? mlir::IntegerType::Signed : mlir::IntegerType::Unsigned);
-    auto width = std::max(get_int_bit_width(type1), get_int_bit_width(type2));
-    return mlir::IntegerType::get(type1.getContext(), width, signess);
+    auto width1 = get_int_bit_width(type1);
+    auto width2 = get_int_bit_width(type2);
+    auto isUnsigned1 = type1.isUnsignedInteger();
+    auto isUnsigned2 = type2.isUnsignedInteger();
+    if (isUnsigned1 == isUnsigned2) {
+      auto signess = (isUnsigned1 ? mlir::IntegerType::Unsigned
+                                  : mlir::IntegerType::Signed);
+      return mlir::IntegerType::get(context, std::max(width1, width2), signess);
+    }
+    // Mixed signedness needs signed type wide enough for unsigned values.
+    auto signedWidth = (isUnsigned1 ? width2 : width1);
+    auto unsignedWidth = (isUnsigned1 ? width1 : width2);
+    if (signedWidth > unsignedWidth) {
+      return mlir::IntegerType::get(context, signedWidth,
+                                    mlir::IntegerType::Signed);
+    }
+    if (unsignedWidth < 64) {
+      return mlir::IntegerType::get(context, unsignedWidth * 2,
+                                    mlir::IntegerType::Signed);
+    }
+    return mlir::Float64Type::get(context);
   }
   if (is_float(type1) && is_float(type2)) {
     return (get_float_bit_width(type1) > get_float_bit_width(type2) ? type1
                                                                     : type2);
   }
-  if (is_float(type1) && is_int(type2)) {
-    return type1;
-  }
-  if (is_int(type1) && is_float(type2)) {
-    return type2;
+  if (is_float(type1) || is_float(type2)) {
+    auto floatType = (is_float(type1) ? type1 : type2);
+    auto intWidth = get_int_bit_width(is_float(type1) ? type2 : type1);
+    // Smallest float type which can represent all int values.
+    mlir::Type intFloatType;
+    if (intWidth <= 8) {
+      intFloatType = mlir::Float16Type::get(context);
+    } else if (intWidth <= 16) {
+      intFloatType = mlir::Float32Type::get(context);
+    } else {
+      intFloatType = mlir::Float64Type::get(context);
+    }
+    return broadcast_type(floatType, intFloatType);
   }
   llvm_unreachable("Unable to broadcast type");
 }
@@ -672,10 +715,17 @@ py::object broadcast_impl(py::capsule context, py::tuple args) {
     }
     return {};
   };
-  mlir::Type resType;
+  // Scalars only affect result type if they are of higher kind than all
+  // arrays, same as in NumPy.
+  mlir::Type arrayType;
+  mlir::Type scalarType;
+  auto addType = [&](mlir::Type type, bool isScalar) {
+    auto &dst = (isScalar ? scalarType : arrayType);
+    dst = (dst ? broadcast_type(dst, type) : type);
+  };
   mlir::SmallVector<mlir::Value> shapeVals;
   if (auto shapeAndType = getShape(mlirArgs.front())) {
-    resType = shapeAndType->second;
+    addType(shapeAndType->second, shapeAndType->first.empty());
     shapeVals = shapeAndType->first;
   } else {
     return py::none();
@@ -684,9 +734,9 @@ py::object broadcast_impl(py::capsule context, py::tuple args) {
   for (auto arg : llvm::drop_begin(mlirArgs)) {
     auto shapeAndType = getShape(arg);
     if (!shapeAndType) {
-      py::none();
+      return py::none();
     }
-    resType = broadcast_type(resType, shapeAndType->second);
+    addType(shapeAndType->second, shapeAndType->first.empty());
     auto newShapeVals = shapeAndType->first;
     for (auto it :
          llvm::zip(llvm::reverse(shapeVals), llvm::reverse(newShapeVals))) {
@@ -701,6 +751,17 @@ py::object broadcast_impl(py::capsule context, py::tuple args) {
     }
   }
 
+  auto resType = [&]() {
+    if (!arrayType) {
+      return scalarType;
+    }
+    if (!scalarType ||
+        get_type_kind(scalarType) <= get_type_kind(arrayType)) {
+      return arrayType;
+    }
+    return broadcast_type(arrayType, scalarType);
+  }();
+
   py::tuple ret(mlirArgs.size());
   if (shapeVals.empty()) {
     for (auto it : llvm::enumerate(mlirArgs)) {
@@ -872,7 +933,7 @@ py::object fill_tensor_impl(py::capsule context, py::handle tensor,
 
 py::object generic_impl(py::capsule context, py::handle inputs,
                         py::handle outputs, py::list iterators, py::list maps,
-                        py::handle body) {
+                        py::handle body, py::iterable indices) {
   auto &ctx = get_py_context(context);
   auto loc = ctx.loc;
   auto &builder = ctx.builder;
@@ -886,7 +947,14 @@ py::object generic_impl(py::capsule context, py::handle inputs,
   auto outputArgs = getAgrsFromTuple(outputs, unpack);
   auto mlirIterators = getIterators(iterators, mlirContext);
 
+  // Requested loop indices are passed to the body after the block arguments.
+  llvm::SmallVector<int64_t> indexDims;
+  for (auto dim : indices)
+    indexDims.emplace_back(dim.cast<int64_t>());
+
   auto bodyTypes = getGenericOpBodyTypes(inputsArgs, outputArgs);
+  auto indexType = builder.getIntegerType(64);
+  bodyTypes.append(indexDims.size(), indexType);
   auto funcTypes = mapTypesToNumbaChecked(ctx.context.types_mod, bodyTypes);
   auto bodyFunc = ctx.context.compile_body(body, funcTypes);
 
@@ -910,7 +978,14 @@ py::object generic_impl(py::capsule context, py::handle inputs,
   auto body_builder = [&](mlir::OpBuilder &builder, mlir::Location loc,
                           mlir::ValueRange args) {
     auto funcType = bodyFunc.getType();
-    auto newArgs = castValues(doSignCast(builder, loc, args, bodyTypes),
+    llvm::SmallVector<mlir::Value> bodyArgs(args.begin(), args.end());
+    for (auto dim : indexDims) {
+      auto index = builder.create<mlir::linalg::IndexOp>(loc, dim);
+      bodyArgs.emplace_back(
+          builder.create<mlir::IndexCastOp>(loc, index, indexType));
+    }
+    assert(bodyArgs.size() == bodyTypes.size());
+    auto newArgs = castValues(doSignCast(builder, loc, bodyArgs, bodyTypes),
                               funcType.getInputs());
     auto call = builder.create<mlir::CallOp>(loc, bodyFunc, newArgs);
     auto newResults = doSignCast(
@@ -1083,6 +1158,7 @@ py::object external_call_impl(py::capsule context, py::str func_name,
   };
   auto inputVals = to_values(inputs, unwrapVal);
   auto outputVals = to_values(outputs, unwrapVal);
+  auto numInputs = static_cast<unsigned>(inputVals.size());
 
   inputVals.reserve(inputVals.size() + outputVals.size());
 
@@ -1120,6 +1196,11 @@ py::object external_call_impl(py::capsule context, py::str func_name,
       f = plier::add_function(builder, mod, name, funcType);
       f->setAttr("llvm.emit_c_interface",
                  mlir::UnitAttr::get(builder.getContext()));
+      // External functions only write into output buffers.
+      for (auto i : llvm::seq(0u, numInputs))
+        if (argTypes[i].isa<mlir::ShapedType>())
+          f.setArgAttr(i, plier::attributes::getReadonlyName(),
+                       mlir::UnitAttr::get(builder.getContext()));
     }
     return f;
   }();
@@ -1267,6 +1348,7 @@ void setup_py_builder(py::handle builder, mlir::OpBuilder &b,
     py::setattr(builder, name, create_type(type));
   };
 
+  addType("bool", b.getIntegerType(1));
   addType("int8", b.getIntegerType(8, true));
   addType("uint8", b.getIntegerType(8, false));
   addType("int16", b.getIntegerType(16, true));
@@ -0,0 +1,92 @@
+// RUN: dpcomp-opt %s --dpcomp-copy-elision -split-input-file | FileCheck %s
+
+#map0 = affine_map<(d0, d1) -> (d1, d0)>
+#map1 = affine_map<(d0, d1) -> (d0, d1)>
+
+// CHECK-LABEL: func @transpose_view
+// CHECK-NOT: memref.alloc
+// CHECK-NOT: linalg.generic
+// CHECK: %[[VIEW:.*]] = memref.reinterpret_cast %arg0
+// CHECK: linalg.copy(%[[VIEW]], %arg1)
+func @transpose_view(%arg0: memref<?x?xf32>, %arg1: memref<?x?xf32, affine_map<(d0, d1)[s0, s1, s2] -> (d0 * s1 + s0 + d1 * s2)>> {llvm.noalias = true}) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?x?xf32>
+  %1 = memref.dim %arg0, %c1 : memref<?x?xf32>
+  %2 = memref.alloc(%1, %0) : memref<?x?xf32>
+  linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "parallel"]} ins(%arg0 : memref<?x?xf32>) outs(%2 : memref<?x?xf32>) {
+  ^bb0(%a: f32, %b: f32):
+    linalg.yield %a : f32
+  }
+  linalg.copy(%2, %arg1) : memref<?x?xf32>, memref<?x?xf32, affine_map<(d0, d1)[s0, s1, s2] -> (d0 * s1 + s0 + d1 * s2)>>
+  return
+}
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d1)>
+#map1 = affine_map<(d0, d1) -> (d0, d1)>
+
+// CHECK-LABEL: func @unit_dim_view
+// CHECK-NOT: memref.alloc
+// CHECK: memref.reinterpret_cast %arg0 {{.*}} sizes: [1, %{{.*}}], strides: [0, %{{.*}}]
+func @unit_dim_view(%arg0: memref<?xf32>, %arg1: memref<?xf32>) -> f32 {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf32>
+  %1 = memref.alloc(%0) : memref<1x?xf32>
+  linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "parallel"]} ins(%arg0 : memref<?xf32>) outs(%1 : memref<1x?xf32>) {
+  ^bb0(%a: f32, %b: f32):
+    linalg.yield %a : f32
+  }
+  %2 = memref.load %1[%c0, %c1] : memref<1x?xf32>
+  return %2 : f32
+}
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d1, d0)>
+#map1 = affine_map<(d0, d1) -> (d0, d1)>
+
+// CHECK-LABEL: func @no_view_source_modified
+// CHECK: memref.alloc
+// CHECK: linalg.generic
+// CHECK-NOT: memref.reinterpret_cast
+func @no_view_source_modified(%arg0: memref<?x?xf32>, %arg1: f32) -> f32 {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?x?xf32>
+  %1 = memref.dim %arg0, %c1 : memref<?x?xf32>
+  %2 = memref.alloc(%1, %0) : memref<?x?xf32>
+  linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "parallel"]} ins(%arg0 : memref<?x?xf32>) outs(%2 : memref<?x?xf32>) {
+  ^bb0(%a: f32, %b: f32):
+    linalg.yield %a : f32
+  }
+  memref.store %arg1, %arg0[%c0, %c1] : memref<?x?xf32>
+  %3 = memref.load %2[%c1, %c0] : memref<?x?xf32>
+  return %3 : f32
+}
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d1, d0)>
+#map1 = affine_map<(d0, d1) -> (d0, d1)>
+
+// CHECK-LABEL: func @no_view_result_modified
+// CHECK: memref.alloc
+// CHECK: linalg.generic
+// CHECK-NOT: memref.reinterpret_cast
+func @no_view_result_modified(%arg0: memref<?x?xf32>, %arg1: f32) -> f32 {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?x?xf32>
+  %1 = memref.dim %arg0, %c1 : memref<?x?xf32>
+  %2 = memref.alloc(%1, %0) : memref<?x?xf32>
+  linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "parallel"]} ins(%arg0 : memref<?x?xf32>) outs(%2 : memref<?x?xf32>) {
+  ^bb0(%a: f32, %b: f32):
+    linalg.yield %a : f32
+  }
+  memref.store %arg1, %2[%c0, %c1] : memref<?x?xf32>
+  %3 = memref.load %2[%c1, %c0] : memref<?x?xf32>
+  return %3 : f32
+}
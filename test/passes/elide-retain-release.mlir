@@ -0,0 +1,63 @@
+// RUN: dpcomp-opt %s --dpcomp-elide-retain-release -split-input-file | FileCheck %s
+
+// CHECK-LABEL: func @elide_returned
+// CHECK: %[[BUF:.*]] = memref.alloc
+// CHECK-NOT: plier.retain
+// CHECK-NOT: memref.dealloc
+// CHECK: return %[[BUF]]
+func @elide_returned(%arg0: memref<?xf64>) -> memref<?xf64> {
+  %c0 = constant 0 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf64>
+  %1 = memref.alloc(%0) : memref<?xf64>
+  linalg.copy(%arg0, %1) : memref<?xf64>, memref<?xf64>
+  %2 = "plier.retain"(%1) : (memref<?xf64>) -> memref<?xf64>
+  memref.dealloc %1 : memref<?xf64>
+  return %2 : memref<?xf64>
+}
+
+// -----
+
+// CHECK-LABEL: func @elide_inlined
+// CHECK: %[[BUF:.*]] = memref.alloc
+// CHECK-NOT: plier.retain
+// CHECK: linalg.copy(%[[BUF]], %arg1)
+// CHECK-NOT: memref.dealloc
+// CHECK: return
+func @elide_inlined(%arg0: memref<?xf64>, %arg1: memref<?xf64>) {
+  %c0 = constant 0 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf64>
+  %1 = memref.alloc(%0) : memref<?xf64>
+  linalg.copy(%arg0, %1) : memref<?xf64>, memref<?xf64>
+  %2 = "plier.retain"(%1) : (memref<?xf64>) -> memref<?xf64>
+  memref.dealloc %1 : memref<?xf64>
+  linalg.copy(%2, %arg1) : memref<?xf64>, memref<?xf64>
+  memref.dealloc %2 : memref<?xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @keep_arg_retain
+// CHECK: plier.retain
+func @keep_arg_retain(%arg0: memref<?xf64>) -> memref<?xf64> {
+  %0 = "plier.retain"(%arg0) : (memref<?xf64>) -> memref<?xf64>
+  return %0 : memref<?xf64>
+}
+
+// -----
+
+func private @foo(memref<?xf64>)
+
+// CHECK-LABEL: func @keep_call_between
+// CHECK: plier.retain
+// CHECK: call @foo
+// CHECK: memref.dealloc
+func @keep_call_between(%arg0: memref<?xf64>) -> memref<?xf64> {
+  %c0 = constant 0 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf64>
+  %1 = memref.alloc(%0) : memref<?xf64>
+  %2 = "plier.retain"(%1) : (memref<?xf64>) -> memref<?xf64>
+  call @foo(%1) : (memref<?xf64>) -> ()
+  memref.dealloc %1 : memref<?xf64>
+  return %2 : memref<?xf64>
+}
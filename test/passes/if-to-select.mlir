@@ -0,0 +1,30 @@
+// RUN: dpcomp-opt %s --dpcomp-if-to-select -split-input-file | FileCheck %s
+
+// CHECK-LABEL: func @if_to_select
+// CHECK-NOT: scf.if
+// CHECK: %[[RES:.*]] = select %arg0, %arg1, %arg2 : f32
+// CHECK: return %[[RES]]
+func @if_to_select(%arg0: i1, %arg1: f32, %arg2: f32) -> f32 {
+  %0 = scf.if %arg0 -> (f32) {
+    scf.yield %arg1 : f32
+  } else {
+    scf.yield %arg2 : f32
+  }
+  return %0 : f32
+}
+
+// -----
+
+// CHECK-LABEL: func @no_select_speculated_op
+// CHECK: scf.if
+// CHECK: divi_signed
+// CHECK-NOT: select
+func @no_select_speculated_op(%arg0: i1, %arg1: i64, %arg2: i64) -> i64 {
+  %0 = scf.if %arg0 -> (i64) {
+    %1 = divi_signed %arg1, %arg2 : i64
+    scf.yield %1 : i64
+  } else {
+    scf.yield %arg2 : i64
+  }
+  return %0 : i64
+}
@@ -0,0 +1,142 @@
+// RUN: dpcomp-opt %s --dpcomp-memory-planning -split-input-file | FileCheck %s
+
+#map = affine_map<(d0) -> (d0)>
+
+// CHECK-LABEL: func @reuse_input
+// CHECK: %[[BUF:.*]] = memref.alloc
+// CHECK-NOT: memref.alloc
+// CHECK: linalg.generic {{.*}} ins(%arg0 : memref<?xf32>) outs(%[[BUF]] : memref<?xf32>)
+// CHECK: linalg.generic {{.*}} ins(%[[BUF]], %arg1 : memref<?xf32>, memref<?xf32>) outs(%[[BUF]] : memref<?xf32>)
+// CHECK: linalg.copy(%[[BUF]], %arg2)
+// CHECK: memref.dealloc %[[BUF]]
+// CHECK-NOT: memref.dealloc
+func @reuse_input(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %arg2: memref<?xf32>) {
+  %c0 = constant 0 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf32>
+  %1 = memref.alloc(%0) : memref<?xf32>
+  linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]} ins(%arg0 : memref<?xf32>) outs(%1 : memref<?xf32>) {
+  ^bb0(%a: f32, %b: f32):
+    %2 = addf %a, %a : f32
+    linalg.yield %2 : f32
+  }
+  %3 = memref.alloc(%0) : memref<?xf32>
+  linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel"]} ins(%1, %arg1 : memref<?xf32>, memref<?xf32>) outs(%3 : memref<?xf32>) {
+  ^bb0(%a: f32, %b: f32, %c: f32):
+    %4 = addf %a, %b : f32
+    linalg.yield %4 : f32
+  }
+  memref.dealloc %1 : memref<?xf32>
+  linalg.copy(%3, %arg2) : memref<?xf32>, memref<?xf32>
+  memref.dealloc %3 : memref<?xf32>
+  return
+}
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d1, d0)>
+
+// CHECK-LABEL: func @no_reuse_input_transposed
+// CHECK: memref.alloc
+// CHECK: memref.alloc
+func @no_reuse_input_transposed(%arg0: memref<?x?xf32>, %arg1: memref<?x?xf32>) {
+  %c0 = constant 0 : index
+  %0 = memref.dim %arg0, %c0 : memref<?x?xf32>
+  %1 = memref.alloc(%0, %0) : memref<?x?xf32>
+  linalg.copy(%arg0, %1) : memref<?x?xf32>, memref<?x?xf32>
+  %2 = memref.alloc(%0, %0) : memref<?x?xf32>
+  linalg.generic {indexing_maps = [#map1, #map0], iterator_types = ["parallel", "parallel"]} ins(%1 : memref<?x?xf32>) outs(%2 : memref<?x?xf32>) {
+  ^bb0(%a: f32, %b: f32):
+    linalg.yield %a : f32
+  }
+  memref.dealloc %1 : memref<?x?xf32>
+  linalg.copy(%2, %arg1) : memref<?x?xf32>, memref<?x?xf32>
+  memref.dealloc %2 : memref<?x?xf32>
+  return
+}
+
+// -----
+
+#map = affine_map<(d0) -> (d0)>
+#strided = affine_map<(d0)[s0, s1] -> (d0 * s1 + s0)>
+
+// CHECK-LABEL: func @no_reuse_input_aliased_view
+// CHECK: memref.alloc
+// CHECK: memref.alloc
+func @no_reuse_input_aliased_view(%arg0: memref<?xf32>, %arg1: memref<?xf32>) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %cm1 = constant -1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf32>
+  %1 = subi %0, %c1 : index
+  %2 = memref.alloc(%0) : memref<?xf32>
+  linalg.copy(%arg0, %2) : memref<?xf32>, memref<?xf32>
+  %3 = memref.reinterpret_cast %2 to offset: [%1], sizes: [%0], strides: [%cm1] : memref<?xf32> to memref<?xf32, #strided>
+  %4 = memref.alloc(%0) : memref<?xf32>
+  linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel"]} ins(%3, %2 : memref<?xf32, #strided>, memref<?xf32>) outs(%4 : memref<?xf32>) {
+  ^bb0(%a: f32, %b: f32, %c: f32):
+    %5 = addf %a, %b : f32
+    linalg.yield %5 : f32
+  }
+  memref.dealloc %2 : memref<?xf32>
+  linalg.copy(%4, %arg1) : memref<?xf32>, memref<?xf32>
+  memref.dealloc %4 : memref<?xf32>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @reuse_slot
+// CHECK: %[[BUF:.*]] = memref.alloc
+// CHECK: linalg.copy(%arg0, %[[BUF]])
+// CHECK: linalg.copy(%[[BUF]], %arg1)
+// CHECK-NOT: memref.alloc
+// CHECK: linalg.copy(%arg1, %[[BUF]])
+// CHECK: linalg.copy(%[[BUF]], %arg2)
+// CHECK: memref.dealloc %[[BUF]]
+// CHECK-NOT: memref.dealloc
+func @reuse_slot(%arg0: memref<16xf32>, %arg1: memref<16xf32>, %arg2: memref<16xf32>) {
+  %0 = memref.alloc() : memref<16xf32>
+  linalg.copy(%arg0, %0) : memref<16xf32>, memref<16xf32>
+  linalg.copy(%0, %arg1) : memref<16xf32>, memref<16xf32>
+  memref.dealloc %0 : memref<16xf32>
+  %1 = memref.alloc() : memref<16xf32>
+  linalg.copy(%arg1, %1) : memref<16xf32>, memref<16xf32>
+  linalg.copy(%1, %arg2) : memref<16xf32>, memref<16xf32>
+  memref.dealloc %1 : memref<16xf32>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_reuse_slot_overlap
+// CHECK: memref.alloc
+// CHECK: memref.alloc
+func @no_reuse_slot_overlap(%arg0: memref<16xf32>, %arg1: memref<16xf32>) {
+  %0 = memref.alloc() : memref<16xf32>
+  %1 = memref.alloc() : memref<16xf32>
+  linalg.copy(%arg0, %0) : memref<16xf32>, memref<16xf32>
+  linalg.copy(%arg1, %1) : memref<16xf32>, memref<16xf32>
+  linalg.copy(%0, %arg1) : memref<16xf32>, memref<16xf32>
+  linalg.copy(%1, %arg0) : memref<16xf32>, memref<16xf32>
+  memref.dealloc %0 : memref<16xf32>
+  memref.dealloc %1 : memref<16xf32>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_reuse_slot_different_size
+// CHECK: memref.alloc
+// CHECK: memref.alloc
+func @no_reuse_slot_different_size(%arg0: memref<16xf32>, %arg1: memref<8xf32>) {
+  %0 = memref.alloc() : memref<16xf32>
+  linalg.copy(%arg0, %0) : memref<16xf32>, memref<16xf32>
+  linalg.copy(%0, %arg0) : memref<16xf32>, memref<16xf32>
+  memref.dealloc %0 : memref<16xf32>
+  %1 = memref.alloc() : memref<8xf32>
+  linalg.copy(%arg1, %1) : memref<8xf32>, memref<8xf32>
+  linalg.copy(%1, %arg1) : memref<8xf32>, memref<8xf32>
+  memref.dealloc %1 : memref<8xf32>
+  return
+}
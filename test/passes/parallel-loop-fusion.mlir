@@ -0,0 +1,198 @@
+// RUN: dpcomp-opt %s --dpcomp-parallel-loop-fusion -split-input-file | FileCheck %s
+
+// CHECK-LABEL: func @fuse_equal_constants
+// CHECK: scf.parallel
+// CHECK-NOT: scf.parallel
+// CHECK: scf.reduce
+func @fuse_equal_constants(%arg0: memref<?xf32>, %arg1: memref<?xf32>) -> f32 {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %c10 = constant 10 : index
+  %c0_1 = constant 0 : index
+  %c1_1 = constant 1 : index
+  %c10_1 = constant 10 : index
+  %cst = constant 0.0 : f32
+  scf.parallel (%i) = (%c0) to (%c10) step (%c1) {
+    %0 = memref.load %arg0[%i] : memref<?xf32>
+    memref.store %0, %arg1[%i] : memref<?xf32>
+    scf.yield
+  }
+  %1 = scf.parallel (%i) = (%c0_1) to (%c10_1) step (%c1_1) init (%cst) -> f32 {
+    %2 = memref.load %arg1[%i] : memref<?xf32>
+    scf.reduce(%2) : f32 {
+    ^bb0(%lhs: f32, %rhs: f32):
+      %3 = addf %lhs, %rhs : f32
+      scf.reduce.return %3 : f32
+    }
+    scf.yield
+  }
+  return %1 : f32
+}
+
+// -----
+
+// CHECK-LABEL: func @fuse_equivalent_indices
+// CHECK: scf.parallel
+// CHECK-NOT: scf.parallel
+func @fuse_equivalent_indices(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %arg2: memref<?xf32>, %arg3: index) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %0 = memref.load %arg0[%i] : memref<?xf32>
+    %1 = addi %i, %c1 : index
+    memref.store %0, %arg1[%1] : memref<?xf32>
+    scf.yield
+  }
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %2 = addi %i, %c1 : index
+    %3 = memref.load %arg1[%2] : memref<?xf32>
+    memref.store %3, %arg2[%i] : memref<?xf32>
+    scf.yield
+  }
+  return
+}
+
+// -----
+
+#map = affine_map<(d0) -> (d0 + 1)>
+
+// CHECK-LABEL: func @fuse_subview
+// CHECK: scf.parallel
+// CHECK-NOT: scf.parallel
+func @fuse_subview(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %arg2: memref<?xf32>, %arg3: index) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.subview %arg1[1] [%arg3] [1] : memref<?xf32> to memref<?xf32, #map>
+  %1 = memref.subview %arg1[1] [%arg3] [1] : memref<?xf32> to memref<?xf32, #map>
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %2 = memref.load %arg0[%i] : memref<?xf32>
+    memref.store %2, %0[%i] : memref<?xf32, #map>
+    scf.yield
+  }
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %3 = memref.load %1[%i] : memref<?xf32, #map>
+    memref.store %3, %arg2[%i] : memref<?xf32>
+    scf.yield
+  }
+  return
+}
+
+// -----
+
+#map = affine_map<(d0) -> (d0 + 1)>
+
+// CHECK-LABEL: func @no_fuse_different_views
+// CHECK: scf.parallel
+// CHECK: scf.parallel
+func @no_fuse_different_views(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %arg2: memref<?xf32>, %arg3: index) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.subview %arg1[1] [%arg3] [1] : memref<?xf32> to memref<?xf32, #map>
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %1 = memref.load %arg0[%i] : memref<?xf32>
+    memref.store %1, %0[%i] : memref<?xf32, #map>
+    scf.yield
+  }
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %2 = memref.load %arg1[%i] : memref<?xf32>
+    memref.store %2, %arg2[%i] : memref<?xf32>
+    scf.yield
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_fuse_shifted_index
+// CHECK: scf.parallel
+// CHECK: scf.parallel
+func @no_fuse_shifted_index(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %arg2: memref<?xf32>, %arg3: index) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %0 = memref.load %arg0[%i] : memref<?xf32>
+    memref.store %0, %arg1[%i] : memref<?xf32>
+    scf.yield
+  }
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %1 = addi %i, %c1 : index
+    %2 = memref.load %arg1[%1] : memref<?xf32>
+    memref.store %2, %arg2[%i] : memref<?xf32>
+    scf.yield
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @fuse_commuted_indices
+// CHECK: scf.parallel
+// CHECK-NOT: scf.parallel
+func @fuse_commuted_indices(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %arg2: memref<?xf32>, %arg3: index) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %0 = memref.load %arg0[%i] : memref<?xf32>
+    %1 = addi %i, %c1 : index
+    memref.store %0, %arg1[%1] : memref<?xf32>
+    scf.yield
+  }
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %2 = addi %c1, %i : index
+    %3 = memref.load %arg1[%2] : memref<?xf32>
+    memref.store %3, %arg2[%i] : memref<?xf32>
+    scf.yield
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @fuse_even_odd
+// CHECK: scf.parallel
+// CHECK-NOT: scf.parallel
+func @fuse_even_odd(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %arg2: memref<?xf32>, %arg3: index) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %c2 = constant 2 : index
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %0 = memref.load %arg0[%i] : memref<?xf32>
+    %1 = muli %i, %c2 : index
+    memref.store %0, %arg1[%1] : memref<?xf32>
+    scf.yield
+  }
+  scf.parallel (%i) = (%c0) to (%arg3) step (%c1) {
+    %2 = muli %i, %c2 : index
+    %3 = addi %2, %c1 : index
+    %4 = memref.load %arg1[%3] : memref<?xf32>
+    memref.store %4, %arg2[%i] : memref<?xf32>
+    scf.yield
+  }
+  return
+}
+
+// -----
+
+#map = affine_map<(d0) -> (d0 + 8)>
+
+// CHECK-LABEL: func @fuse_disjoint_subviews
+// CHECK: scf.parallel
+// CHECK-NOT: scf.parallel
+func @fuse_disjoint_subviews(%arg0: memref<8xf32>, %arg1: memref<16xf32>, %arg2: memref<8xf32>) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %c8 = constant 8 : index
+  %0 = memref.subview %arg1[0] [8] [1] : memref<16xf32> to memref<8xf32>
+  %1 = memref.subview %arg1[8] [8] [1] : memref<16xf32> to memref<8xf32, #map>
+  scf.parallel (%i) = (%c0) to (%c8) step (%c1) {
+    %2 = memref.load %arg0[%i] : memref<8xf32>
+    memref.store %2, %0[%i] : memref<8xf32>
+    scf.yield
+  }
+  scf.parallel (%i) = (%c0) to (%c8) step (%c1) {
+    %3 = memref.load %1[%i] : memref<8xf32, #map>
+    memref.store %3, %arg2[%i] : memref<8xf32>
+    scf.yield
+  }
+  return
+}
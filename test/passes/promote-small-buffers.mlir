@@ -0,0 +1,106 @@
+// RUN: dpcomp-opt %s --dpcomp-promote-small-buffers -split-input-file | FileCheck %s
+
+// CHECK-LABEL: func @scalarize
+// CHECK-NOT: memref.alloc
+// CHECK: %[[RES:.*]] = addf %arg0, %arg1 : f64
+// CHECK: return %[[RES]] : f64
+func @scalarize(%arg0: f64, %arg1: f64) -> f64 attributes {"#plier.stack_promotion_size" = 1024 : i64} {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.alloc() : memref<3xf64>
+  memref.store %arg0, %0[%c0] : memref<3xf64>
+  memref.store %arg1, %0[%c1] : memref<3xf64>
+  %1 = memref.load %0[%c0] : memref<3xf64>
+  %2 = memref.load %0[%c1] : memref<3xf64>
+  %3 = addf %1, %2 : f64
+  memref.dealloc %0 : memref<3xf64>
+  return %3 : f64
+}
+
+// -----
+
+// CHECK-LABEL: func @promote_to_stack
+// CHECK: %[[BUF:.*]] = memref.alloca() : memref<3xf64>
+// CHECK: scf.for
+// CHECK: linalg.copy(%arg0, %[[BUF]])
+// CHECK: linalg.copy(%[[BUF]], %arg1)
+// CHECK-NOT: memref.alloc(
+// CHECK-NOT: memref.dealloc
+func @promote_to_stack(%arg0: memref<3xf64>, %arg1: memref<3xf64>, %arg2: index) attributes {"#plier.stack_promotion_size" = 1024 : i64} {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  scf.for %i = %c0 to %arg2 step %c1 {
+    %0 = memref.alloc() : memref<3xf64>
+    linalg.copy(%arg0, %0) : memref<3xf64>, memref<3xf64>
+    linalg.copy(%0, %arg1) : memref<3xf64>, memref<3xf64>
+    memref.dealloc %0 : memref<3xf64>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_promote_parallel
+// CHECK: scf.parallel
+// CHECK: memref.alloc
+// CHECK: memref.dealloc
+func @no_promote_parallel(%arg0: memref<3xf64>, %arg1: memref<3xf64>, %arg2: index) attributes {"#plier.stack_promotion_size" = 1024 : i64} {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  scf.parallel (%i) = (%c0) to (%arg2) step (%c1) {
+    %0 = memref.alloc() : memref<3xf64>
+    linalg.copy(%arg0, %0) : memref<3xf64>, memref<3xf64>
+    linalg.copy(%0, %arg1) : memref<3xf64>, memref<3xf64>
+    memref.dealloc %0 : memref<3xf64>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_promote_large
+// CHECK: memref.alloc
+// CHECK: memref.dealloc
+func @no_promote_large(%arg0: memref<256xf64>) attributes {"#plier.stack_promotion_size" = 1024 : i64} {
+  %0 = memref.alloc() : memref<256xf64>
+  linalg.copy(%arg0, %0) : memref<256xf64>, memref<256xf64>
+  linalg.copy(%0, %arg0) : memref<256xf64>, memref<256xf64>
+  memref.dealloc %0 : memref<256xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_promote_returned
+// CHECK: memref.alloc
+func @no_promote_returned(%arg0: memref<3xf64>) -> memref<3xf64> attributes {"#plier.stack_promotion_size" = 1024 : i64} {
+  %0 = memref.alloc() : memref<3xf64>
+  linalg.copy(%arg0, %0) : memref<3xf64>, memref<3xf64>
+  return %0 : memref<3xf64>
+}
+
+// -----
+
+// CHECK-LABEL: func @no_promote_retained
+// CHECK: memref.alloc
+func @no_promote_retained(%arg0: memref<3xf64>) -> memref<3xf64> attributes {"#plier.stack_promotion_size" = 1024 : i64} {
+  %0 = memref.alloc() : memref<3xf64>
+  linalg.copy(%arg0, %0) : memref<3xf64>, memref<3xf64>
+  %1 = "plier.retain"(%0) : (memref<3xf64>) -> memref<3xf64>
+  memref.dealloc %0 : memref<3xf64>
+  return %1 : memref<3xf64>
+}
+
+// -----
+
+func private @foo(memref<3xf64>)
+
+// CHECK-LABEL: func @no_promote_call
+// CHECK: memref.alloc
+func @no_promote_call(%arg0: memref<3xf64>) attributes {"#plier.stack_promotion_size" = 1024 : i64} {
+  %0 = memref.alloc() : memref<3xf64>
+  linalg.copy(%arg0, %0) : memref<3xf64>, memref<3xf64>
+  call @foo(%0) : (memref<3xf64>) -> ()
+  memref.dealloc %0 : memref<3xf64>
+  return
+}
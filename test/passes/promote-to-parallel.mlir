@@ -1,4 +1,4 @@
-// RUN: dpcomp-opt %s --dpcomp-promote-to-parallel | FileCheck %s
+// RUN: dpcomp-opt %s --dpcomp-promote-to-parallel -split-input-file | FileCheck %s
 
 // CHECK: promote
 // CHECK: scf.parallel
@@ -15,3 +15,200 @@ func @promote(%arg0: i64) -> i64 {
   }
   return %1 : i64
 }
+
+// -----
+
+#map = affine_map<(d0)[s0, s1] -> (d0 * s1 + s0)>
+
+// CHECK-LABEL: func @version_aliasing
+// CHECK: plier.extract_memref_pointer
+// CHECK: scf.if
+// CHECK: scf.parallel
+// CHECK: else
+// CHECK: scf.for
+// CHECK: "#plier.versioned"
+func @version_aliasing(%arg0: memref<?xf32, #map>, %arg1: memref<?xf32, #map>) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %cst = constant 2.0 : f32
+  %0 = memref.dim %arg0, %c0 : memref<?xf32, #map>
+  scf.for %arg2 = %c0 to %0 step %c1 {
+    %1 = memref.load %arg0[%arg2] : memref<?xf32, #map>
+    %2 = mulf %1, %cst : f32
+    memref.store %2, %arg1[%arg2] : memref<?xf32, #map>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_version_private
+// CHECK-NOT: scf.if
+// CHECK: scf.parallel
+func @no_version_private(%arg0: memref<?xf32>) -> memref<?xf32> {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf32>
+  %1 = memref.alloc(%0) : memref<?xf32>
+  scf.for %arg1 = %c0 to %0 step %c1 {
+    %2 = memref.load %arg0[%arg1] : memref<?xf32>
+    memref.store %2, %1[%arg1] : memref<?xf32>
+  }
+  return %1 : memref<?xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @no_promote_shifted_index
+// CHECK-NOT: scf.parallel
+// CHECK: scf.for
+func @no_promote_shifted_index(%arg0: memref<?xf32>) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf32>
+  %1 = subi %0, %c1 : index
+  scf.for %arg1 = %c0 to %1 step %c1 {
+    %2 = addi %arg1, %c1 : index
+    %3 = memref.load %arg0[%2] : memref<?xf32>
+    memref.store %3, %arg0[%arg1] : memref<?xf32>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_promote_invariant_store
+// CHECK-NOT: scf.parallel
+// CHECK: scf.for
+func @no_promote_invariant_store(%arg0: memref<?xf32>, %arg1: memref<?xf32>) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf32>
+  scf.for %arg2 = %c0 to %0 step %c1 {
+    %1 = memref.load %arg0[%arg2] : memref<?xf32>
+    memref.store %1, %arg1[%c0] : memref<?xf32>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @promote_even_odd
+// CHECK-NOT: scf.if
+// CHECK: scf.parallel
+func @promote_even_odd(%arg0: memref<?xf32>, %arg1: index) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %c2 = constant 2 : index
+  scf.for %arg2 = %c0 to %arg1 step %c1 {
+    %0 = muli %arg2, %c2 : index
+    %1 = addi %0, %c1 : index
+    %2 = memref.load %arg0[%1] : memref<?xf32>
+    memref.store %2, %arg0[%0] : memref<?xf32>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @promote_step_distance
+// CHECK-NOT: scf.if
+// CHECK: scf.parallel
+func @promote_step_distance(%arg0: memref<?xf32>, %arg1: index) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %c2 = constant 2 : index
+  scf.for %arg2 = %c0 to %arg1 step %c2 {
+    %0 = addi %c1, %arg2 : index
+    %1 = memref.load %arg0[%0] : memref<?xf32>
+    memref.store %1, %arg0[%arg2] : memref<?xf32>
+  }
+  return
+}
+
+// -----
+
+#map = affine_map<(d0, d1)[s0, s1, s2] -> (d0 * s1 + s0 + d1 * s2)>
+
+// CHECK-LABEL: func @version_row_stride
+// CHECK: plier.extract_memref_metadata
+// CHECK: scf.if
+// CHECK: scf.parallel
+// CHECK: else
+// CHECK: scf.for
+func @version_row_stride(%arg0: memref<?x?xf32, #map>, %arg1: index) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?x?xf32, #map>
+  scf.for %arg2 = %c0 to %0 step %c1 {
+    %1 = memref.load %arg0[%arg2, %arg1] : memref<?x?xf32, #map>
+    %2 = addf %1, %1 : f32
+    memref.store %2, %arg0[%arg2, %c0] : memref<?x?xf32, #map>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @promote_min
+// CHECK: scf.parallel
+// CHECK: scf.reduce(%{{.*}}) : f32
+// CHECK: ^bb0(%[[LHS:.*]]: f32, %[[RHS:.*]]: f32):
+// CHECK: %[[CMP:.*]] = cmpf olt, %[[LHS]], %[[RHS]] : f32
+// CHECK: %[[RES:.*]] = select %[[CMP]], %[[LHS]], %[[RHS]] : f32
+// CHECK: scf.reduce.return %[[RES]] : f32
+func @promote_min(%arg0: memref<?xf32>, %arg1: f32) -> f32 {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf32>
+  %1 = scf.for %arg2 = %c0 to %0 step %c1 iter_args(%arg3 = %arg1) -> (f32) {
+    %2 = memref.load %arg0[%arg2] : memref<?xf32>
+    %3 = cmpf olt, %2, %arg3 : f32
+    %4 = select %3, %2, %arg3 : f32
+    scf.yield %4 : f32
+  }
+  return %1 : f32
+}
+
+// -----
+
+// CHECK-LABEL: func @promote_min_nan
+// CHECK: scf.parallel
+// CHECK: scf.reduce(%{{.*}}) : f32
+// CHECK: ^bb0(%[[LHS:.*]]: f32, %[[RHS:.*]]: f32):
+// CHECK: %[[NAN:.*]] = cmpf une, %[[LHS]], %[[LHS]] : f32
+// CHECK: %[[CMP:.*]] = cmpf olt, %[[LHS]], %[[RHS]] : f32
+// CHECK: %[[MIN:.*]] = select %[[CMP]], %[[LHS]], %[[RHS]] : f32
+// CHECK: %[[RES:.*]] = select %[[NAN]], %[[LHS]], %[[MIN]] : f32
+// CHECK: scf.reduce.return %[[RES]] : f32
+func @promote_min_nan(%arg0: memref<?xf32>, %arg1: f32) -> f32 {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf32>
+  %1 = scf.for %arg2 = %c0 to %0 step %c1 iter_args(%arg3 = %arg1) -> (f32) {
+    %2 = memref.load %arg0[%arg2] : memref<?xf32>
+    %3 = cmpf une, %2, %2 : f32
+    %4 = cmpf olt, %2, %arg3 : f32
+    %5 = select %4, %2, %arg3 : f32
+    %6 = select %3, %2, %5 : f32
+    scf.yield %6 : f32
+  }
+  return %1 : f32
+}
+
+// -----
+
+// CHECK-LABEL: func @no_promote_two_operands
+// CHECK-NOT: scf.parallel
+func @no_promote_two_operands(%arg0: memref<?xf32>, %arg1: f32) -> f32 {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %0 = memref.dim %arg0, %c0 : memref<?xf32>
+  %1 = scf.for %arg2 = %c0 to %0 step %c1 iter_args(%arg3 = %arg1) -> (f32) {
+    %2 = memref.load %arg0[%arg2] : memref<?xf32>
+    %3 = addf %arg3, %2 : f32
+    %4 = mulf %3, %2 : f32
+    scf.yield %4 : f32
+  }
+  return %1 : f32
+}
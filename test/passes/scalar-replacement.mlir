@@ -0,0 +1,114 @@
+// RUN: dpcomp-opt %s --dpcomp-scalar-replacement -split-input-file | FileCheck %s
+
+// CHECK-LABEL: func @reduction_nested_parallel
+// CHECK: scf.parallel (%[[I:.*]]) =
+// CHECK: %[[COND:.*]] = cmpi slt
+// CHECK: %[[INIT:.*]] = scf.if %[[COND]] -> (f32)
+// CHECK: memref.load %[[BUF:.*]][%[[I]], %c0]
+// CHECK: %[[RES:.*]] = scf.for {{.*}} iter_args(%{{.*}} = %[[INIT]]) -> (f32)
+// CHECK-NOT: memref.store
+// CHECK: scf.yield
+// CHECK: scf.if %[[COND]] {
+// CHECK-NEXT: memref.store %[[RES]], %[[BUF]][%[[I]], %c0]
+func @reduction_nested_parallel(%arg0: memref<?x?xf32>, %arg1: index, %arg2: index) -> memref<?x1xf32> {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %cst = constant 0.0 : f32
+  %0 = memref.alloc(%arg1) : memref<?x1xf32>
+  scf.parallel (%i) = (%c0) to (%arg1) step (%c1) {
+    memref.store %cst, %0[%i, %c0] : memref<?x1xf32>
+    scf.for %j = %c0 to %arg2 step %c1 {
+      %1 = memref.load %0[%i, %c0] : memref<?x1xf32>
+      %2 = memref.load %arg0[%i, %j] : memref<?x?xf32>
+      %3 = addf %1, %2 : f32
+      memref.store %3, %0[%i, %c0] : memref<?x1xf32>
+    }
+    scf.yield
+  }
+  return %0 : memref<?x1xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @reduction_arg_empty_loop
+// CHECK: %[[COND:.*]] = cmpi slt, %c0, %arg1
+// CHECK: %[[INIT:.*]] = scf.if %[[COND]] -> (f32)
+// CHECK: memref.load %arg0[%arg2]
+// CHECK: %[[RES:.*]] = scf.for {{.*}} iter_args(%{{.*}} = %[[INIT]]) -> (f32)
+// CHECK: scf.if %[[COND]] {
+// CHECK-NEXT: memref.store %[[RES]], %arg0[%arg2]
+func @reduction_arg_empty_loop(%arg0: memref<?xf32>, %arg1: index, %arg2: index) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %cst = constant 1.0 : f32
+  scf.for %j = %c0 to %arg1 step %c1 {
+    %0 = memref.load %arg0[%arg2] : memref<?xf32>
+    %1 = addf %0, %cst : f32
+    memref.store %1, %arg0[%arg2] : memref<?xf32>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_reduction_alias
+// CHECK-NOT: iter_args
+// CHECK: scf.for
+// CHECK: memref.load %arg0[%c0]
+// CHECK: memref.store {{.*}}, %arg0[%c0]
+func @no_reduction_alias(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %arg2: index) {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  scf.for %j = %c0 to %arg2 step %c1 {
+    %0 = memref.load %arg0[%c0] : memref<?xf32>
+    %1 = memref.load %arg1[%j] : memref<?xf32>
+    %2 = addf %0, %1 : f32
+    memref.store %2, %arg1[%j] : memref<?xf32>
+    memref.store %2, %arg0[%c0] : memref<?xf32>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @rotate_stencil
+// CHECK: %[[COND:.*]] = cmpi slt
+// CHECK: %[[INIT:.*]]:2 = scf.if %[[COND]] -> (f32, f32)
+// CHECK: scf.for {{.*}} iter_args(%[[A:.*]] = %[[INIT]]#0, %[[B:.*]] = %[[INIT]]#1) -> (f32, f32)
+// CHECK: %[[C:.*]] = memref.load %arg0
+// CHECK-NOT: memref.load
+// CHECK: scf.yield %[[B]], %[[C]] : f32, f32
+func @rotate_stencil(%arg0: memref<?xf32>, %arg1: index) -> memref<?xf32> {
+  %c1 = constant 1 : index
+  %0 = memref.alloc(%arg1) : memref<?xf32>
+  scf.for %j = %c1 to %arg1 step %c1 {
+    %1 = subi %j, %c1 : index
+    %2 = memref.load %arg0[%1] : memref<?xf32>
+    %3 = memref.load %arg0[%j] : memref<?xf32>
+    %4 = addi %j, %c1 : index
+    %5 = memref.load %arg0[%4] : memref<?xf32>
+    %6 = addf %2, %3 : f32
+    %7 = addf %6, %5 : f32
+    memref.store %7, %0[%j] : memref<?xf32>
+  }
+  return %0 : memref<?xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @no_rotate_modified
+// CHECK-NOT: iter_args
+// CHECK: scf.for
+// CHECK: memref.load
+// CHECK: memref.load
+func @no_rotate_modified(%arg0: memref<?xf32>, %arg1: index) {
+  %c1 = constant 1 : index
+  scf.for %j = %c1 to %arg1 step %c1 {
+    %1 = subi %j, %c1 : index
+    %2 = memref.load %arg0[%1] : memref<?xf32>
+    %3 = memref.load %arg0[%j] : memref<?xf32>
+    %4 = addf %2, %3 : f32
+    memref.store %4, %arg0[%j] : memref<?xf32>
+  }
+  return
+}
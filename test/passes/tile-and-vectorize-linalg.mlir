@@ -0,0 +1,102 @@
+// RUN: dpcomp-opt %s --dpcomp-tile-and-vectorize-linalg -split-input-file | FileCheck %s
+
+#map = affine_map<(d0) -> (d0)>
+
+// CHECK-LABEL: func @vectorize_eltwise
+// CHECK: scf.parallel
+// CHECK: vector.transfer_read {{.*}} {in_bounds = [true]} : memref<?xf32>, vector<8xf32>
+// CHECK: vector.transfer_read {{.*}} {in_bounds = [true]} : memref<?xf32>, vector<8xf32>
+// CHECK: addf {{.*}} : vector<8xf32>
+// CHECK: vector.transfer_write
+// CHECK: scf.parallel
+// CHECK: vector.transfer_read
+// CHECK: vector.transfer_read
+// CHECK: addf {{.*}} : vector<8xf32>
+// CHECK: vector.transfer_write
+// CHECK-NOT: linalg.generic
+func @vectorize_eltwise(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %arg2: memref<?xf32>) attributes {"#plier.vector_length" = 32 : i64} {
+  linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel"]} ins(%arg0, %arg1 : memref<?xf32>, memref<?xf32>) outs(%arg2 : memref<?xf32>) {
+  ^bb0(%a: f32, %b: f32, %c: f32):
+    %0 = addf %a, %b : f32
+    linalg.yield %0 : f32
+  }
+  return
+}
+
+// -----
+
+#map = affine_map<(d0)[s0, s1] -> (d0 * s1 + s0)>
+#map1 = affine_map<(d0) -> (d0)>
+
+// CHECK-LABEL: func @vectorize_strided
+// CHECK: plier.extract_memref_metadata
+// CHECK: scf.if
+// CHECK: memref.cast
+// CHECK: vector.transfer_read
+// CHECK: else
+// CHECK: linalg.generic
+func @vectorize_strided(%arg0: memref<?xf64, #map>, %arg1: memref<?xf64>) attributes {"#plier.vector_length" = 32 : i64} {
+  linalg.generic {indexing_maps = [#map1, #map1], iterator_types = ["parallel"]} ins(%arg0 : memref<?xf64, #map>) outs(%arg1 : memref<?xf64>) {
+  ^bb0(%a: f64, %b: f64):
+    %cst = constant 1.0 : f64
+    %0 = mulf %a, %cst : f64
+    linalg.yield %0 : f64
+  }
+  return
+}
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d1)>
+
+// CHECK-LABEL: func @vectorize_outer_reduction
+// CHECK: scf.parallel
+// CHECK: scf.for
+// CHECK: vector.transfer_read
+// CHECK: vector.transfer_read
+// CHECK: addf {{.*}} : vector<8xf32>
+// CHECK: vector.transfer_write
+func @vectorize_outer_reduction(%arg0: memref<?x?xf32>, %arg1: memref<?xf32>) attributes {"#plier.vector_length" = 32 : i64} {
+  linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["reduction", "parallel"]} ins(%arg0 : memref<?x?xf32>) outs(%arg1 : memref<?xf32>) {
+  ^bb0(%a: f32, %b: f32):
+    %0 = addf %a, %b : f32
+    linalg.yield %0 : f32
+  }
+  return
+}
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0)>
+
+// CHECK-LABEL: func @no_vectorize_inner_reduction
+// CHECK-NOT: vector.transfer_read
+// CHECK: linalg.generic
+func @no_vectorize_inner_reduction(%arg0: memref<?x?xf32>, %arg1: memref<?xf32>) attributes {"#plier.vector_length" = 32 : i64} {
+  linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "reduction"]} ins(%arg0 : memref<?x?xf32>) outs(%arg1 : memref<?xf32>) {
+  ^bb0(%a: f32, %b: f32):
+    %0 = addf %a, %b : f32
+    linalg.yield %0 : f32
+  }
+  return
+}
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d1, d0)>
+#map1 = affine_map<(d0, d1) -> (d0, d1)>
+
+// CHECK-LABEL: func @tile_transpose
+// CHECK: scf.parallel
+// CHECK: memref.subview
+// CHECK: memref.subview
+// CHECK: linalg.generic
+func @tile_transpose(%arg0: memref<?x?xf32>, %arg1: memref<?x?xf32>) attributes {"#plier.tile_size" = 32 : i64, "#plier.vector_length" = 32 : i64} {
+  linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "parallel"]} ins(%arg0 : memref<?x?xf32>) outs(%arg1 : memref<?x?xf32>) {
+  ^bb0(%a: f32, %b: f32):
+    linalg.yield %a : f32
+  }
+  return
+}
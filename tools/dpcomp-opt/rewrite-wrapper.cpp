@@ -18,11 +18,23 @@
 #include <mlir/Pass/PassRegistry.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 
+#include <mlir/Dialect/Affine/IR/AffineOps.h>
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
 #include <mlir/Dialect/SCF/SCF.h>
+#include <mlir/Dialect/StandardOps/IR/Ops.h>
+#include <mlir/Dialect/Vector/VectorOps.h>
 
 #include "plier/Conversion/SCFToAffine/SCFToAffine.h"
+#include "plier/dialect.hpp"
 #include "plier/pass/rewrite_wrapper.hpp"
+#include "plier/rewrites/if_rewrites.hpp"
 #include "plier/rewrites/promote_to_parallel.hpp"
+#include "plier/transforms/copy_elision.hpp"
+#include "plier/transforms/loop_utils.hpp"
+#include "plier/transforms/memory_planning.hpp"
+#include "plier/transforms/refcount_opts.hpp"
+#include "plier/transforms/scalar_replacement.hpp"
+#include "plier/transforms/vectorize_linalg.hpp"
 
 namespace {
 template <typename Op, typename Rewrite>
@@ -50,13 +62,113 @@ struct PassRegistrationWrapper
         }) {}
 };
 
+struct PromoteToParallelPass
+    : public plier::RewriteWrapperPass<
+          PromoteToParallelPass, mlir::FuncOp,
+          plier::DependentDialectsList<
+              mlir::memref::MemRefDialect, mlir::scf::SCFDialect,
+              mlir::StandardOpsDialect, plier::PlierDialect>,
+          plier::PromoteToParallel> {};
+
+struct IfToSelectPass
+    : public plier::RewriteWrapperPass<
+          IfToSelectPass, mlir::FuncOp,
+          plier::DependentDialectsList<mlir::scf::SCFDialect,
+                                       mlir::StandardOpsDialect>,
+          plier::IfOpToSelect> {};
+
+struct ParallelLoopFusionPass
+    : public mlir::PassWrapper<ParallelLoopFusionPass, mlir::FunctionPass> {
+  void runOnFunction() override {
+    auto &region = getFunction().getRegion();
+    (void)plier::prepareForFusion(region);
+    (void)plier::fuseParallelOps(region);
+  }
+};
+
+struct TileAndVectorizeLinalgPass
+    : public mlir::PassWrapper<TileAndVectorizeLinalgPass, mlir::FunctionPass> {
+  virtual void
+  getDependentDialects(mlir::DialectRegistry &registry) const override {
+    registry.insert<mlir::AffineDialect>();
+    registry.insert<mlir::memref::MemRefDialect>();
+    registry.insert<mlir::scf::SCFDialect>();
+    registry.insert<mlir::StandardOpsDialect>();
+    registry.insert<mlir::vector::VectorDialect>();
+    registry.insert<plier::PlierDialect>();
+  }
+
+  void runOnFunction() override {
+    (void)plier::tileAndVectorizeLinalgOps(getFunction());
+  }
+};
+
+struct MemoryPlanningPass
+    : public mlir::PassWrapper<MemoryPlanningPass, mlir::FunctionPass> {
+  void runOnFunction() override {
+    (void)plier::planBufferReuse(getFunction());
+  }
+};
+
+struct ElideRetainReleasePass
+    : public mlir::PassWrapper<ElideRetainReleasePass, mlir::FunctionPass> {
+  void runOnFunction() override {
+    (void)plier::elideRetainRelease(getFunction());
+  }
+};
+
+struct PromoteSmallBuffersPass
+    : public mlir::PassWrapper<PromoteSmallBuffersPass, mlir::FunctionPass> {
+  void runOnFunction() override {
+    (void)plier::promoteSmallBuffers(getFunction());
+  }
+};
+
+struct ScalarReplacementPass
+    : public mlir::PassWrapper<ScalarReplacementPass, mlir::FunctionPass> {
+  void runOnFunction() override {
+    (void)plier::replaceLoopScalars(getFunction());
+  }
+};
+
+struct CopyElisionPass
+    : public mlir::PassWrapper<CopyElisionPass, mlir::FunctionPass> {
+  void runOnFunction() override {
+    (void)plier::replaceCopiesWithViews(getFunction());
+  }
+};
+
 template <typename Op, typename Rewrite>
 using WrapperRegistration =
     PassRegistrationWrapper<RewriteWrapper<Op, Rewrite>>;
 
-static WrapperRegistration<mlir::FuncOp, plier::PromoteToParallel>
+static PassRegistrationWrapper<PromoteToParallelPass>
     promoteToParallelReg("dpcomp-promote-to-parallel", "");
 
+static PassRegistrationWrapper<IfToSelectPass>
+    ifToSelectReg("dpcomp-if-to-select", "");
+
+static PassRegistrationWrapper<ParallelLoopFusionPass>
+    parallelLoopFusionReg("dpcomp-parallel-loop-fusion", "");
+
+static PassRegistrationWrapper<TileAndVectorizeLinalgPass>
+    tileAndVectorizeReg("dpcomp-tile-and-vectorize-linalg", "");
+
+static PassRegistrationWrapper<MemoryPlanningPass>
+    memoryPlanningReg("dpcomp-memory-planning", "");
+
+static PassRegistrationWrapper<ElideRetainReleasePass>
+    elideRetainReleaseReg("dpcomp-elide-retain-release", "");
+
+static PassRegistrationWrapper<PromoteSmallBuffersPass>
+    promoteSmallBuffersReg("dpcomp-promote-small-buffers", "");
+
+static PassRegistrationWrapper<ScalarReplacementPass>
+    scalarReplacementReg("dpcomp-scalar-replacement", "");
+
+static PassRegistrationWrapper<CopyElisionPass>
+    copyElisionReg("dpcomp-copy-elision", "");
+
 static mlir::PassPipelineRegistration<>
     scfToAffineReg("scf-to-affine", "Converts SCF parallel struct into Affine parallel",
            [](mlir::OpPassManager &pm) {